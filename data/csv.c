@@ -20,6 +20,11 @@ static int count_rows(FILE* fp) {
     fseek(fp, 0, SEEK_SET);
     return rows;
 }
+static int is_header(const char* line) {
+    char* end;
+    strtof(line, &end);
+    return end == line;
+}
 
 Tensor* tensor_from_csv(const char* path) {
     FILE* fp = fopen(path, "r");
@@ -32,14 +37,18 @@ Tensor* tensor_from_csv(const char* path) {
     }
 
     int cols = count_columns(buffer);
-    int rows = count_rows(fp);
+    int header = is_header(buffer);
+    int rows = count_rows(fp) + !header;
     rewind(fp);
+    if (header) fgets(buffer, sizeof(buffer), fp);
 
-    float* data = malloc(sizeof(float) * rows * cols);
-    if (!data) {
+    int shape[2] = { rows, cols };
+    Tensor* t = tensor_zeros(2, shape, 0);
+    if (!t) {
         fclose(fp);
         return NULL;
     }
+    float* data = t->data;
 
     int r = 0;
     while (fgets(buffer, sizeof(buffer), fp)) {
@@ -54,13 +63,69 @@ Tensor* tensor_from_csv(const char* path) {
     }
 
     fclose(fp);
-    Tensor* t = malloc(sizeof(Tensor));
-    t->ndim = 2;
-    t->shape = malloc(sizeof(int) * 2);
-    t->shape[0] = rows;
-    t->shape[1] = cols;
-    t->data = data;
-    t->grad = NULL;
-
     return t;
 }
+
+CSRTensor* csr_from_csv(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return NULL;
+
+    int rows = 0, cols = 0, nnz = 0;
+    int row_cap = 1024, nnz_cap = 4096;
+    int* row_ptr = malloc(sizeof(int) * (row_cap + 1));
+    int* col_idx = malloc(sizeof(int) * nnz_cap);
+    float* values = malloc(sizeof(float) * nnz_cap);
+    row_ptr[0] = 0;
+
+    char* line = NULL;
+    size_t line_cap = 0;
+    int first = 1;
+    while (getline(&line, &line_cap, fp) > 0) {
+        if (first) {
+            first = 0;
+            if (is_header(line)) continue;
+        }
+        if (line[0] == '\n' || line[0] == '\r') continue;
+
+        char* p = line;
+        int c = 0;
+        for (;;) {
+            char* end;
+            float v = strtof(p, &end);
+            if (v != 0.0f) {
+                if (nnz == nnz_cap) {
+                    nnz_cap *= 2;
+                    col_idx = realloc(col_idx, sizeof(int) * nnz_cap);
+                    values = realloc(values, sizeof(float) * nnz_cap);
+                }
+                col_idx[nnz] = c;
+                values[nnz] = v;
+                nnz++;
+            }
+            c++;
+            p = strchr(end, ',');
+            if (!p) break;
+            p++;
+        }
+        if (c > cols) cols = c;
+
+        if (rows == row_cap) {
+            row_cap *= 2;
+            row_ptr = realloc(row_ptr, sizeof(int) * (row_cap + 1));
+        }
+        row_ptr[++rows] = nnz;
+    }
+    free(line);
+    fclose(fp);
+
+    CSRTensor* a = malloc(sizeof(CSRTensor));
+    a->rows = rows;
+    a->cols = cols;
+    a->nnz = nnz;
+    a->row_ptr = row_ptr;
+    a->col_idx = col_idx;
+    a->values = values;
+    a->transpose = NULL;
+    a->refcount = 1;
+    return a;
+}
@@ -1,5 +1,7 @@
 #ifndef CSV_H
 #define CSV_H
 #include "../tensor/tensor.h"
+#include "../tensor/sparse.h"
 Tensor* tensor_from_csv(const char* path);
+CSRTensor* csr_from_csv(const char* path);
 #endif
\ No newline at end of file
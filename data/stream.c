@@ -0,0 +1,600 @@
+#include "stream.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../tensor/tensor.h"
+#include "../tensor/random.h"
+
+#define STREAM_BIN_MAGIC 0x424c4d43u
+#define STREAM_BIN_VERSION 1u
+#define STREAM_BIN_HEADER 24
+#define STREAM_IO_BUFFER (1 << 20)
+#define STREAM_RAND_BLOCK 1024
+
+enum { SOURCE_CSV, SOURCE_BIN };
+enum { ITEM_BATCH, ITEM_EPOCH, ITEM_ERROR };
+
+typedef struct {
+    FILE* fp;
+    const char* path;
+    int kind;
+    int cols;
+    int header;
+    long long rows;
+    char* line;
+    size_t line_cap;
+} Source;
+
+typedef struct {
+    int kind;
+    Tensor* x;
+    Tensor* y;
+} Item;
+
+struct Stream {
+    StreamConfig config;
+    Source x_src;
+    Source y_src;
+    int has_y;
+
+    float* x_chunk;
+    float* y_chunk;
+    float* x_res;
+    float* y_res;
+    int res_fill;
+    Tensor* bx;
+    Tensor* by;
+    int b_fill;
+
+    float rand_buf[STREAM_RAND_BLOCK];
+    int rand_pos;
+    uint64_t rand_offset;
+    long long* order;
+
+    Item* queue;
+    int q_head;
+    int q_count;
+    int stop;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_t thread;
+};
+
+static int count_columns(const char* line) {
+    int count = 1;
+    for (const char* c = line; *c; c++)
+        if (*c == ',') count++;
+    return count;
+}
+
+static int is_header(const char* line) {
+    char* end;
+    strtof(line, &end);
+    return end == line;
+}
+
+static int is_blank(const char* line) {
+    return line[0] == '\n' || line[0] == '\r' || line[0] == '\0';
+}
+
+static int source_open(Source* src, const char* path, int kind) {
+    memset(src, 0, sizeof(Source));
+    src->path = path;
+    src->kind = kind;
+    src->fp = fopen(path, kind == SOURCE_BIN ? "rb" : "r");
+    if (!src->fp) {
+        fprintf(stderr, "stream: cannot open %s\n", path);
+        return -1;
+    }
+    setvbuf(src->fp, NULL, _IOFBF, STREAM_IO_BUFFER);
+
+    if (kind == SOURCE_BIN) {
+        uint32_t header[4];
+        int64_t rows;
+        if (fread(header, sizeof(header), 1, src->fp) != 1 || fread(&rows, sizeof(rows), 1, src->fp) != 1 ||
+            header[0] != STREAM_BIN_MAGIC || header[1] != STREAM_BIN_VERSION || header[2] == 0 || rows < 0) {
+            fprintf(stderr, "stream: %s is not a CML binary dataset\n", path);
+            return -1;
+        }
+        src->cols = (int)header[2];
+        src->rows = rows;
+        return 0;
+    }
+
+    while (getline(&src->line, &src->line_cap, src->fp) > 0) {
+        if (is_blank(src->line)) continue;
+        src->cols = count_columns(src->line);
+        src->header = is_header(src->line);
+        return 0;
+    }
+    fprintf(stderr, "stream: %s is empty\n", path);
+    return -1;
+}
+
+static void source_close(Source* src) {
+    if (src->fp) fclose(src->fp);
+    free(src->line);
+    src->fp = NULL;
+    src->line = NULL;
+}
+
+static int source_rewind(Source* src) {
+    if (fseeko(src->fp, src->kind == SOURCE_BIN ? STREAM_BIN_HEADER : 0, SEEK_SET) != 0) return -1;
+    if (src->kind == SOURCE_CSV && src->header) {
+        while (getline(&src->line, &src->line_cap, src->fp) > 0)
+            if (!is_blank(src->line)) break;
+    }
+    return 0;
+}
+
+static int source_seek_row(Source* src, long long row) {
+    off_t pos = STREAM_BIN_HEADER + (off_t)row * src->cols * (off_t)sizeof(float);
+    return fseeko(src->fp, pos, SEEK_SET);
+}
+
+static int source_read(Source* src, float* dst, int n) {
+    if (src->kind == SOURCE_BIN) {
+        size_t got = fread(dst, sizeof(float) * src->cols, n, src->fp);
+        if (got < (size_t)n && ferror(src->fp)) return -1;
+        return (int)got;
+    }
+
+    int r = 0;
+    while (r < n && getline(&src->line, &src->line_cap, src->fp) > 0) {
+        if (is_blank(src->line)) continue;
+        float* row = dst + (size_t)r * src->cols;
+        char* p = src->line;
+        int c = 0;
+        while (c < src->cols) {
+            char* end;
+            row[c++] = strtof(p, &end);
+            p = strchr(end, ',');
+            if (!p) break;
+            p++;
+        }
+        while (c < src->cols) row[c++] = 0.0f;
+        r++;
+    }
+    if (r < n && ferror(src->fp)) return -1;
+    return r;
+}
+
+static float next_uniform(Stream* s) {
+    if (s->rand_pos == STREAM_RAND_BLOCK) {
+        rng_uniform(s->rand_buf, STREAM_RAND_BLOCK, 0.0f, 1.0f, s->config.seed, s->rand_offset);
+        s->rand_offset += STREAM_RAND_BLOCK;
+        s->rand_pos = 0;
+    }
+    return s->rand_buf[s->rand_pos++];
+}
+
+static long long next_index(Stream* s, long long n) {
+    long long i = (long long)(next_uniform(s) * (double)n);
+    return i < n ? i : n - 1;
+}
+
+static int push(Stream* s, int kind, Tensor* x, Tensor* y) {
+    int depth = s->config.prefetch;
+    pthread_mutex_lock(&s->lock);
+    while (s->q_count == depth && !s->stop) pthread_cond_wait(&s->not_full, &s->lock);
+    if (s->stop) {
+        pthread_mutex_unlock(&s->lock);
+        tensor_release(x);
+        tensor_release(y);
+        return -1;
+    }
+    Item* item = &s->queue[(s->q_head + s->q_count) % depth];
+    item->kind = kind;
+    item->x = x;
+    item->y = y;
+    s->q_count++;
+    pthread_cond_signal(&s->not_empty);
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+static Tensor* trim(Tensor* t, int rows) {
+    int shape[2] = { rows, t->shape[1] };
+    Tensor* out = tensor_create(2, shape, 0);
+    memcpy(out->data, t->data, sizeof(float) * out->size);
+    tensor_release(t);
+    return out;
+}
+
+static int flush_batch(Stream* s) {
+    if (!s->b_fill) return 0;
+    Tensor* x = s->bx;
+    Tensor* y = s->by;
+    int rows = s->b_fill;
+    s->bx = s->by = NULL;
+    s->b_fill = 0;
+
+    if (rows < s->config.batch_size) {
+        if (s->config.drop_last) {
+            tensor_release(x);
+            tensor_release(y);
+            return 0;
+        }
+        x = trim(x, rows);
+        if (y) y = trim(y, rows);
+    }
+    return push(s, ITEM_BATCH, x, y);
+}
+
+static int emit_row(Stream* s, const float* x, const float* y) {
+    int x_cols = s->x_src.cols, y_cols = s->y_src.cols;
+    if (!s->bx) {
+        int x_shape[2] = { s->config.batch_size, x_cols };
+        s->bx = tensor_create(2, x_shape, 0);
+        if (s->has_y) {
+            int y_shape[2] = { s->config.batch_size, y_cols };
+            s->by = tensor_create(2, y_shape, 0);
+        }
+    }
+
+    memcpy(s->bx->data + (size_t)s->b_fill * x_cols, x, sizeof(float) * x_cols);
+    if (s->has_y) memcpy(s->by->data + (size_t)s->b_fill * y_cols, y, sizeof(float) * y_cols);
+    if (++s->b_fill == s->config.batch_size) return flush_batch(s);
+    return 0;
+}
+
+static int feed_rows(Stream* s, int n) {
+    int x_cols = s->x_src.cols, y_cols = s->y_src.cols;
+    int cap = s->config.shuffle_buffer;
+
+    for (int r = 0; r < n; r++) {
+        const float* x = s->x_chunk + (size_t)r * x_cols;
+        const float* y = s->has_y ? s->y_chunk + (size_t)r * y_cols : NULL;
+        if (!cap) {
+            if (emit_row(s, x, y) < 0) return -1;
+            continue;
+        }
+        if (s->res_fill < cap) {
+            memcpy(s->x_res + (size_t)s->res_fill * x_cols, x, sizeof(float) * x_cols);
+            if (y) memcpy(s->y_res + (size_t)s->res_fill * y_cols, y, sizeof(float) * y_cols);
+            s->res_fill++;
+            continue;
+        }
+
+        long long j = next_index(s, cap);
+        float* xj = s->x_res + (size_t)j * x_cols;
+        float* yj = y ? s->y_res + (size_t)j * y_cols : NULL;
+        if (emit_row(s, xj, yj) < 0) return -1;
+        memcpy(xj, x, sizeof(float) * x_cols);
+        if (y) memcpy(yj, y, sizeof(float) * y_cols);
+    }
+    return 0;
+}
+
+static int drain_reservoir(Stream* s) {
+    int x_cols = s->x_src.cols, y_cols = s->y_src.cols;
+    while (s->res_fill > 0) {
+        long long j = next_index(s, s->res_fill);
+        long long last = s->res_fill - 1;
+        float* xj = s->x_res + (size_t)j * x_cols;
+        float* yj = s->has_y ? s->y_res + (size_t)j * y_cols : NULL;
+        if (emit_row(s, xj, yj) < 0) return -1;
+        memcpy(xj, s->x_res + (size_t)last * x_cols, sizeof(float) * x_cols);
+        if (yj) memcpy(yj, s->y_res + (size_t)last * y_cols, sizeof(float) * y_cols);
+        s->res_fill--;
+    }
+    return 0;
+}
+
+static int read_chunk(Stream* s, int n) {
+    int got = source_read(&s->x_src, s->x_chunk, n);
+    if (got < 0) {
+        fprintf(stderr, "stream: read from %s failed\n", s->x_src.path);
+        return -1;
+    }
+    if (s->has_y) {
+        int got_y = source_read(&s->y_src, s->y_chunk, got);
+        if (got_y == got && got < n) got_y += source_read(&s->y_src, s->y_chunk + (size_t)got * s->y_src.cols, 1);
+        if (got_y != got) {
+            fprintf(stderr, "stream: %s and %s have different row counts\n", s->x_src.path, s->y_src.path);
+            return -1;
+        }
+    }
+    return got;
+}
+
+static int run_bin_epoch(Stream* s) {
+    int chunk = s->config.chunk_rows;
+    long long rows = s->x_src.rows;
+    long long n_chunks = (rows + chunk - 1) / chunk;
+
+    for (long long c = 0; c < n_chunks; c++) s->order[c] = c;
+    if (s->config.shuffle_buffer > 0) {
+        for (long long c = n_chunks - 1; c > 0; c--) {
+            long long j = next_index(s, c + 1);
+            long long tmp = s->order[c];
+            s->order[c] = s->order[j];
+            s->order[j] = tmp;
+        }
+    }
+
+    for (long long c = 0; c < n_chunks; c++) {
+        long long start = s->order[c] * chunk;
+        int n = rows - start < chunk ? (int)(rows - start) : chunk;
+        if (source_seek_row(&s->x_src, start) != 0 || (s->has_y && source_seek_row(&s->y_src, start) != 0)) {
+            fprintf(stderr, "stream: seek in %s failed\n", s->x_src.path);
+            return -1;
+        }
+        if (read_chunk(s, n) != n) {
+            fprintf(stderr, "stream: %s is shorter than its header says\n", s->x_src.path);
+            return -1;
+        }
+        if (feed_rows(s, n) < 0) return -1;
+    }
+    return 0;
+}
+
+static int run_csv_epoch(Stream* s) {
+    if (source_rewind(&s->x_src) != 0 || (s->has_y && source_rewind(&s->y_src) != 0)) {
+        fprintf(stderr, "stream: rewind of %s failed\n", s->x_src.path);
+        return -1;
+    }
+    for (;;) {
+        int n = read_chunk(s, s->config.chunk_rows);
+        if (n < 0) return -1;
+        if (feed_rows(s, n) < 0) return -1;
+        if (n < s->config.chunk_rows) return 0;
+    }
+}
+
+static void* reader_main(void* arg) {
+    Stream* s = (Stream*)arg;
+    for (;;) {
+        int rc = s->x_src.kind == SOURCE_BIN ? run_bin_epoch(s) : run_csv_epoch(s);
+        if (rc == 0) rc = drain_reservoir(s);
+        if (rc == 0) rc = flush_batch(s);
+        if (rc == 0) rc = push(s, ITEM_EPOCH, NULL, NULL);
+        if (rc < 0) {
+            push(s, ITEM_ERROR, NULL, NULL);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void stream_free(Stream* s) {
+    source_close(&s->x_src);
+    source_close(&s->y_src);
+    free(s->x_chunk);
+    free(s->y_chunk);
+    free(s->x_res);
+    free(s->y_res);
+    free(s->order);
+    free(s->queue);
+    tensor_release(s->bx);
+    tensor_release(s->by);
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->not_empty);
+    pthread_cond_destroy(&s->not_full);
+    free(s);
+}
+
+static Stream* stream_open(int kind, const char* x_path, const char* y_path, const StreamConfig* config) {
+    if (config->batch_size <= 0) {
+        fprintf(stderr, "stream: batch_size must be positive\n");
+        return NULL;
+    }
+
+    Stream* s = (Stream*)calloc(1, sizeof(Stream));
+    if (!s) {
+        fprintf(stderr, "failed to allocate Stream\n");
+        exit(1);
+    }
+    s->config = *config;
+    if (s->config.chunk_rows <= 0) s->config.chunk_rows = 4096;
+    if (s->config.prefetch <= 0) s->config.prefetch = 4;
+    if (s->config.shuffle_buffer < 0) s->config.shuffle_buffer = 0;
+    s->rand_pos = STREAM_RAND_BLOCK;
+    s->has_y = y_path != NULL;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->not_empty, NULL);
+    pthread_cond_init(&s->not_full, NULL);
+
+    if (source_open(&s->x_src, x_path, kind) < 0 || (s->has_y && source_open(&s->y_src, y_path, kind) < 0)) {
+        stream_free(s);
+        return NULL;
+    }
+    if (kind == SOURCE_BIN && s->has_y && s->x_src.rows != s->y_src.rows) {
+        fprintf(stderr, "stream: %s and %s have different row counts\n", x_path, y_path);
+        stream_free(s);
+        return NULL;
+    }
+
+    size_t chunk = s->config.chunk_rows, cap = s->config.shuffle_buffer;
+    s->x_chunk = (float*)malloc(sizeof(float) * chunk * s->x_src.cols);
+    s->y_chunk = s->has_y ? (float*)malloc(sizeof(float) * chunk * s->y_src.cols) : NULL;
+    s->x_res = cap ? (float*)malloc(sizeof(float) * cap * s->x_src.cols) : NULL;
+    s->y_res = cap && s->has_y ? (float*)malloc(sizeof(float) * cap * s->y_src.cols) : NULL;
+    s->queue = (Item*)calloc(s->config.prefetch, sizeof(Item));
+    if (kind == SOURCE_BIN) s->order = (long long*)malloc(sizeof(long long) * ((s->x_src.rows + chunk - 1) / chunk + 1));
+
+    if (pthread_create(&s->thread, NULL, reader_main, s) != 0) {
+        fprintf(stderr, "stream: failed to start reader thread\n");
+        stream_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+Stream* stream_open_csv(const char* x_path, const char* y_path, const StreamConfig* config) {
+    return stream_open(SOURCE_CSV, x_path, y_path, config);
+}
+
+Stream* stream_open_bin(const char* x_path, const char* y_path, const StreamConfig* config) {
+    return stream_open(SOURCE_BIN, x_path, y_path, config);
+}
+
+int stream_next(Stream* s, Tensor** x, Tensor** y) {
+    *x = NULL;
+    if (y) *y = NULL;
+    if (s->failed) return -1;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->q_count == 0) pthread_cond_wait(&s->not_empty, &s->lock);
+    Item item = s->queue[s->q_head];
+    s->q_head = (s->q_head + 1) % s->config.prefetch;
+    s->q_count--;
+    pthread_cond_signal(&s->not_full);
+    pthread_mutex_unlock(&s->lock);
+
+    if (item.kind == ITEM_ERROR) {
+        s->failed = 1;
+        return -1;
+    }
+    if (item.kind == ITEM_EPOCH) return 0;
+
+    *x = item.x;
+    if (y) *y = item.y;
+    else tensor_release(item.y);
+    return 1;
+}
+
+void stream_shape(Stream* s, int* x_cols, int* y_cols) {
+    if (x_cols) *x_cols = s->x_src.cols;
+    if (y_cols) *y_cols = s->has_y ? s->y_src.cols : 0;
+}
+
+void stream_close(Stream* s) {
+    if (!s) return;
+    pthread_mutex_lock(&s->lock);
+    s->stop = 1;
+    pthread_cond_broadcast(&s->not_full);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread, NULL);
+
+    for (int i = 0; i < s->q_count; i++) {
+        Item* item = &s->queue[(s->q_head + i) % s->config.prefetch];
+        tensor_release(item->x);
+        tensor_release(item->y);
+    }
+    stream_free(s);
+}
+
+FILE* stream_bin_create(const char* path, int cols) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "stream: cannot open %s\n", path);
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, STREAM_IO_BUFFER);
+    uint32_t header[4] = { STREAM_BIN_MAGIC, STREAM_BIN_VERSION, (uint32_t)cols, 0 };
+    int64_t rows = 0;
+    if (fwrite(header, sizeof(header), 1, fp) != 1 || fwrite(&rows, sizeof(rows), 1, fp) != 1) {
+        fprintf(stderr, "stream: write to %s failed\n", path);
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+int stream_bin_finish(FILE* fp, long long rows) {
+    int64_t n = rows;
+    int ok = fseeko(fp, sizeof(uint32_t) * 4, SEEK_SET) == 0 && fwrite(&n, sizeof(n), 1, fp) == 1;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "stream: finishing binary dataset failed\n");
+    return ok ? 0 : -1;
+}
+
+int stream_csv_to_bin(const char* csv_path, const char* bin_path) {
+    Source src;
+    if (source_open(&src, csv_path, SOURCE_CSV) < 0 || source_rewind(&src) != 0) {
+        source_close(&src);
+        return -1;
+    }
+
+    FILE* out = stream_bin_create(bin_path, src.cols);
+    if (!out) {
+        source_close(&src);
+        return -1;
+    }
+
+    int chunk = 4096;
+    float* buf = (float*)malloc(sizeof(float) * chunk * src.cols);
+    long long rows = 0;
+    int ok = 1;
+    for (;;) {
+        int n = source_read(&src, buf, chunk);
+        if (n < 0 || fwrite(buf, sizeof(float) * src.cols, n, out) != (size_t)n) {
+            ok = 0;
+            break;
+        }
+        rows += n;
+        if (n < chunk) break;
+    }
+
+    free(buf);
+    source_close(&src);
+    if (!ok) {
+        fprintf(stderr, "stream: converting %s failed\n", csv_path);
+        fclose(out);
+        return -1;
+    }
+    return stream_bin_finish(out, rows);
+}
+
+CSRTensor* csr_from_bin(const char* path) {
+    Source src;
+    if (source_open(&src, path, SOURCE_BIN) < 0) {
+        source_close(&src);
+        return NULL;
+    }
+    if (src.rows >= 0x7fffffff) {
+        fprintf(stderr, "stream: %s has too many rows for a CSR tensor\n", path);
+        source_close(&src);
+        return NULL;
+    }
+
+    int rows = (int)src.rows, chunk = 4096, nnz = 0, nnz_cap = 4096, r = 0;
+    int* row_ptr = (int*)malloc(sizeof(int) * (rows + 1));
+    int* col_idx = (int*)malloc(sizeof(int) * nnz_cap);
+    float* values = (float*)malloc(sizeof(float) * nnz_cap);
+    float* buf = (float*)malloc(sizeof(float) * chunk * src.cols);
+    row_ptr[0] = 0;
+    while (r < rows) {
+        int n = source_read(&src, buf, rows - r < chunk ? rows - r : chunk);
+        if (n <= 0) break;
+        for (int i = 0; i < n; i++, r++) {
+            const float* row = buf + (size_t)i * src.cols;
+            for (int c = 0; c < src.cols; c++) {
+                if (row[c] == 0.0f) continue;
+                if (nnz == nnz_cap) {
+                    nnz_cap *= 2;
+                    col_idx = (int*)realloc(col_idx, sizeof(int) * nnz_cap);
+                    values = (float*)realloc(values, sizeof(float) * nnz_cap);
+                }
+                col_idx[nnz] = c;
+                values[nnz] = row[c];
+                nnz++;
+            }
+            row_ptr[r + 1] = nnz;
+        }
+    }
+    free(buf);
+    int cols = src.cols;
+    source_close(&src);
+    if (r < rows) {
+        fprintf(stderr, "stream: %s is shorter than its header says\n", path);
+        free(row_ptr);
+        free(col_idx);
+        free(values);
+        return NULL;
+    }
+
+    CSRTensor* a = (CSRTensor*)malloc(sizeof(CSRTensor));
+    a->rows = rows;
+    a->cols = cols;
+    a->nnz = nnz;
+    a->row_ptr = row_ptr;
+    a->col_idx = col_idx;
+    a->values = values;
+    a->transpose = NULL;
+    a->refcount = 1;
+    return a;
+}
@@ -0,0 +1,29 @@
+#ifndef STREAM_H
+#define STREAM_H
+#include <stdio.h>
+#include <stdint.h>
+#include "../tensor/tensor.h"
+#include "../tensor/sparse.h"
+
+typedef struct StreamConfig StreamConfig;
+struct StreamConfig {
+    int batch_size;
+    int chunk_rows;
+    int shuffle_buffer;
+    int prefetch;
+    int drop_last;
+    uint64_t seed;
+};
+
+typedef struct Stream Stream;
+Stream* stream_open_csv(const char* x_path, const char* y_path, const StreamConfig* config);
+Stream* stream_open_bin(const char* x_path, const char* y_path, const StreamConfig* config);
+int stream_next(Stream* s, Tensor** x, Tensor** y);
+void stream_shape(Stream* s, int* x_cols, int* y_cols);
+void stream_close(Stream* s);
+
+int stream_csv_to_bin(const char* csv_path, const char* bin_path);
+FILE* stream_bin_create(const char* path, int cols);
+int stream_bin_finish(FILE* fp, long long rows);
+CSRTensor* csr_from_bin(const char* path);
+#endif
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+
+#define ROWS 4
+#define COLS 8
+#define CHAIN 20000
+#define REPEATS 20
+
+typedef enum { OP_ADD, OP_MUL_SCALAR, OP_DIV_SCALAR, OP_SUM_AXIS0, OP_SUM_AXIS1, N_OPS } Op;
+
+static const char* op_names[N_OPS] = { "add", "mul_scalar", "div_scalar", "sum_axis(0)", "sum_axis(1)" };
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static Tensor* apply(Op op, Tensor* x) {
+    switch (op) {
+        case OP_ADD:        return tensor_add(x, x);
+        case OP_MUL_SCALAR: return tensor_mul_scalar(x, 1.0001f);
+        case OP_DIV_SCALAR: return tensor_div_scalar(x, 1.0001f);
+        case OP_SUM_AXIS0:  return tensor_sum_axis(x, 0);
+        case OP_SUM_AXIS1:  return tensor_sum_axis(x, 1);
+        default:            return NULL;
+    }
+}
+
+static int ctx_in_block(Tensor* t) {
+    if (!t->ctx) return 1;
+    char* p = (char*)t->ctx;
+    return p >= (char*)t && p < (char*)t + sizeof(Tensor);
+}
+
+static double chain_ns(Op op, Tensor* x) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        double t0 = now();
+        Tensor* t = x;
+        tensor_retain(t);
+        for (int i = 0; i < CHAIN; i++) {
+            Tensor* next = apply(op, t);
+            tensor_release(t);
+            t = next;
+        }
+        Tensor* loss = tensor_sum(t);
+        tensor_backward(loss);
+        tensor_release(loss);
+        tensor_release(t);
+        double elapsed = now() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    return best / CHAIN * 1e9;
+}
+
+int main(void) {
+    rng_seed(34);
+    int shape[2] = { ROWS, COLS };
+    Tensor* x = tensor_randn(2, shape, 1);
+    int failed = 0;
+
+    printf("graph node ctx lives in the node's own allocation:\n");
+    for (int op = 0; op < N_OPS; op++) {
+        Tensor* t = apply((Op)op, x);
+        int ok = ctx_in_block(t);
+        printf("%-12s %s\n", op_names[op], !t->ctx ? "no ctx | ok" : ok ? "inline | ok" : "separate malloc | FAILED");
+        if (!ok) failed = 1;
+        tensor_release(t);
+    }
+
+    printf("\nchain of %d [%d, %d] nodes, forward + backward + release, best of %d:\n", CHAIN, ROWS, COLS, REPEATS);
+    double add = chain_ns(OP_ADD, x);
+    printf("%-12s %6.1f ns/node\n", op_names[OP_ADD], add);
+    for (int op = OP_MUL_SCALAR; op <= OP_DIV_SCALAR; op++) {
+        double ns = chain_ns((Op)op, x);
+        printf("%-12s %6.1f ns/node (%.2fx add)\n", op_names[op], ns, ns / add);
+    }
+
+    tensor_release(x);
+    return failed;
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/conv.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+static Tensor* probe_forward(Conv2d* conv, MaxPool2d* pool, Tensor* x, Tensor* r) {
+    Tensor* c = conv2d_forward(conv, x);
+    Tensor* p = maxpool2d_forward(pool, c);
+    Tensor* m = tensor_mul(p, r);
+    Tensor* loss = tensor_sum(m);
+    tensor_release(c);
+    tensor_release(p);
+    tensor_release(m);
+    return loss;
+}
+
+static float check_values(Conv2d* conv, MaxPool2d* pool, Tensor* x, Tensor* r, Tensor* t) {
+    float worst = 0.0f;
+    for (int i = 0; i < t->size; i++) {
+        float saved = t->data[i];
+        t->data[i] = saved + 1e-3f;
+        Tensor* lp = probe_forward(conv, pool, x, r);
+        t->data[i] = saved - 1e-3f;
+        Tensor* lm = probe_forward(conv, pool, x, r);
+        t->data[i] = saved;
+        float fd = (lp->data[0] - lm->data[0]) / 2e-3f;
+        float err = fabsf(fd - t->grad[i]) / (1.0f + fabsf(fd));
+        if (err > worst) worst = err;
+        tensor_release(lp);
+        tensor_release(lm);
+    }
+    return worst;
+}
+
+static int gradient_check(int layout) {
+    Conv2d* conv = conv2d_create(2, 3, 3, 1, 1, layout);
+    MaxPool2d* pool = maxpool2d_create(2, 2, layout);
+    int x_shape[4] = { 2, 2, 6, 6 };
+    int r_shape[4] = { 2, 3, 3, 3 };
+    if (layout == CML_NHWC) {
+        x_shape[1] = 6;
+        x_shape[3] = 2;
+        r_shape[1] = 3;
+    }
+    Tensor* x = tensor_randn(4, x_shape, 1);
+    Tensor* r = tensor_randn(4, r_shape, 0);
+
+    Tensor* loss = probe_forward(conv, pool, x, r);
+    conv2d_zero_grad(conv);
+    tensor_backward(loss);
+    tensor_release(loss);
+
+    float err = check_values(conv, pool, x, r, conv->weight);
+    float e = check_values(conv, pool, x, r, conv->bias);
+    if (e > err) err = e;
+    e = check_values(conv, pool, x, r, x);
+    if (e > err) err = e;
+    printf("gradient check (%s): max error %.2e\n", layout == CML_NHWC ? "NHWC" : "NCHW", err);
+
+    tensor_release(x);
+    tensor_release(r);
+    conv2d_free(conv);
+    maxpool2d_free(pool);
+    return err < 1e-2f;
+}
+
+int main(int argc, char** argv) {
+    int N = 64, epochs = 200;
+    float lr = 0.1f;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--batch")) N = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    rng_seed(4);
+    if (!gradient_check(CML_NCHW) || !gradient_check(CML_NHWC)) {
+        fprintf(stderr, "conv gradient check failed\n");
+        return 1;
+    }
+
+    int x_shape[4] = { N, 1, 8, 8 };
+    Tensor* x = tensor_randn(4, x_shape, 0);
+    Tensor* y = tensor_create(1, &N, 0);
+    for (int n = 0; n < N; n++) {
+        int vertical = n % 2;
+        int pos = 1 + (n / 2) % 6;
+        float* img = x->data + n * 64;
+        for (int i = 0; i < 64; i++) img[i] *= 0.3f;
+        for (int k = 0; k < 8; k++) img[vertical ? k * 8 + pos : pos * 8 + k] += 1.0f;
+        y->data[n] = (float)vertical;
+    }
+
+    Conv2d* conv = conv2d_create(1, 4, 3, 1, 1, CML_NCHW);
+    MaxPool2d* pool = maxpool2d_create(2, 2, CML_NCHW);
+    Linear* fc = linear_create(4 * 4 * 4, 2);
+    linear_init_xavier(fc);
+    for (int i = 0; i < conv->weight->size; i++) conv->weight->data[i] *= 0.3f;
+    Tensor* params[4] = { conv->weight, conv->bias, fc->weight, fc->bias };
+
+    int flat[2] = { N, 4 * 4 * 4 };
+    float loss_value = 0.0f;
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        Tensor* c = conv2d_forward(conv, x);
+        Tensor* a = relu(c);
+        Tensor* p = maxpool2d_forward(pool, a);
+        Tensor* f = tensor_reshape(p, flat, 2);
+        Tensor* logits = linear_forward(fc, f);
+        Tensor* loss = cross_entropy_loss(logits, y);
+
+        sgd_zero_grad(params, 4);
+        tensor_backward(loss);
+        sgd_step_params(params, 4, lr);
+
+        loss_value = loss->data[0];
+        if (epoch % 50 == 0 || epoch == epochs - 1) printf("Epoch %d | Loss = %f\n", epoch, loss_value);
+        tensor_release(c);
+        tensor_release(a);
+        tensor_release(p);
+        tensor_release(f);
+        tensor_release(logits);
+        tensor_release(loss);
+    }
+
+    tensor_release(x);
+    tensor_release(y);
+    conv2d_free(conv);
+    maxpool2d_free(pool);
+    linear_free(fc);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tensor/random.h"
+#include "tensor/cpu.h"
+#include "tensor/gemm.h"
+#include "tensor/small_matmul.h"
+
+#define N_MAP 1000
+#define GM 67
+#define GN 53
+#define GK 41
+#define N_SMALL 37
+#define N_SIZES 5
+
+static const int small_sizes[N_SIZES][2] = { { 8, 16 }, { 32, 2 }, { 2, 32 }, { 32, 32 }, { 16, 8 } };
+
+static float max_error(const float* a, const float* b, int n) {
+    float worst = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float err = fabsf(a[i] - b[i]) / (1.0f + fabsf(b[i]));
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+static void fill(float* x, int n, float lo, float hi) {
+    rng_uniform(x, n, lo, hi, rng_get_seed(), rng_reserve((uint64_t)n));
+}
+
+static float* run_small(int n, int p, const float* a, const float* b, const float* dy, float* out) {
+    const SmallMatmul* k = small_matmul_lookup(n, p);
+    memset(out, 0, sizeof(float) * (N_SMALL * (p + n) + n * p));
+    k->forward(N_SMALL, a, b, out);
+    out += N_SMALL * p;
+    k->grad_a(N_SMALL, dy, b, out);
+    out += N_SMALL * n;
+    k->grad_b(N_SMALL, a, dy, out);
+    return out + n * p;
+}
+
+static float run_level(const float* x, const float* y, const float* z, float* out) {
+    const CpuKernels* k = cpu_kernels();
+    float* o = out;
+
+    memset(o, 0, sizeof(float) * GM * GN);
+    gemm(0, 0, GM, GN, GK, 1.0f, x, GK, y, GN, 0.0f, o, GN);
+    o += GM * GN;
+
+    for (int op = LAZY_ADD; op < LAZY_SUM; op++, o += N_MAP)
+        k->map((LazyOp)op, 1.7f, o, op == LAZY_LOG ? z : x, y, N_MAP);
+
+    memcpy(o, z, sizeof(float) * N_MAP);
+    k->axpy(o, -0.3f, x, N_MAP);
+    o += N_MAP;
+    memcpy(o, z, sizeof(float) * N_MAP);
+    k->mul_acc(o, x, y, N_MAP);
+    o += N_MAP;
+    memcpy(o, z, sizeof(float) * N_MAP);
+    k->axpy(o, 1.0f, x, N_MAP);
+    o += N_MAP;
+
+    for (int s = 0; s < N_SIZES; s++) o = run_small(small_sizes[s][0], small_sizes[s][1], x, y, z, o);
+
+    return cpu_sum(x, N_MAP);
+}
+
+int main(void) {
+    rng_seed(41);
+    int n_in = GM * GK > N_MAP ? GM * GK : N_MAP;
+    float* x = (float*)malloc(sizeof(float) * n_in);
+    float* y = (float*)malloc(sizeof(float) * n_in);
+    float* z = (float*)malloc(sizeof(float) * n_in);
+    fill(x, n_in, -2.0f, 2.0f);
+    fill(y, n_in, -2.0f, 2.0f);
+    fill(z, n_in, 0.1f, 3.0f);
+
+    int n_out = GM * GN + (LAZY_SUM + 3) * N_MAP;
+    for (int s = 0; s < N_SIZES; s++) {
+        int n = small_sizes[s][0], p = small_sizes[s][1];
+        n_out += N_SMALL * (p + n) + n * p;
+    }
+
+    CpuLevel detected = cpu_detect();
+    float* ref = (float*)malloc(sizeof(float) * n_out);
+    float* out = (float*)malloc(sizeof(float) * n_out);
+    cpu_set_level(CPU_GENERIC);
+    float ref_sum = run_level(x, y, z, ref);
+
+    int failed = 0;
+    printf("detected %s\n", cpu_level_name(detected));
+    for (int level = CPU_GENERIC; level < CPU_LEVELS; level++) {
+        if (level > (int)detected) {
+            printf("%-8s skipped (not supported by this CPU)\n", cpu_level_name((CpuLevel)level));
+            continue;
+        }
+        cpu_set_level((CpuLevel)level);
+        memset(out, 0, sizeof(float) * n_out);
+        float sum = run_level(x, y, z, out);
+        float err = max_error(out, ref, n_out);
+        int ok = err < 1e-5f && sum == ref_sum;
+        printf("%-8s max error vs generic %.3g | sum %s | %s\n", cpu_level_name((CpuLevel)level), err,
+               sum == ref_sum ? "identical" : "differs", ok ? "ok" : "FAILED");
+        if (!ok) failed = 1;
+    }
+    cpu_set_level(detected);
+
+    free(x);
+    free(y);
+    free(z);
+    free(ref);
+    free(out);
+    return failed;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "tensor/tensor.h"
+#include "data/csv.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+#include "parallel/dist.h"
+
+static Tensor* shard(Tensor* t, int rank, int world_size) {
+    int N = t->shape[0];
+    int begin = (int)((long)N * rank / world_size);
+    int end = (int)((long)N * (rank + 1) / world_size);
+    int cols = t->ndim == 2 ? t->shape[1] : 1;
+    int shape[2] = { end - begin, cols };
+    return tensor_from_data(t->ndim, shape, t->data + begin * cols, 0);
+}
+
+int main() {
+    if (dist_init_env() < 0) return 1;
+    int rank = dist_rank();
+    int world_size = dist_world_size();
+
+    Tensor* X_all = tensor_from_csv("data/train_X.csv");
+    Tensor* y_all = tensor_from_csv("data/train_y.csv");
+    Tensor* X = shard(X_all, rank, world_size);
+    Tensor* y = shard(y_all, rank, world_size);
+    float weight = (float)X->shape[0] / (float)X_all->shape[0];
+
+    Linear* fc1 = linear_create(X->shape[1], 4);
+    Linear* fc2 = linear_create(4, 4);
+    Linear* fc3 = linear_create(4, 2);
+
+    Tensor* params[6] = { fc1->weight, fc1->bias, fc2->weight, fc2->bias, fc3->weight, fc3->bias };
+    dist_broadcast_params(params, 6);
+    dist_register_params(params, 6, 1 << 16);
+
+    int epochs = 1000;
+    float lr = 0.1f;
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        Tensor* out1 = linear_forward(fc1, X);
+        Tensor* act1 = relu(out1);
+        Tensor* out2 = linear_forward(fc2, act1);
+        Tensor* act2 = relu(out2);
+        Tensor* logits = linear_forward(fc3, act2);
+        Tensor* loss = cross_entropy_loss(logits, y);
+
+        sgd_zero_grad(params, 6);
+        dist_backward_weighted(loss, weight);
+        sgd_step_params(params, 6, lr);
+
+        float global_loss = weight * loss->data[0];
+        dist_all_reduce(&global_loss, 1);
+        if (epoch % 100 == 0 && rank == 0) {
+            printf("Epoch %d | Loss = %.6f\n", epoch, global_loss);
+            fflush(stdout);
+        }
+
+        tensor_release(out1);
+        tensor_release(act1);
+        tensor_release(out2);
+        tensor_release(act2);
+        tensor_release(logits);
+        tensor_release(loss);
+    }
+
+    dist_finalize();
+    tensor_release(X);
+    tensor_release(y);
+    tensor_release(X_all);
+    tensor_release(y_all);
+    linear_free(fc1);
+    linear_free(fc2);
+    linear_free(fc3);
+
+    return 0;
+}
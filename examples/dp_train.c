@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "tensor/tensor.h"
+#include "data/csv.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "parallel/data_parallel.h"
+
+static Tensor* mlp_loss(Linear** layers, int n_layers, Tensor* x, Tensor* y) {
+    Tensor* h = x;
+    tensor_retain(h);
+    for (int l = 0; l < n_layers; l++) {
+        Tensor* out = linear_forward(layers[l], h);
+        tensor_release(h);
+        if (l == n_layers - 1) {
+            h = out;
+            break;
+        }
+        h = relu(out);
+        tensor_release(out);
+    }
+
+    Tensor* loss = cross_entropy_loss(h, y);
+    tensor_release(h);
+    return loss;
+}
+
+int main(int argc, char** argv) {
+    int n_replicas = argc > 1 ? atoi(argv[1]) : 2;
+
+    Tensor* X = tensor_from_csv("data/train_X.csv");
+    Tensor* y = tensor_from_csv("data/train_y.csv");
+
+    Linear* layers[3] = {
+        linear_create(X->shape[1], 4),
+        linear_create(4, 4),
+        linear_create(4, 2),
+    };
+
+    DataParallel* dp = dp_create(layers, 3, n_replicas, mlp_loss);
+
+    int epochs = 1000;
+    float lr = 0.1f;
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        float loss = dp_step(dp, X, y, lr);
+        if (epoch % 100 == 0) {
+            printf("Epoch %d | Loss = %.6f\n", epoch, loss);
+            fflush(stdout);
+        }
+    }
+
+    dp_free(dp);
+    tensor_release(X);
+    tensor_release(y);
+    for (int l = 0; l < 3; l++) linear_free(layers[l]);
+
+    return 0;
+}
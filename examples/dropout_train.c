@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/dropout.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+static int mask_check(float p) {
+    Dropout* drop = dropout_create(p);
+    int shape[2] = { 64, 128 };
+    Tensor* x = tensor_randn(2, shape, 1);
+    Tensor* y = dropout_forward(drop, x);
+    Tensor* noise = dropout_forward(drop, x);
+    Tensor* loss = tensor_sum(y);
+    tensor_backward(loss);
+
+    int kept = 0, bad = 0;
+    float scale = 1.0f / (1.0f - p);
+    for (int i = 0; i < x->size; i++) {
+        int keep = y->data[i] != 0.0f;
+        kept += keep;
+        if (keep && fabsf(y->data[i] - x->data[i] * scale) > 1e-5f * fabsf(y->data[i])) bad++;
+        if (x->grad[i] != (keep ? scale : 0.0f)) bad++;
+    }
+
+    drop->training = 0;
+    Tensor* eval = dropout_forward(drop, x);
+    for (int i = 0; i < x->size; i++)
+        if (eval->data[i] != x->data[i]) bad++;
+
+    printf("dropout check (p = %.2f): kept %.3f of inputs, %d mismatches between forward and regenerated backward mask\n",
+           p, (float)kept / x->size, bad);
+
+    tensor_release(x);
+    tensor_release(y);
+    tensor_release(noise);
+    tensor_release(loss);
+    tensor_release(eval);
+    dropout_free(drop);
+    return bad == 0 && fabsf((float)kept / shape[0] / shape[1] - (1.0f - p)) < 0.03f;
+}
+
+static void make_blobs(Tensor* x, Tensor* y, uint64_t seed) {
+    int N = x->shape[0], D = x->shape[1];
+    rng_normal(x->data, x->size, 0.0f, 1.0f, seed, 0);
+    for (int n = 0; n < N; n++) {
+        int label = n % 2;
+        y->data[n] = (float)label;
+        for (int d = 0; d < 4; d++) x->data[n * D + d] += label ? 0.6f : -0.6f;
+    }
+}
+
+static Tensor* model_loss(Linear* fc1, Linear* fc2, Dropout* drop, Tensor* x, Tensor* y, float* accuracy) {
+    Tensor* h = linear_forward(fc1, x);
+    Tensor* a = relu(h);
+    Tensor* d = dropout_forward(drop, a);
+    Tensor* logits = linear_forward(fc2, d);
+    Tensor* loss = cross_entropy_loss(logits, y);
+    if (accuracy) {
+        int correct = 0;
+        for (int n = 0; n < logits->shape[0]; n++)
+            correct += (logits->data[2 * n + 1] > logits->data[2 * n]) == (int)y->data[n];
+        *accuracy = (float)correct / logits->shape[0];
+    }
+    tensor_release(h);
+    tensor_release(a);
+    tensor_release(d);
+    tensor_release(logits);
+    return loss;
+}
+
+int main(int argc, char** argv) {
+    float p = 0.5f, lr = 0.05f;
+    int epochs = 300, hidden = 256;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--p")) p = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--hidden")) hidden = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    rng_seed(8);
+    if (!mask_check(0.1f) || !mask_check(0.5f)) {
+        fprintf(stderr, "dropout mask check failed\n");
+        return 1;
+    }
+
+    int train_shape[2] = { 64, 32 };
+    int test_shape[2] = { 1024, 32 };
+    Tensor* x = tensor_create(2, train_shape, 0);
+    Tensor* y = tensor_create(1, train_shape, 0);
+    Tensor* x_test = tensor_create(2, test_shape, 0);
+    Tensor* y_test = tensor_create(1, test_shape, 0);
+    make_blobs(x, y, 31);
+    make_blobs(x_test, y_test, 32);
+
+    Linear* fc1 = linear_create(32, hidden);
+    Linear* fc2 = linear_create(hidden, 2);
+    linear_init_kaiming(fc1);
+    linear_init_xavier(fc2);
+    Dropout* drop = dropout_create(p);
+    Tensor* params[4] = { fc1->weight, fc1->bias, fc2->weight, fc2->bias };
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        drop->training = 1;
+        Tensor* loss = model_loss(fc1, fc2, drop, x, y, NULL);
+        sgd_zero_grad(params, 4);
+        tensor_backward(loss);
+        sgd_step_params(params, 4, lr);
+        tensor_release(loss);
+
+        if (epoch % 50 == 0 || epoch == epochs - 1) {
+            float acc;
+            drop->training = 0;
+            Tensor* test_loss = model_loss(fc1, fc2, drop, x_test, y_test, &acc);
+            printf("Epoch %d | test loss = %f | test accuracy = %.3f\n", epoch, test_loss->data[0], acc);
+            tensor_release(test_loss);
+        }
+    }
+
+    tensor_release(x);
+    tensor_release(y);
+    tensor_release(x_test);
+    tensor_release(y_test);
+    linear_free(fc1);
+    linear_free(fc2);
+    dropout_free(drop);
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/embedding.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+#include "optim/sparse.h"
+
+static Tensor* model_loss(Embedding* emb, Linear* fc1, Linear* fc2, Tensor* tokens, Tensor* y) {
+    int N = tokens->shape[0];
+    int flat[2] = { N, 2 * emb->embedding_dim };
+    Tensor* e = embedding_forward(emb, tokens);
+    Tensor* f = tensor_reshape(e, flat, 2);
+    Tensor* h = linear_forward(fc1, f);
+    Tensor* a = relu(h);
+    Tensor* logits = linear_forward(fc2, a);
+    Tensor* loss = cross_entropy_loss(logits, y);
+    tensor_release(e);
+    tensor_release(f);
+    tensor_release(h);
+    tensor_release(a);
+    tensor_release(logits);
+    return loss;
+}
+
+static int sparse_grad_check(Embedding* emb, Tensor* tokens) {
+    int dim = emb->embedding_dim;
+    Tensor* e = embedding_forward(emb, tokens);
+    Tensor* r = tensor_randn(e->ndim, e->shape, 0);
+    Tensor* m = tensor_mul(e, r);
+    Tensor* loss = tensor_sum(m);
+    embedding_zero_grad(emb);
+    tensor_backward(loss);
+    embedding_coalesce(emb);
+
+    float* dense = (float*)calloc((size_t)emb->num_embeddings * dim, sizeof(float));
+    for (int i = 0; i < tokens->size; i++)
+        for (int d = 0; d < dim; d++) dense[(size_t)(int)tokens->data[i] * dim + d] += r->data[(size_t)i * dim + d];
+
+    float worst = 0.0f;
+    int rows = 0;
+    for (int k = 0; k < emb->grad.nnz; k++) {
+        const float* row = emb->grad.values + (size_t)k * dim;
+        float* ref = dense + (size_t)emb->grad.indices[k] * dim;
+        for (int d = 0; d < dim; d++) {
+            float err = fabsf(row[d] - ref[d]);
+            if (err > worst) worst = err;
+            ref[d] = 0.0f;
+        }
+        rows++;
+    }
+    for (size_t i = 0; i < (size_t)emb->num_embeddings * dim; i++)
+        if (dense[i] != 0.0f) worst = INFINITY;
+    printf("sparse gradient check: %d unique rows for %d lookups, max error %.2e\n", rows, tokens->size, worst);
+
+    free(dense);
+    tensor_release(e);
+    tensor_release(r);
+    tensor_release(m);
+    tensor_release(loss);
+    embedding_zero_grad(emb);
+    return worst < 1e-5f;
+}
+
+int main(int argc, char** argv) {
+    int vocab = 5000, dim = 16, N = 256, steps = 600;
+    const char* optim = "adagrad";
+    float lr = 0.1f;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--vocab")) vocab = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--dim")) dim = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--batch")) N = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--steps")) steps = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--optim")) optim = argv[i + 1];
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    rng_seed(6);
+    Embedding* emb = embedding_create(vocab, dim);
+    for (int i = 0; i < emb->weight->size; i++) emb->weight->data[i] *= 0.1f;
+    Linear* fc1 = linear_create(2 * dim, 16);
+    Linear* fc2 = linear_create(16, 2);
+    linear_init_xavier(fc1);
+    linear_init_xavier(fc2);
+    Tensor* params[4] = { fc1->weight, fc1->bias, fc2->weight, fc2->bias };
+    SparseAdagrad* adagrad = strcmp(optim, "sgd") ? sparse_adagrad_create(emb, lr, 1e-8f) : NULL;
+
+    int t_shape[2] = { N, 2 };
+    Tensor* tokens = tensor_create(2, t_shape, 0);
+    Tensor* y = tensor_create(1, &N, 0);
+    float* u = (float*)malloc(sizeof(float) * 2 * N);
+
+    for (int i = 0; i < 2 * N; i++) tokens->data[i] = (float)(i % 7);
+    if (!sparse_grad_check(emb, tokens)) {
+        fprintf(stderr, "embedding sparse gradient check failed\n");
+        return 1;
+    }
+
+    for (int step = 0; step < steps; step++) {
+        rng_uniform(u, 2 * N, 0.0f, 1.0f, 23, (uint64_t)step * 2 * N);
+        for (int n = 0; n < N; n++) {
+            int a = (int)(u[2 * n] * vocab), b = (int)(u[2 * n + 1] * vocab);
+            tokens->data[2 * n] = (float)a;
+            tokens->data[2 * n + 1] = (float)b;
+            y->data[n] = (float)((a % 2) | (b % 2));
+        }
+
+        Tensor* loss = model_loss(emb, fc1, fc2, tokens, y);
+        sgd_zero_grad(params, 4);
+        embedding_zero_grad(emb);
+        tensor_backward(loss);
+        sgd_step_params(params, 4, lr);
+        if (adagrad) sparse_adagrad_step(adagrad);
+        else sparse_sgd_step(emb, lr);
+
+        if (step % 100 == 0 || step == steps - 1)
+            printf("Step %d | Loss = %f | %d of %d rows updated\n", step, loss->data[0], emb->grad.nnz, vocab);
+        tensor_release(loss);
+    }
+
+    free(u);
+    tensor_release(tokens);
+    tensor_release(y);
+    sparse_adagrad_free(adagrad);
+    embedding_free(emb);
+    linear_free(fc1);
+    linear_free(fc2);
+    return 0;
+}
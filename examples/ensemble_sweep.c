@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "data/csv.h"
+#include "nn/mlp.h"
+#include "nn/loss.h"
+#include "nn/ensemble.h"
+#include "optim/sgd.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float train_separately(int n_layers, const int* dims, Tensor* X, Tensor* y, int epochs, float lr) {
+    MLP* mlp = mlp_create(n_layers, dims);
+    Tensor* params[2 * n_layers];
+    mlp_params(mlp, params);
+    float final = 0.0f;
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        Tensor* logits = mlp_forward(mlp, X);
+        Tensor* loss = cross_entropy_loss(logits, y);
+        sgd_zero_grad(params, 2 * n_layers);
+        tensor_backward(loss);
+        sgd_step_params(params, 2 * n_layers, lr);
+        final = loss->data[0];
+        tensor_release(logits);
+        tensor_release(loss);
+    }
+    mlp_free(mlp);
+    return final;
+}
+
+int main(int argc, char** argv) {
+    int models = 256, epochs = 1000, compare = 16;
+    float lr_min = 0.01f, lr_max = 1.0f;
+    const char* save_path = NULL;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--models")) models = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr-min")) lr_min = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr-max")) lr_max = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--compare")) compare = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--save")) save_path = argv[i + 1];
+    }
+
+    Tensor* X = tensor_from_csv("data/train_X.csv");
+    Tensor* y = tensor_from_csv("data/train_y.csv");
+    int dims[4] = { X->shape[1], 4, 4, 2 };
+
+    float* lr = (float*)malloc(sizeof(float) * models);
+    for (int k = 0; k < models; k++)
+        lr[k] = models > 1 ? lr_min * powf(lr_max / lr_min, (float)k / (models - 1)) : lr_min;
+
+    Ensemble* e = ensemble_create(models, 3, dims, lr);
+    float* losses = (float*)malloc(sizeof(float) * models);
+
+    double start = now();
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        Tensor* logits = ensemble_forward(e, X);
+        Tensor* loss = ensemble_cross_entropy_loss(logits, y, losses);
+        ensemble_zero_grad(e);
+        tensor_backward(loss);
+        ensemble_sgd_step(e);
+        tensor_release(logits);
+        tensor_release(loss);
+    }
+    double ensemble_time = now() - start;
+
+    int best = 0;
+    for (int k = 1; k < models; k++)
+        if (losses[k] < losses[best]) best = k;
+    printf("ensemble: %d models x %d epochs in %.3f s (%.0f model-epochs/s)\n",
+           models, epochs, ensemble_time, models * (double)epochs / ensemble_time);
+    printf("best lr = %.4f | loss = %.6f\n", lr[best], losses[best]);
+    for (int k = 0; k < models; k += models > 8 ? models / 8 : 1)
+        printf("  lr %.4f -> loss %.6f\n", lr[k], losses[k]);
+
+    if (compare > 0) {
+        if (compare > models) compare = models;
+        start = now();
+        for (int k = 0; k < compare; k++) train_separately(3, dims, X, y, epochs, lr[k]);
+        double separate_time = now() - start;
+        printf("separate: %d models x %d epochs in %.3f s (%.0f model-epochs/s) | ensemble speedup %.1fx\n",
+               compare, epochs, separate_time, compare * (double)epochs / separate_time,
+               (separate_time / compare) / (ensemble_time / models));
+    }
+
+    if (save_path) {
+        MLP* mlp = ensemble_get_model(e, best);
+        if (mlp && mlp_save(mlp, save_path) == 0) printf("saved model %d to %s\n", best, save_path);
+        mlp_free(mlp);
+    }
+
+    free(losses);
+    free(lr);
+    ensemble_free(e);
+    tensor_release(X);
+    tensor_release(y);
+    return 0;
+}
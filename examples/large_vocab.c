@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/linear.h"
+#include "nn/loss.h"
+#include "nn/large_softmax.h"
+#include "optim/sgd.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float full_softmax_loss(Linear* proj, Tensor* h, Tensor* y) {
+    int N = h->shape[0], dim = h->shape[1], one = 1;
+    int shape[2] = { 1, dim };
+    double total = 0.0;
+    for (int i = 0; i < N; i++) {
+        Tensor* hi = tensor_from_data(2, shape, h->data + (size_t)i * dim, 0);
+        Tensor* yi = tensor_from_data(1, &one, y->data + i, 0);
+        Tensor* logits = linear_forward(proj, hi);
+        Tensor* loss = cross_entropy_loss(logits, yi);
+        total += loss->data[0];
+        tensor_release(loss);
+        tensor_release(logits);
+        tensor_release(yi);
+        tensor_release(hi);
+    }
+    return (float)(total / N);
+}
+
+int main(int argc, char** argv) {
+    const char* mode = "chunked";
+    int classes = 100000, batch = 128, dim = 128, steps = 20, samples = 1024, chunk = 4096;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--mode")) mode = argv[i + 1];
+        else if (!strcmp(argv[i], "--classes")) classes = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--batch")) batch = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--dim")) dim = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--steps")) steps = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--samples")) samples = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--chunk")) chunk = atoi(argv[i + 1]);
+    }
+
+    rng_seed(3);
+    Linear* proj = linear_create(dim, classes);
+    linear_init_xavier(proj);
+
+    int h_shape[2] = { batch, dim };
+    Tensor* h = tensor_randn(2, h_shape, 0);
+    Tensor* y = tensor_create(1, &batch, 0);
+    float* u = (float*)malloc(sizeof(float) * batch);
+    rng_uniform(u, batch, 0.0f, 1.0f, 11, 0);
+    for (int i = 0; i < batch; i++) y->data[i] = (float)(int)(u[i] * u[i] * u[i] * classes);
+    free(u);
+
+    Tensor* params[2] = { proj->weight, proj->bias };
+    double elapsed = 0.0;
+    for (int step = 0; step < steps; step++) {
+        double start = now();
+        Tensor* logits = NULL;
+        Tensor* loss;
+        if (!strcmp(mode, "full")) {
+            logits = linear_forward(proj, h);
+            loss = cross_entropy_loss(logits, y);
+        } else if (!strcmp(mode, "sampled")) {
+            loss = sampled_softmax_loss(proj, h, y, samples);
+        } else {
+            loss = chunked_softmax_loss(proj, h, y, chunk);
+        }
+
+        sgd_zero_grad(params, 2);
+        tensor_backward(loss);
+        elapsed += now() - start;
+
+        if (step % 5 == 0 || step == steps - 1) {
+            float full = full_softmax_loss(proj, h, y);
+            printf("step %d | %s loss = %.4f | full softmax loss = %.4f\n", step, mode, loss->data[0], full);
+        }
+
+        start = now();
+        sgd_step_params(params, 2, 0.5f);
+        elapsed += now() - start;
+        tensor_release(loss);
+        tensor_release(logits);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%s: %d classes, batch %d, dim %d | %.1f ms/step | peak RSS %ld MB\n",
+           mode, classes, batch, dim, 1000.0 * elapsed / steps, usage.ru_maxrss / 1024);
+
+    tensor_release(h);
+    tensor_release(y);
+    linear_free(proj);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/mlp.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float max_error(const float* a, const float* b, int n) {
+    float worst = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float err = fabsf(a[i] - b[i]) / (1.0f + fabsf(b[i]));
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+static float run_step(MLP* mlp, Tensor* x, Tensor* y, int mse, float* out, float* grads) {
+    int n_params = mlp_num_params(mlp);
+    Tensor* params[16];
+    mlp_params(mlp, params);
+    sgd_zero_grad(params, n_params);
+
+    Tensor* pred = mlp_forward(mlp, x);
+    Tensor* loss = mse ? mse_loss(pred, y) : cross_entropy_loss(pred, y);
+    memcpy(out, pred->data, sizeof(float) * pred->size);
+    tensor_backward(loss);
+    float value = loss->data[0];
+    for (int k = 0; k < n_params; k++) {
+        memcpy(grads, params[k]->grad, sizeof(float) * params[k]->size);
+        grads += params[k]->size;
+    }
+    tensor_release(pred);
+    tensor_release(loss);
+    return value;
+}
+
+static int lazy_check(MLP* mlp, Tensor* x, Tensor* y, int mse, int n_grads) {
+    int n_out = x->shape[0] * mlp->layers[mlp->n_layers - 1]->out_features;
+    float* out[2];
+    float* grads[2];
+    float loss[2];
+    for (int lazy = 0; lazy < 2; lazy++) {
+        out[lazy] = (float*)malloc(sizeof(float) * n_out);
+        grads[lazy] = (float*)malloc(sizeof(float) * n_grads);
+        tensor_set_lazy(lazy);
+        loss[lazy] = run_step(mlp, x, y, mse, out[lazy], grads[lazy]);
+    }
+    float loss_err = max_error(&loss[1], &loss[0], 1);
+    float out_err = max_error(out[1], out[0], n_out);
+    float grad_err = max_error(grads[1], grads[0], n_grads);
+    printf("%s: lazy vs eager | loss %.2e, output %.2e, grads %.2e\n", mse ? "mse" : "cross entropy",
+           loss_err, out_err, grad_err);
+    for (int lazy = 0; lazy < 2; lazy++) {
+        free(out[lazy]);
+        free(grads[lazy]);
+    }
+    return loss_err < 1e-5f && out_err < 1e-5f && grad_err < 1e-5f;
+}
+
+int main(int argc, char** argv) {
+    int N = argc > 1 ? atoi(argv[1]) : 4096;
+    int iters = argc > 2 ? atoi(argv[2]) : 50;
+
+    rng_seed(5);
+    int dims[4] = { 16, 64, 64, 4 };
+    MLP* mlp = mlp_create(3, dims);
+    int n_grads = 0;
+    for (int l = 0; l < mlp->n_layers; l++)
+        n_grads += mlp->layers[l]->weight->size + mlp->layers[l]->bias->size;
+
+    int x_shape[2] = { 256, 16 }, t_shape[2] = { 256, 4 }, n = 256;
+    Tensor* x = tensor_randn(2, x_shape, 0);
+    Tensor* targets = tensor_randn(2, t_shape, 0);
+    Tensor* labels = tensor_create(1, &n, 0);
+    for (int i = 0; i < n; i++) labels->data[i] = (float)(i % 4);
+
+    int ok = lazy_check(mlp, x, targets, 1, n_grads);
+    ok &= lazy_check(mlp, x, labels, 0, n_grads);
+    tensor_release(x);
+    tensor_release(targets);
+    tensor_release(labels);
+    mlp_free(mlp);
+    if (!ok) {
+        fprintf(stderr, "lazy self-check failed\n");
+        return 1;
+    }
+
+    int shape[2] = { N, 256 };
+    Tensor* pred = tensor_randn(2, shape, 1);
+    Tensor* target = tensor_randn(2, shape, 0);
+    for (int lazy = 0; lazy < 2; lazy++) {
+        tensor_set_lazy(lazy);
+        double start = now();
+        for (int it = 0; it < iters; it++) {
+            Tensor* loss = mse_loss(pred, target);
+            tensor_zero_grad(pred);
+            tensor_backward(loss);
+            tensor_release(loss);
+        }
+        printf("mse_loss %d x 256, %s: %.3f ms/step\n", N, lazy ? "lazy" : "eager", 1e3 * (now() - start) / iters);
+    }
+    tensor_release(pred);
+    tensor_release(target);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/mlp.h"
+#include "nn/export.h"
+
+int main(int argc, char** argv) {
+    const char* model_path = "mlp.bin";
+    const char* name = "mlp_model";
+    const char* c_path = "mlp_model.c";
+    const char* h_path = "mlp_model.h";
+    int n_tests = 64;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--model")) model_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--name")) name = argv[i + 1];
+        else if (!strcmp(argv[i], "--out")) c_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--header")) h_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--tests")) n_tests = atoi(argv[i + 1]);
+    }
+
+    MLP* model = mlp_load(model_path, 0);
+    if (!model) return 1;
+
+    Tensor* test_x = NULL;
+    if (n_tests > 0) {
+        int shape[2] = { n_tests, model->layers[0]->in_features };
+        rng_seed(1234);
+        test_x = tensor_rand_uniform(2, shape, -2.0f, 2.0f, 0);
+    }
+
+    int rc = mlp_export_c(model, name, c_path, h_path, test_x);
+    if (rc == 0) {
+        printf("exported %s as %s() into %s and %s\n", model_path, name, c_path, h_path);
+        if (test_x) printf("check it with: gcc -O2 -DCML_EXPORT_SELFTEST %s -o %s_selftest && ./%s_selftest\n", c_path, name, name);
+    }
+
+    tensor_release(test_x);
+    mlp_free(model);
+    return rc == 0 ? 0 : 1;
+}
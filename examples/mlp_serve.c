@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "tensor/tensor.h"
+#include "data/csv.h"
+#include "nn/mlp.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+#include "serve/server.h"
+
+static Server* server = NULL;
+
+static void on_signal(int sig) {
+    (void)sig;
+    if (server) server_stop(server);
+}
+
+static void train_default(const char* path) {
+    Tensor* X = tensor_from_csv("data/train_X.csv");
+    Tensor* y = tensor_from_csv("data/train_y.csv");
+
+    int dims[4] = { X->shape[1], 4, 4, 2 };
+    MLP* mlp = mlp_create(3, dims);
+    Tensor* params[6];
+    mlp_params(mlp, params);
+
+    for (int epoch = 0; epoch < 1000; epoch++) {
+        Tensor* logits = mlp_forward(mlp, X);
+        Tensor* loss = cross_entropy_loss(logits, y);
+        sgd_zero_grad(params, 6);
+        tensor_backward(loss);
+        sgd_step_params(params, 6, 0.1f);
+        tensor_release(loss);
+        tensor_release(logits);
+    }
+
+    mlp_save(mlp, path);
+    mlp_free(mlp);
+    tensor_release(X);
+    tensor_release(y);
+}
+
+int main(int argc, char** argv) {
+    const char* model_path = "mlp.bin";
+    ServerConfig config = { "/tmp/cml.sock", 0, 64, 2000 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--model")) model_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--unix")) config.unix_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--port")) { config.tcp_port = atoi(argv[i + 1]); config.unix_path = NULL; }
+        else if (!strcmp(argv[i], "--max-batch")) config.max_batch = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--max-latency-us")) config.max_latency_us = atoi(argv[i + 1]);
+    }
+
+    MLP* model = mlp_load(model_path, 0);
+    if (!model) {
+        printf("training a default model into %s\n", model_path);
+        train_default(model_path);
+        model = mlp_load(model_path, 0);
+        if (!model) return 1;
+    }
+
+    server = server_create(model, &config);
+    if (!server) return 1;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    if (config.unix_path) printf("serving %s on %s (max batch %d, max latency %d us)\n", model_path, config.unix_path, config.max_batch, config.max_latency_us);
+    else printf("serving %s on 127.0.0.1:%d (max batch %d, max latency %d us)\n", model_path, config.tcp_port, config.max_batch, config.max_latency_us);
+    fflush(stdout);
+
+    server_run(server);
+
+    ServerStats stats;
+    server_get_stats(server, &stats);
+    printf("requests %.0f | batches %.0f | mean batch %.1f | %.0f req/s | p50 %.0f us | p99 %.0f us | max %.0f us\n",
+           stats.requests, stats.batches, stats.mean_batch, stats.throughput, stats.p50_us, stats.p99_us, stats.max_us);
+
+    server_free(server);
+    mlp_free(model);
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/norm.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+typedef struct {
+    LayerNorm* ln;
+    BatchNorm1d* bn;
+} Norm;
+
+static Tensor* norm_forward(Norm* n, Tensor* x) {
+    return n->ln ? layernorm_forward(n->ln, x) : batchnorm1d_forward(n->bn, x);
+}
+
+static Tensor* probe_loss(Norm* n, Tensor* x, Tensor* r) {
+    Tensor* y = norm_forward(n, x);
+    Tensor* m = tensor_mul(y, r);
+    Tensor* loss = tensor_sum(m);
+    tensor_release(y);
+    tensor_release(m);
+    return loss;
+}
+
+static float grad_error(Norm* n, Tensor* x, Tensor* r, Tensor* t) {
+    float worst = 0.0f;
+    for (int i = 0; i < t->size; i++) {
+        float saved = t->data[i];
+        t->data[i] = saved + 1e-3f;
+        Tensor* lp = probe_loss(n, x, r);
+        t->data[i] = saved - 1e-3f;
+        Tensor* lm = probe_loss(n, x, r);
+        t->data[i] = saved;
+        float fd = (lp->data[0] - lm->data[0]) / 2e-3f;
+        float err = fabsf(fd - t->grad[i]) / (1.0f + fabsf(fd));
+        if (err > worst) worst = err;
+        tensor_release(lp);
+        tensor_release(lm);
+    }
+    return worst;
+}
+
+static float forward_error(Norm* n, Tensor* x, Tensor* gamma, Tensor* beta, float eps, int per_row) {
+    int N = x->shape[0], F = x->shape[1];
+    Tensor* y = norm_forward(n, x);
+    float worst = 0.0f;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < F; j++) {
+            double mean = 0.0, var = 0.0;
+            int count = per_row ? F : N;
+            for (int k = 0; k < count; k++) mean += per_row ? x->data[i * F + k] : x->data[k * F + j];
+            mean /= count;
+            for (int k = 0; k < count; k++) {
+                double d = (per_row ? x->data[i * F + k] : x->data[k * F + j]) - mean;
+                var += d * d;
+            }
+            var /= count;
+            double ref = (x->data[i * F + j] - mean) / sqrt(var + eps) * gamma->data[j] + beta->data[j];
+            float err = fabsf((float)ref - y->data[i * F + j]);
+            if (err > worst) worst = err;
+        }
+    }
+    tensor_release(y);
+    return worst;
+}
+
+static int self_check(Norm* n, const char* name, Tensor* gamma, Tensor* beta, float eps, int per_row) {
+    int shape[2] = { 6, 5 };
+    Tensor* x = tensor_randn(2, shape, 1);
+    Tensor* r = tensor_randn(2, shape, 0);
+    for (int i = 0; i < x->size; i++) x->data[i] = 2.0f * x->data[i] + 1.0f;
+    rng_normal(gamma->data, gamma->size, 1.0f, 0.5f, rng_get_seed(), rng_reserve(gamma->size));
+    rng_normal(beta->data, beta->size, 0.0f, 0.5f, rng_get_seed(), rng_reserve(beta->size));
+
+    float fwd = forward_error(n, x, gamma, beta, eps, per_row);
+    Tensor* loss = probe_loss(n, x, r);
+    tensor_backward(loss);
+    tensor_release(loss);
+    float err = grad_error(n, x, r, x);
+    float e = grad_error(n, x, r, gamma);
+    if (e > err) err = e;
+    e = grad_error(n, x, r, beta);
+    if (e > err) err = e;
+    printf("%s check: forward max error %.2e, gradient max error %.2e\n", name, fwd, err);
+
+    tensor_release(x);
+    tensor_release(r);
+    return fwd < 1e-4f && err < 1e-2f;
+}
+
+static int eval_check(BatchNorm1d* bn) {
+    int shape[2] = { 4, bn->features };
+    Tensor* x = tensor_randn(2, shape, 0);
+    bn->training = 0;
+    Tensor* y = batchnorm1d_forward(bn, x);
+    bn->training = 1;
+    float worst = 0.0f;
+    for (int i = 0; i < x->size; i++) {
+        int j = i % bn->features;
+        float ref = (x->data[i] - bn->running_mean[j]) / sqrtf(bn->running_var[j] + bn->eps) * bn->gamma->data[j] + bn->beta->data[j];
+        float err = fabsf(ref - y->data[i]);
+        if (err > worst) worst = err;
+    }
+    printf("BatchNorm1d eval check: max error %.2e against running statistics\n", worst);
+    tensor_release(x);
+    tensor_release(y);
+    return worst < 1e-4f;
+}
+
+int main(int argc, char** argv) {
+    const char* mode = "batch";
+    int N = 128, hidden = 64, epochs = 300;
+    float lr = 0.05f;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--norm")) mode = argv[i + 1];
+        else if (!strcmp(argv[i], "--batch")) N = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--hidden")) hidden = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    rng_seed(9);
+    LayerNorm* ln_check = layernorm_create(5, 1e-5f);
+    BatchNorm1d* bn_check = batchnorm1d_create(5, 1e-5f, 0.1f);
+    Norm ln_norm = { ln_check, NULL }, bn_norm = { NULL, bn_check };
+    int ok = self_check(&ln_norm, "LayerNorm", ln_check->gamma, ln_check->beta, ln_check->eps, 1);
+    ok &= self_check(&bn_norm, "BatchNorm1d", bn_check->gamma, bn_check->beta, bn_check->eps, 0);
+    ok &= eval_check(bn_check);
+    layernorm_free(ln_check);
+    batchnorm1d_free(bn_check);
+    if (!ok) {
+        fprintf(stderr, "normalization self-check failed\n");
+        return 1;
+    }
+
+    int x_shape[2] = { N, 16 };
+    Tensor* x = tensor_randn(2, x_shape, 0);
+    Tensor* y = tensor_create(1, &N, 0);
+    for (int n = 0; n < N; n++) {
+        float score = x->data[n * 16] - x->data[n * 16 + 1] + 0.5f * x->data[n * 16 + 2];
+        y->data[n] = score > 0.0f;
+    }
+
+    Linear* fc1 = linear_create(16, hidden);
+    Linear* fc2 = linear_create(hidden, 2);
+    linear_init_kaiming(fc1);
+    linear_init_xavier(fc2);
+    Norm norm = { NULL, NULL };
+    if (!strcmp(mode, "layer")) norm.ln = layernorm_create(hidden, 1e-5f);
+    else if (strcmp(mode, "none")) norm.bn = batchnorm1d_create(hidden, 1e-5f, 0.1f);
+    Tensor* params[6] = { fc1->weight, fc1->bias, fc2->weight, fc2->bias, NULL, NULL };
+    int n_params = 4;
+    if (norm.ln || norm.bn) {
+        params[n_params++] = norm.ln ? norm.ln->gamma : norm.bn->gamma;
+        params[n_params++] = norm.ln ? norm.ln->beta : norm.bn->beta;
+    }
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        Tensor* h = linear_forward(fc1, x);
+        Tensor* n = norm.ln || norm.bn ? norm_forward(&norm, h) : h;
+        Tensor* a = relu(n);
+        Tensor* logits = linear_forward(fc2, a);
+        Tensor* loss = cross_entropy_loss(logits, y);
+
+        sgd_zero_grad(params, n_params);
+        tensor_backward(loss);
+        sgd_step_params(params, n_params, lr);
+
+        if (epoch % 50 == 0 || epoch == epochs - 1) printf("Epoch %d | Loss = %f\n", epoch, loss->data[0]);
+        tensor_release(h);
+        if (n != h) tensor_release(n);
+        tensor_release(a);
+        tensor_release(logits);
+        tensor_release(loss);
+    }
+
+    if (norm.bn) norm.bn->training = 0;
+    Tensor* h = linear_forward(fc1, x);
+    Tensor* n = norm.ln || norm.bn ? norm_forward(&norm, h) : h;
+    Tensor* a = relu(n);
+    Tensor* logits = linear_forward(fc2, a);
+    int correct = 0;
+    for (int i = 0; i < N; i++) correct += (logits->data[i * 2 + 1] > logits->data[i * 2]) == (y->data[i] > 0.5f);
+    printf("Accuracy (%s norm, eval mode): %.1f%%\n", mode, 100.0f * correct / N);
+    tensor_release(h);
+    if (n != h) tensor_release(n);
+    tensor_release(a);
+    tensor_release(logits);
+
+    tensor_release(x);
+    tensor_release(y);
+    linear_free(fc1);
+    linear_free(fc2);
+    layernorm_free(norm.ln);
+    batchnorm1d_free(norm.bn);
+    return 0;
+}
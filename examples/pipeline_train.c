@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "tensor/tensor.h"
+#include "data/csv.h"
+#include "nn/linear.h"
+#include "nn/loss.h"
+#include "parallel/pipeline.h"
+
+int main(int argc, char** argv) {
+    int n_stages = argc > 1 ? atoi(argv[1]) : 3;
+    int n_micro = argc > 2 ? atoi(argv[2]) : 2;
+
+    Tensor* X = tensor_from_csv("data/train_X.csv");
+    Tensor* y = tensor_from_csv("data/train_y.csv");
+
+    Linear* layers[3] = {
+        linear_create(X->shape[1], 4),
+        linear_create(4, 4),
+        linear_create(4, 2),
+    };
+
+    Pipeline* pipe = pipeline_create(layers, 3, n_stages, cross_entropy_loss);
+
+    int epochs = 1000;
+    float lr = 0.1f;
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        float loss = pipeline_step(pipe, X, y, n_micro, lr);
+        if (epoch % 100 == 0) {
+            printf("Epoch %d | Loss = %.6f\n", epoch, loss);
+            fflush(stdout);
+        }
+    }
+
+    pipeline_free(pipe);
+    tensor_release(X);
+    tensor_release(y);
+    for (int l = 0; l < 3; l++) linear_free(layers[l]);
+
+    return 0;
+}
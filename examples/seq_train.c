@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/loss.h"
+#include "nn/rnn.h"
+#include "optim/sgd.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    Linear* x_proj[4];
+    Tensor* w_h[4];
+} ComposedLSTM;
+
+static Tensor* composed_gate(ComposedLSTM* m, int k, Tensor* x, Tensor* h) {
+    Tensor* xp = linear_forward(m->x_proj[k], x);
+    Tensor* hp = tensor_matmul(h, m->w_h[k]);
+    Tensor* pre = tensor_add(xp, hp);
+    tensor_release(xp);
+    tensor_release(hp);
+    Tensor* act = k == 2 ? tanh_tensor(pre) : sigmoid(pre);
+    tensor_release(pre);
+    return act;
+}
+
+static Tensor* composed_loss(ComposedLSTM* m, Linear* head, Tensor** xs, Tensor** ys, int T, int N, int H) {
+    int state_shape[2] = { N, H };
+    Tensor* h = tensor_zeros(2, state_shape, 0);
+    Tensor* c = tensor_zeros(2, state_shape, 0);
+    Tensor* total = NULL;
+    for (int t = 0; t < T; t++) {
+        Tensor* i = composed_gate(m, 0, xs[t], h);
+        Tensor* f = composed_gate(m, 1, xs[t], h);
+        Tensor* g = composed_gate(m, 2, xs[t], h);
+        Tensor* o = composed_gate(m, 3, xs[t], h);
+        Tensor* fc = tensor_mul(f, c);
+        Tensor* ig = tensor_mul(i, g);
+        Tensor* c_next = tensor_add(fc, ig);
+        Tensor* tc = tanh_tensor(c_next);
+        Tensor* h_next = tensor_mul(o, tc);
+        Tensor* logits = linear_forward(head, h_next);
+        Tensor* step_loss = cross_entropy_loss(logits, ys[t]);
+        Tensor* sum = total ? tensor_add(total, step_loss) : step_loss;
+        if (total) {
+            tensor_release(total);
+            tensor_release(step_loss);
+        }
+        total = sum;
+        tensor_release(i);
+        tensor_release(f);
+        tensor_release(g);
+        tensor_release(o);
+        tensor_release(fc);
+        tensor_release(ig);
+        tensor_release(tc);
+        tensor_release(logits);
+        tensor_release(h);
+        tensor_release(c);
+        h = h_next;
+        c = c_next;
+    }
+    tensor_release(h);
+    tensor_release(c);
+    Tensor* loss = tensor_mul_scalar(total, 1.0f / T);
+    tensor_release(total);
+    return loss;
+}
+
+static Tensor* probe_loss(LSTM* lstm, GRU* gru, Tensor* x, Tensor* h0, Tensor* c0, Tensor* r) {
+    Tensor* out = lstm ? lstm_forward(lstm, x, h0, c0) : gru_forward(gru, x, h0);
+    Tensor* m = tensor_mul(out, r);
+    Tensor* loss = tensor_sum(m);
+    tensor_release(out);
+    tensor_release(m);
+    return loss;
+}
+
+static float grad_error(LSTM* lstm, GRU* gru, Tensor* x, Tensor* h0, Tensor* c0, Tensor* r, Tensor* t) {
+    float worst = 0.0f;
+    for (int i = 0; i < t->size; i++) {
+        float saved = t->data[i];
+        t->data[i] = saved + 1e-3f;
+        Tensor* lp = probe_loss(lstm, gru, x, h0, c0, r);
+        t->data[i] = saved - 1e-3f;
+        Tensor* lm = probe_loss(lstm, gru, x, h0, c0, r);
+        t->data[i] = saved;
+        float fd = (lp->data[0] - lm->data[0]) / 2e-3f;
+        float err = fabsf(fd - t->grad[i]) / (1.0f + fabsf(fd));
+        if (err > worst) worst = err;
+        tensor_release(lp);
+        tensor_release(lm);
+    }
+    return worst;
+}
+
+static int bptt_check(int use_gru) {
+    int T = 5, N = 3, in = 4, H = 6;
+    LSTM* lstm = use_gru ? NULL : lstm_create(in, H);
+    GRU* gru = use_gru ? gru_create(in, H) : NULL;
+    int x_shape[3] = { T, N, in }, state_shape[2] = { N, H }, out_shape[3] = { T, N, H };
+    Tensor* x = tensor_randn(3, x_shape, 1);
+    Tensor* h0 = tensor_randn(2, state_shape, 1);
+    Tensor* c0 = use_gru ? NULL : tensor_randn(2, state_shape, 1);
+    Tensor* r = tensor_randn(3, out_shape, 0);
+
+    Tensor* loss = probe_loss(lstm, gru, x, h0, c0, r);
+    tensor_backward(loss);
+    tensor_release(loss);
+
+    Tensor* checked[8] = { x, h0 };
+    int n_checked = 2;
+    if (lstm) {
+        checked[n_checked++] = c0;
+        checked[n_checked++] = lstm->w_ih;
+        checked[n_checked++] = lstm->w_hh;
+        checked[n_checked++] = lstm->bias;
+    } else {
+        checked[n_checked++] = gru->w_ih;
+        checked[n_checked++] = gru->w_hh;
+        checked[n_checked++] = gru->b_ih;
+        checked[n_checked++] = gru->b_hh;
+    }
+    float worst = 0.0f;
+    for (int k = 0; k < n_checked; k++) {
+        float err = grad_error(lstm, gru, x, h0, c0, r, checked[k]);
+        if (err > worst) worst = err;
+    }
+    printf("%s BPTT check (x, h0%s, weights, biases): max error %.2e\n", use_gru ? "GRU" : "LSTM",
+           use_gru ? "" : ", c0", worst);
+
+    tensor_release(x);
+    tensor_release(h0);
+    tensor_release(c0);
+    tensor_release(r);
+    lstm_free(lstm);
+    gru_free(gru);
+    return worst < 1e-2f;
+}
+
+static Tensor* fused_loss(LSTM* lstm, GRU* gru, Linear* head, Tensor* x, Tensor* y, int T, int N, int H) {
+    Tensor* out = lstm ? lstm_forward(lstm, x, NULL, NULL) : gru_forward(gru, x, NULL);
+    int flat[2] = { T * N, H };
+    Tensor* rows = tensor_reshape(out, flat, 2);
+    Tensor* logits = linear_forward(head, rows);
+    Tensor* loss = cross_entropy_loss(logits, y);
+    tensor_release(out);
+    tensor_release(rows);
+    tensor_release(logits);
+    return loss;
+}
+
+int main(int argc, char** argv) {
+    const char* cell = "lstm";
+    int T = 32, N = 64, H = 64, epochs = 300;
+    float lr = 0.5f;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--cell")) cell = argv[i + 1];
+        else if (!strcmp(argv[i], "--steps")) T = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--batch")) N = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--hidden")) H = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    if (!bptt_check(0) || !bptt_check(1)) {
+        fprintf(stderr, "recurrent gradient check failed\n");
+        return 1;
+    }
+
+    rng_seed(5);
+    int x_shape[3] = { T, N, 1 };
+    int y_shape[1] = { T * N };
+    Tensor* x = tensor_create(3, x_shape, 0);
+    Tensor* y = tensor_create(1, y_shape, 0);
+    rng_uniform(x->data, x->size, 0.0f, 1.0f, 17, 0);
+    for (int n = 0; n < N; n++) {
+        float sum = 0.0f;
+        for (int t = 0; t < T; t++) {
+            float v = x->data[t * N + n] < 0.5f ? -1.0f : 1.0f;
+            x->data[t * N + n] = v;
+            sum += v;
+            y->data[t * N + n] = sum > 0.0f ? 1.0f : 0.0f;
+        }
+    }
+
+    LSTM* lstm = NULL;
+    GRU* gru = NULL;
+    ComposedLSTM composed;
+    Tensor** xs = NULL;
+    Tensor** ys = NULL;
+    Tensor* params[16];
+    int n_params = 0;
+    if (!strcmp(cell, "gru")) {
+        gru = gru_create(1, H);
+        params[n_params++] = gru->w_ih;
+        params[n_params++] = gru->w_hh;
+        params[n_params++] = gru->b_ih;
+        params[n_params++] = gru->b_hh;
+    } else if (!strcmp(cell, "composed")) {
+        int w_shape[2] = { H, H };
+        for (int k = 0; k < 4; k++) {
+            composed.x_proj[k] = linear_create(1, H);
+            composed.w_h[k] = tensor_randn(2, w_shape, 1);
+            for (int i = 0; i < composed.w_h[k]->size; i++) composed.w_h[k]->data[i] *= 0.1f;
+            params[n_params++] = composed.x_proj[k]->weight;
+            params[n_params++] = composed.x_proj[k]->bias;
+            params[n_params++] = composed.w_h[k];
+        }
+        int step_shape[2] = { N, 1 };
+        xs = (Tensor**)malloc(sizeof(Tensor*) * T);
+        ys = (Tensor**)malloc(sizeof(Tensor*) * T);
+        for (int t = 0; t < T; t++) {
+            xs[t] = tensor_from_data(2, step_shape, x->data + t * N, 0);
+            ys[t] = tensor_from_data(1, &N, y->data + t * N, 0);
+        }
+    } else {
+        lstm = lstm_create(1, H);
+        params[n_params++] = lstm->w_ih;
+        params[n_params++] = lstm->w_hh;
+        params[n_params++] = lstm->bias;
+    }
+    Linear* head = linear_create(H, 2);
+    params[n_params++] = head->weight;
+    params[n_params++] = head->bias;
+
+    double elapsed = 0.0;
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        double start = now();
+        Tensor* loss = xs ? composed_loss(&composed, head, xs, ys, T, N, H) : fused_loss(lstm, gru, head, x, y, T, N, H);
+        sgd_zero_grad(params, n_params);
+        tensor_backward(loss);
+        sgd_step_params(params, n_params, lr);
+        elapsed += now() - start;
+        if (epoch % 50 == 0 || epoch == epochs - 1) printf("Epoch %d | Loss = %f\n", epoch, loss->data[0]);
+        tensor_release(loss);
+    }
+    printf("%s: T = %d, batch %d, hidden %d | %.2f ms/step\n", cell, T, N, H, 1000.0 * elapsed / epochs);
+
+    if (xs) {
+        for (int t = 0; t < T; t++) {
+            tensor_release(xs[t]);
+            tensor_release(ys[t]);
+        }
+        free(xs);
+        free(ys);
+        for (int k = 0; k < 4; k++) {
+            linear_free(composed.x_proj[k]);
+            tensor_release(composed.w_h[k]);
+        }
+    }
+    lstm_free(lstm);
+    gru_free(gru);
+    linear_free(head);
+    tensor_release(x);
+    tensor_release(y);
+    return 0;
+}
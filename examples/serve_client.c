@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "serve/server.h"
+
+typedef struct {
+    const char* unix_path;
+    int port;
+    int in_dim;
+    int out_dim;
+    int n_requests;
+    int failures;
+} Client;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int connect_client(Client* c) {
+    return c->unix_path ? serve_connect_unix(c->unix_path) : serve_connect_tcp(c->port);
+}
+
+static void* client_main(void* arg) {
+    Client* c = (Client*)arg;
+    int fd = connect_client(c);
+    if (fd < 0) {
+        c->failures = c->n_requests;
+        return NULL;
+    }
+
+    float* x = (float*)malloc(sizeof(float) * c->in_dim);
+    float* y = (float*)malloc(sizeof(float) * c->out_dim);
+    for (int r = 0; r < c->n_requests; r++) {
+        for (int i = 0; i < c->in_dim; i++) x[i] = (float)((r + i) & 1);
+        if (serve_infer(fd, x, c->in_dim, y, c->out_dim) != c->out_dim) c->failures++;
+    }
+
+    free(x);
+    free(y);
+    close(fd);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    Client base = { "/tmp/cml.sock", 0, 2, 2, 1000, 0 };
+    int n_clients = 8;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--unix")) base.unix_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--port")) { base.port = atoi(argv[i + 1]); base.unix_path = NULL; }
+        else if (!strcmp(argv[i], "--clients")) n_clients = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--requests")) base.n_requests = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--in")) base.in_dim = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--out")) base.out_dim = atoi(argv[i + 1]);
+    }
+
+    Client* clients = (Client*)malloc(sizeof(Client) * n_clients);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * n_clients);
+    double start = now_seconds();
+    for (int i = 0; i < n_clients; i++) {
+        clients[i] = base;
+        pthread_create(&threads[i], NULL, client_main, &clients[i]);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < n_clients; i++) {
+        pthread_join(threads[i], NULL);
+        failures += clients[i].failures;
+    }
+    double elapsed = now_seconds() - start;
+    printf("%d clients x %d requests in %.3f s (%.0f req/s, %d failed)\n",
+           n_clients, base.n_requests, elapsed, n_clients * base.n_requests / elapsed, failures);
+
+    int fd = connect_client(&base);
+    ServerStats stats;
+    if (fd >= 0 && serve_query_stats(fd, &stats) == 0) {
+        printf("server: requests %.0f | batches %.0f | mean batch %.1f | p50 %.0f us | p99 %.0f us | max %.0f us\n",
+               stats.requests, stats.batches, stats.mean_batch, stats.p50_us, stats.p99_us, stats.max_us);
+    }
+    if (fd >= 0) close(fd);
+
+    free(clients);
+    free(threads);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "tensor/gemm.h"
+#include "tensor/small_matmul.h"
+
+#define MAX_DIM 100
+#define BENCH_ROWS 64
+#define BENCH_WORK (1 << 25)
+
+static const int widths[5] = { 2, 4, 8, 16, 32 };
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void fill(float* x, int n) {
+    rng_uniform(x, n, -1.0f, 1.0f, rng_get_seed(), rng_reserve((uint64_t)n));
+}
+
+static float max_error(const float* a, const double* b, int n) {
+    float worst = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float err = (float)(fabs(a[i] - b[i]) / (1.0 + fabs(b[i])));
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+static float check_shape(int m, int n, int p, double* ref, float* dy) {
+    int a_shape[2] = { m, n }, b_shape[2] = { n, p };
+    Tensor* a = tensor_create(2, a_shape, 1);
+    Tensor* b = tensor_create(2, b_shape, 1);
+    fill(a->data, a->size);
+    fill(b->data, b->size);
+    fill(dy, m * p);
+    tensor_zero_grad(a);
+    tensor_zero_grad(b);
+
+    Tensor* out = tensor_matmul(a, b);
+    tensor_backward_with_grad(out, dy);
+
+    for (int i = 0; i < m; i++)
+        for (int j = 0; j < p; j++) {
+            double acc = 0.0;
+            for (int k = 0; k < n; k++) acc += (double)a->data[i*n + k] * b->data[k*p + j];
+            ref[i*p + j] = acc;
+        }
+    float worst = max_error(out->data, ref, m * p);
+
+    for (int i = 0; i < m; i++)
+        for (int k = 0; k < n; k++) {
+            double acc = 0.0;
+            for (int j = 0; j < p; j++) acc += (double)dy[i*p + j] * b->data[k*p + j];
+            ref[i*n + k] = acc;
+        }
+    float err = max_error(a->grad, ref, m * n);
+    if (err > worst) worst = err;
+
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < p; j++) {
+            double acc = 0.0;
+            for (int i = 0; i < m; i++) acc += (double)a->data[i*n + k] * dy[i*p + j];
+            ref[k*p + j] = acc;
+        }
+    err = max_error(b->grad, ref, n * p);
+    if (err > worst) worst = err;
+
+    tensor_release(out);
+    tensor_release(a);
+    tensor_release(b);
+    return worst;
+}
+
+static double time_pass(int use_kernel, int n, int p, const float* a, const float* b, const float* dy,
+                        float* out, float* da, float* db) {
+    const SmallMatmul* k = small_matmul_lookup(n, p);
+    int m = BENCH_ROWS;
+    int reps = BENCH_WORK / (m * n * p) + 1;
+    double t0 = now();
+    for (int r = 0; r < reps; r++) {
+        if (use_kernel) {
+            k->forward(m, a, b, out);
+            k->grad_a(m, dy, b, da);
+            k->grad_b(m, a, dy, db);
+        } else {
+            gemm(0, 0, m, p, n, 1.0f, a, n, b, p, 0.0f, out, p);
+            gemm(0, 1, m, n, p, 1.0f, dy, p, b, p, 1.0f, da, n);
+            gemm(1, 0, n, p, m, 1.0f, a, n, dy, p, 1.0f, db, p);
+        }
+    }
+    return (now() - t0) / reps;
+}
+
+int main(void) {
+    rng_seed(32);
+    int big = 512;
+    double* ref = (double*)malloc(sizeof(double) * big * MAX_DIM);
+    float* dy = (float*)malloc(sizeof(float) * big * MAX_DIM);
+
+    float worst = 0.0f;
+    int shapes = 0;
+    for (int n = 1; n <= MAX_DIM; n++)
+        for (int p = 1; p <= MAX_DIM; p++) {
+            float err = check_shape(7, n, p, ref, dy);
+            if (err > worst) worst = err;
+            shapes++;
+        }
+    for (int i = 0; i < 5; i++)
+        for (int j = 0; j < 5; j++) {
+            float err = check_shape(big, widths[i], widths[j], ref, dy);
+            if (err > worst) worst = err;
+            shapes++;
+        }
+    int ok = worst < 1e-5f;
+    printf("matmul vs double reference: %d shapes (n, p in 1..%d), forward + grad_a + grad_b max error %.3g | %s\n",
+           shapes, MAX_DIM, worst, ok ? "ok" : "FAILED");
+
+    int m = BENCH_ROWS;
+    float* a = (float*)malloc(sizeof(float) * m * 32);
+    float* b = (float*)malloc(sizeof(float) * 32 * 32);
+    float* g = (float*)malloc(sizeof(float) * m * 32);
+    float* out = (float*)malloc(sizeof(float) * m * 32);
+    float* da = (float*)calloc(m * 32, sizeof(float));
+    float* db = (float*)calloc(32 * 32, sizeof(float));
+    fill(a, m * 32);
+    fill(b, 32 * 32);
+    fill(g, m * 32);
+
+    printf("\nforward + both grads, %d rows: unrolled kernel vs gemm speedup (rows n, columns p)\n", m);
+    printf("%6s", "");
+    for (int j = 0; j < 5; j++) printf("%8d", widths[j]);
+    printf("\n");
+    for (int i = 0; i < 5; i++) {
+        printf("%6d", widths[i]);
+        for (int j = 0; j < 5; j++) {
+            int n = widths[i], p = widths[j];
+            double t_gemm = time_pass(0, n, p, a, b, g, out, da, db);
+            double t_kernel = time_pass(1, n, p, a, b, g, out, da, db);
+            printf("%7.1fx", t_gemm / t_kernel);
+        }
+        printf("\n");
+    }
+
+    free(ref);
+    free(dy);
+    free(a);
+    free(b);
+    free(g);
+    free(out);
+    free(da);
+    free(db);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "tensor/sparse.h"
+#include "data/csv.h"
+#include "data/stream.h"
+#include "nn/linear.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int write_files(Tensor* x, const char* csv_path, const char* bin_path) {
+    int rows = x->shape[0], cols = x->shape[1];
+    FILE* fp = fopen(csv_path, "w");
+    if (!fp) {
+        fprintf(stderr, "cannot open %s\n", csv_path);
+        return -1;
+    }
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++) {
+            float v = x->data[(size_t)i * cols + j];
+            if (v == 0.0f) fprintf(fp, j + 1 < cols ? "0," : "0\n");
+            else fprintf(fp, j + 1 < cols ? "%.9g," : "%.9g\n", v);
+        }
+    fclose(fp);
+
+    FILE* bin = stream_bin_create(bin_path, cols);
+    if (!bin) return -1;
+    if (fwrite(x->data, sizeof(float) * cols, rows, bin) != (size_t)rows) {
+        fclose(bin);
+        return -1;
+    }
+    return stream_bin_finish(bin, rows);
+}
+
+static int same_csr(const CSRTensor* a, const CSRTensor* b) {
+    if (a->rows != b->rows || a->cols != b->cols || a->nnz != b->nnz) return 0;
+    return !memcmp(a->row_ptr, b->row_ptr, sizeof(int) * (a->rows + 1)) &&
+           !memcmp(a->col_idx, b->col_idx, sizeof(int) * a->nnz) &&
+           !memcmp(a->values, b->values, sizeof(float) * a->nnz);
+}
+
+static float max_error(const float* a, const float* b, int n) {
+    float worst = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float err = fabsf(a[i] - b[i]) / (1.0f + fabsf(b[i]));
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+static float probe(Linear* layer, Tensor* x, CSRTensor* a, Tensor* r, float* out, float* dw, float* db) {
+    linear_zero_grad(layer);
+    Tensor* y = a ? linear_forward_sparse(layer, a) : linear_forward(layer, x);
+    Tensor* m = tensor_mul(y, r);
+    Tensor* loss = tensor_sum(m);
+    tensor_backward(loss);
+    memcpy(out, tensor_eval(y), sizeof(float) * y->size);
+    memcpy(dw, layer->weight->grad, sizeof(float) * layer->weight->size);
+    memcpy(db, layer->bias->grad, sizeof(float) * layer->bias->size);
+    float value = loss->data[0];
+    tensor_release(y);
+    tensor_release(m);
+    tensor_release(loss);
+    return value;
+}
+
+static int sparse_check(Tensor* x, CSRTensor* a) {
+    int N = x->shape[0], D = x->shape[1], H = 16;
+    Linear* layer = linear_create(D, H);
+    int r_shape[2] = { N, H };
+    Tensor* r = tensor_randn(2, r_shape, 0);
+    float* out[2];
+    float* dw[2];
+    float* db[2];
+    for (int k = 0; k < 2; k++) {
+        out[k] = (float*)malloc(sizeof(float) * N * H);
+        dw[k] = (float*)malloc(sizeof(float) * D * H);
+        db[k] = (float*)malloc(sizeof(float) * H);
+        probe(layer, x, k ? a : NULL, r, out[k], dw[k], db[k]);
+    }
+    float e_out = max_error(out[1], out[0], N * H);
+    float e_dw = max_error(dw[1], dw[0], D * H);
+    float e_db = max_error(db[1], db[0], H);
+    printf("sparse vs dense Linear: output %.2e, dW %.2e, db %.2e\n", e_out, e_dw, e_db);
+    for (int k = 0; k < 2; k++) {
+        free(out[k]);
+        free(dw[k]);
+        free(db[k]);
+    }
+    tensor_release(r);
+    linear_free(layer);
+    return e_out < 1e-5f && e_dw < 1e-5f && e_db < 1e-5f;
+}
+
+int main(int argc, char** argv) {
+    int N = 512, D = 4096, epochs = 100;
+    float density = 0.01f, lr = 2.0f;
+    const char* csv_path = "/tmp/cml_sparse_X.csv";
+    const char* bin_path = "/tmp/cml_sparse_X.bin";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--rows")) N = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--features")) D = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--density")) density = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lr")) lr = (float)atof(argv[i + 1]);
+    }
+
+    rng_seed(3);
+    int x_shape[2] = { N, D };
+    Tensor* x = tensor_zeros(2, x_shape, 0);
+    float* u = (float*)malloc(sizeof(float) * D);
+    float* w_true = (float*)malloc(sizeof(float) * D);
+    rng_normal(w_true, D, 0.0f, 1.0f, rng_get_seed(), rng_reserve(D));
+    Tensor* y = tensor_create(1, &N, 0);
+    for (int i = 0; i < N; i++) {
+        rng_uniform(u, D, 0.0f, 1.0f, rng_get_seed(), rng_reserve(D));
+        float score = 0.0f;
+        for (int j = 0; j < D; j++) {
+            if (u[j] >= density) continue;
+            float v = 1.0f + u[j] / density;
+            x->data[(size_t)i * D + j] = v;
+            score += v * w_true[j];
+        }
+        y->data[i] = score > 0.0f;
+    }
+    free(u);
+    free(w_true);
+
+    if (write_files(x, csv_path, bin_path) < 0) return 1;
+    CSRTensor* ref = csr_from_dense(x);
+    CSRTensor* from_csv = csr_from_csv(csv_path);
+    CSRTensor* a = csr_from_bin(bin_path);
+    if (!from_csv || !a) return 1;
+    int ok = same_csr(from_csv, ref) && same_csr(a, ref);
+    printf("loaded %d x %d, nnz %d (%.2f%%) from CSV and binary: %s\n", a->rows, a->cols, a->nnz,
+           100.0 * a->nnz / ((double)N * D), ok ? "match" : "MISMATCH");
+    ok &= sparse_check(x, a);
+    csr_free(ref);
+    csr_free(from_csv);
+    if (!ok) {
+        fprintf(stderr, "sparse self-check failed\n");
+        return 1;
+    }
+
+    for (int sparse = 1; sparse >= 0; sparse--) {
+        rng_seed(4);
+        Linear* layer = linear_create(D, 2);
+        Tensor* params[2] = { layer->weight, layer->bias };
+        float loss_value = 0.0f;
+        double start = now();
+        for (int epoch = 0; epoch < epochs; epoch++) {
+            Tensor* logits = sparse ? linear_forward_sparse(layer, a) : linear_forward(layer, x);
+            Tensor* loss = cross_entropy_loss(logits, y);
+            sgd_zero_grad(params, 2);
+            tensor_backward(loss);
+            sgd_step_params(params, 2, lr);
+            loss_value = loss->data[0];
+            tensor_release(logits);
+            tensor_release(loss);
+        }
+        printf("%s input: loss %.6f after %d epochs, %.3f ms/epoch\n", sparse ? "sparse" : "dense", loss_value, epochs,
+               1e3 * (now() - start) / epochs);
+        linear_free(layer);
+    }
+
+    csr_free(a);
+    tensor_release(x);
+    tensor_release(y);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "data/stream.h"
+#include "nn/mlp.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+#define SYNTH_FEATURES 16
+#define SYNTH_CHUNK 8192
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int write_synthetic(const char* x_path, const char* y_path, long long rows) {
+    FILE* fx = stream_bin_create(x_path, SYNTH_FEATURES);
+    FILE* fy = stream_bin_create(y_path, 1);
+    if (!fx || !fy) return -1;
+
+    float* x = (float*)malloc(sizeof(float) * SYNTH_CHUNK * SYNTH_FEATURES);
+    float y[SYNTH_CHUNK];
+    for (long long done = 0; done < rows; done += SYNTH_CHUNK) {
+        int n = rows - done < SYNTH_CHUNK ? (int)(rows - done) : SYNTH_CHUNK;
+        rng_normal(x, n * SYNTH_FEATURES, 0.0f, 1.0f, 7, (uint64_t)done * SYNTH_FEATURES);
+        for (int i = 0; i < n; i++) {
+            float* row = x + (size_t)i * SYNTH_FEATURES;
+            float score = row[0] * row[1] + row[2] - 0.5f * row[3];
+            y[i] = score > 0.0f ? 1.0f : 0.0f;
+        }
+        fwrite(x, sizeof(float) * SYNTH_FEATURES, n, fx);
+        fwrite(y, sizeof(float), n, fy);
+    }
+    free(x);
+    return stream_bin_finish(fx, rows) | stream_bin_finish(fy, rows);
+}
+
+int main(int argc, char** argv) {
+    const char* x_path = "/tmp/cml_stream_X.bin";
+    const char* y_path = "/tmp/cml_stream_y.bin";
+    int csv = 0;
+    long long synth = 2000000;
+    int epochs = 3;
+    StreamConfig config = { 256, 8192, 65536, 8, 0, 42 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--csv")) { x_path = argv[i + 1]; y_path = i + 2 < argc ? argv[i + 2] : NULL; csv = 1; synth = 0; i++; }
+        else if (!strcmp(argv[i], "--synth")) synth = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "--epochs")) epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--batch")) config.batch_size = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--shuffle")) config.shuffle_buffer = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--chunk")) config.chunk_rows = atoi(argv[i + 1]);
+    }
+
+    if (synth > 0) {
+        printf("writing %lld synthetic rows to %s / %s\n", synth, x_path, y_path);
+        if (write_synthetic(x_path, y_path, synth) < 0) return 1;
+    }
+
+    Stream* stream = csv ? stream_open_csv(x_path, y_path, &config) : stream_open_bin(x_path, y_path, &config);
+    if (!stream) return 1;
+    int n_features;
+    stream_shape(stream, &n_features, NULL);
+
+    int dims[4] = { n_features, 32, 32, 2 };
+    MLP* mlp = mlp_create(3, dims);
+    Tensor* params[6];
+    mlp_params(mlp, params);
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        double start = now(), waited = 0.0, total_loss = 0.0;
+        long long rows = 0;
+        int batches = 0;
+
+        for (;;) {
+            Tensor *X, *y;
+            double t0 = now();
+            int rc = stream_next(stream, &X, &y);
+            waited += now() - t0;
+            if (rc < 0) return 1;
+            if (rc == 0) break;
+
+            Tensor* logits = mlp_forward(mlp, X);
+            Tensor* loss = cross_entropy_loss(logits, y);
+            sgd_zero_grad(params, 6);
+            tensor_backward(loss);
+            sgd_step_params(params, 6, 0.05f);
+
+            total_loss += loss->data[0];
+            rows += X->shape[0];
+            batches++;
+            tensor_release(loss);
+            tensor_release(logits);
+            tensor_release(X);
+            tensor_release(y);
+        }
+
+        double elapsed = now() - start;
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        printf("Epoch %d | Loss = %.6f | %lld rows | %.0f rows/s | waited on I/O %.1f%% | peak RSS %ld MB\n",
+               epoch, batches ? total_loss / batches : 0.0, rows, rows / elapsed,
+               100.0 * waited / elapsed, usage.ru_maxrss / 1024);
+        fflush(stdout);
+    }
+
+    stream_close(stream);
+    mlp_free(mlp);
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "tensor/tensor.h"
+#include "tensor/random.h"
+#include "nn/linear.h"
+#include "nn/activations.h"
+#include "nn/embedding.h"
+#include "nn/loss.h"
+#include "optim/sgd.h"
+
+#define BRANCHES 8
+
+typedef struct {
+    Linear* trunk;
+    Linear* hidden[BRANCHES];
+    Linear* head[BRANCHES];
+    Embedding* emb;
+    Tensor* params[2 + 4 * BRANCHES];
+    int n_params;
+} WideModel;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void model_init(WideModel* m, int in, int width) {
+    m->trunk = linear_create(in, width);
+    m->emb = embedding_create(32, width / 2);
+    m->n_params = 0;
+    m->params[m->n_params++] = m->trunk->weight;
+    m->params[m->n_params++] = m->trunk->bias;
+    for (int b = 0; b < BRANCHES; b++) {
+        m->hidden[b] = linear_create(width, width / 2);
+        m->head[b] = linear_create(width / 2, 1);
+        linear_init_xavier(m->hidden[b]);
+        linear_init_xavier(m->head[b]);
+        m->params[m->n_params++] = m->hidden[b]->weight;
+        m->params[m->n_params++] = m->hidden[b]->bias;
+        m->params[m->n_params++] = m->head[b]->weight;
+        m->params[m->n_params++] = m->head[b]->bias;
+    }
+    linear_init_xavier(m->trunk);
+}
+
+static void model_free(WideModel* m) {
+    linear_free(m->trunk);
+    for (int b = 0; b < BRANCHES; b++) {
+        linear_free(m->hidden[b]);
+        linear_free(m->head[b]);
+    }
+    embedding_free(m->emb);
+}
+
+static float model_step(WideModel* m, Tensor* x, Tensor* ids, Tensor* y) {
+    sgd_zero_grad(m->params, m->n_params);
+    embedding_zero_grad(m->emb);
+
+    Tensor* t = linear_forward(m->trunk, x);
+    Tensor* h = relu(t);
+    Tensor* total = NULL;
+    for (int b = 0; b < BRANCHES; b++) {
+        Tensor* z = linear_forward(m->hidden[b], h);
+        Tensor* a = tanh_tensor(z);
+        Tensor* e = embedding_forward(m->emb, ids);
+        Tensor* s = tensor_add(a, e);
+        Tensor* o = linear_forward(m->head[b], s);
+        Tensor* next = total ? tensor_add(total, o) : o;
+        if (total) {
+            tensor_release(total);
+            tensor_release(o);
+        }
+        total = next;
+        tensor_release(z);
+        tensor_release(a);
+        tensor_release(e);
+        tensor_release(s);
+    }
+    Tensor* loss = mse_loss(total, y);
+    tensor_backward(loss);
+    float value = loss->data[0];
+
+    tensor_release(t);
+    tensor_release(h);
+    tensor_release(total);
+    tensor_release(loss);
+    return value;
+}
+
+static int grad_count(WideModel* m) {
+    int n = m->emb->num_embeddings * m->emb->embedding_dim;
+    for (int k = 0; k < m->n_params; k++) n += m->params[k]->size;
+    return n;
+}
+
+static void collect_grads(WideModel* m, float* out) {
+    for (int k = 0; k < m->n_params; k++) {
+        memcpy(out, m->params[k]->grad, sizeof(float) * m->params[k]->size);
+        out += m->params[k]->size;
+    }
+    int dim = m->emb->embedding_dim;
+    embedding_coalesce(m->emb);
+    memset(out, 0, sizeof(float) * m->emb->num_embeddings * dim);
+    for (int k = 0; k < m->emb->grad.nnz; k++)
+        memcpy(out + (size_t)m->emb->grad.indices[k] * dim, m->emb->grad.values + (size_t)k * dim, sizeof(float) * dim);
+}
+
+int main(int argc, char** argv) {
+    int N = argc > 1 ? atoi(argv[1]) : 256;
+    int width = argc > 2 ? atoi(argv[2]) : 128;
+    int runs = argc > 3 ? atoi(argv[3]) : 20;
+
+    rng_seed(11);
+    WideModel m;
+    model_init(&m, 32, width);
+    int x_shape[2] = { N, 32 }, y_shape[2] = { N, 1 };
+    Tensor* x = tensor_randn(2, x_shape, 0);
+    Tensor* y = tensor_randn(2, y_shape, 0);
+    Tensor* ids = tensor_create(1, &N, 0);
+    for (int i = 0; i < N; i++) ids->data[i] = (float)((i * 7) % m.emb->num_embeddings);
+
+    int n_grads = grad_count(&m);
+    float* serial = (float*)malloc(sizeof(float) * n_grads);
+    float* first = (float*)malloc(sizeof(float) * n_grads);
+    float* grads = (float*)malloc(sizeof(float) * n_grads);
+
+    tensor_set_parallel_backward(0);
+    float serial_loss = model_step(&m, x, ids, y);
+    collect_grads(&m, serial);
+
+    tensor_set_parallel_backward(1);
+    float worst = 0.0f;
+    int repeatable = 1;
+    for (int r = 0; r < runs; r++) {
+        float loss = model_step(&m, x, ids, y);
+        collect_grads(&m, r ? grads : first);
+        if (loss != serial_loss) repeatable = 0;
+        if (r && memcmp(grads, first, sizeof(float) * n_grads)) repeatable = 0;
+    }
+    for (int i = 0; i < n_grads; i++) {
+        float err = fabsf(first[i] - serial[i]) / (1.0f + fabsf(serial[i]));
+        if (err > worst) worst = err;
+    }
+    printf("parallel vs serial backward: max grad error %.2e over %d grads, %d parallel runs %s\n", worst, n_grads,
+           runs, repeatable ? "bit-identical" : "DIFFER");
+
+    double times[2];
+    for (int mode = 0; mode < 2; mode++) {
+        tensor_set_parallel_backward(mode);
+        double start = now();
+        for (int r = 0; r < runs; r++) model_step(&m, x, ids, y);
+        times[mode] = (now() - start) / runs;
+    }
+    printf("forward + backward, %d branches: serial %.3f ms, parallel %.3f ms\n", BRANCHES, 1e3 * times[0],
+           1e3 * times[1]);
+
+    free(serial);
+    free(first);
+    free(grads);
+    tensor_release(x);
+    tensor_release(y);
+    tensor_release(ids);
+    model_free(&m);
+    if (worst > 1e-5f || !repeatable) {
+        fprintf(stderr, "parallel backward self-check failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -1,29 +1,28 @@
 #include <stdlib.h>
-#include <math.h>
 #include "tensor.h"
+#include "../tensor/lazy.h"
+#include "../tensor/cpu.h"
 
 static void relu_backward(Tensor* out) {
     Tensor* x = out->parents[0];
     if (!x->requires_grad) return;
 
+    tensor_eval(out);
     for (int i = 0; i < x->size; i++) {
-        x->grad[i] += (x->data[i] > 0.0f) ? out->grad[i] : 0.0f;
+        x->grad[i] += (out->data[i] > 0.0f) ? out->grad[i] : 0.0f;
     }
 }
 
 Tensor* relu(Tensor* x) {
-    Tensor* out = tensor_create(x->ndim, x->shape, x->requires_grad);
-
-    for (int i = 0; i < x->size; i++) {
-        out->data[i] = x->data[i] > 0.0f ? x->data[i] : 0.0f;
+    Tensor* out = lazy_defer(LAZY_RELU, x, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(x->ndim, x->shape, x->requires_grad);
+        cpu_kernels()->map(LAZY_RELU, 0.0f, out->data, x->data, NULL, x->size);
     }
 
     if (out->requires_grad) {
-        out->parents = malloc(sizeof(Tensor*));
-        out->parents[0] = x;
-        out->n_parents = 1;
+        tensor_add_parent(out, x);
         out->backward = relu_backward;
-        tensor_retain(x);
     }
 
     return out;
@@ -33,6 +32,7 @@ static void sigmoid_backward(Tensor* out) {
     Tensor* x = out->parents[0];
     if (!x->requires_grad) return;
 
+    tensor_eval(out);
     for (int i = 0; i < x->size; i++) {
         float y = out->data[i];
         x->grad[i] += out->grad[i] * y * (1.0f - y);
@@ -40,18 +40,15 @@ static void sigmoid_backward(Tensor* out) {
 }
 
 Tensor* sigmoid(Tensor* x) {
-    Tensor* out = tensor_create(x->ndim, x->shape, x->requires_grad);
-
-    for (int i = 0; i < x->size; i++) {
-        out->data[i] = 1.0f / (1.0f + expf(-x->data[i]));
+    Tensor* out = lazy_defer(LAZY_SIGMOID, x, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(x->ndim, x->shape, x->requires_grad);
+        cpu_kernels()->map(LAZY_SIGMOID, 0.0f, out->data, x->data, NULL, x->size);
     }
 
     if (out->requires_grad) {
-        out->parents = malloc(sizeof(Tensor*));
-        out->parents[0] = x;
-        out->n_parents = 1;
+        tensor_add_parent(out, x);
         out->backward = sigmoid_backward;
-        tensor_retain(x);
     }
 
     return out;
@@ -62,6 +59,7 @@ static void tanh_backward(Tensor* out) {
     Tensor* x = out->parents[0];
     if (!x->requires_grad) return;
 
+    tensor_eval(out);
     for (int i = 0; i < x->size; i++) {
         float y = out->data[i];
         x->grad[i] += out->grad[i] * (1.0f - y * y);
@@ -69,18 +67,15 @@ static void tanh_backward(Tensor* out) {
 }
 
 Tensor* tanh_tensor(Tensor* x) {
-    Tensor* out = tensor_create(x->ndim, x->shape, x->requires_grad);
-
-    for (int i = 0; i < x->size; i++) {
-        out->data[i] = tanhf(x->data[i]);
+    Tensor* out = lazy_defer(LAZY_TANH, x, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(x->ndim, x->shape, x->requires_grad);
+        cpu_kernels()->map(LAZY_TANH, 0.0f, out->data, x->data, NULL, x->size);
     }
 
     if (out->requires_grad) {
-        out->parents = malloc(sizeof(Tensor*));
-        out->parents[0] = x;
-        out->n_parents = 1;
+        tensor_add_parent(out, x);
         out->backward = tanh_backward;
-        tensor_retain(x);
     }
 
     return out;
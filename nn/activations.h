@@ -3,6 +3,7 @@
 #include "../tensor/tensor.h"
 Tensor* relu(Tensor* x);
 Tensor* sigmoid(Tensor* x);
+Tensor* tanh_tensor(Tensor* x);
 Tensor* softmax(Tensor* x);
 Tensor* relu_backward(Tensor* grad_output, Tensor* x);
 Tensor* sigmoid_backward(Tensor* grad_output, Tensor* x);
@@ -0,0 +1,418 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "../tensor/tensor.h"
+#include "../tensor/gemm.h"
+#include "../parallel/pool.h"
+#include "conv.h"
+
+typedef struct {
+    int N, C, H, W;
+    int O, K, stride, padding;
+    int OH, OW;
+    int layout;
+    int tile;
+} ConvShape;
+
+typedef struct {
+    ConvShape s;
+    const float* x;
+    const float* w;
+    const float* b;
+    const float* dout;
+    float* out;
+    float* dx;
+    float* dw;
+    float* db;
+    int grain;
+} ConvTask;
+
+static int conv_tile(int ckk, int P) {
+    int tile = 65536 / (ckk > 0 ? ckk : 1);
+    tile = (tile + 15) & ~15;
+    if (tile < 16) tile = 16;
+    return tile < P ? tile : P;
+}
+
+static void im2col_nchw(const ConvShape* s, const float* x, int p0, int p1, float* col) {
+    int tile = p1 - p0;
+    for (int c = 0; c < s->C; c++)
+        for (int kh = 0; kh < s->K; kh++)
+            for (int kw = 0; kw < s->K; kw++) {
+                float* row = col + (size_t)((c*s->K + kh)*s->K + kw) * tile;
+                for (int p = p0; p < p1; p++) {
+                    int ih = (p / s->OW) * s->stride - s->padding + kh;
+                    int iw = (p % s->OW) * s->stride - s->padding + kw;
+                    row[p - p0] = (ih >= 0 && ih < s->H && iw >= 0 && iw < s->W)
+                        ? x[((size_t)c*s->H + ih)*s->W + iw] : 0.0f;
+                }
+            }
+}
+
+static void col2im_nchw(const ConvShape* s, const float* col, int p0, int p1, float* dx) {
+    int tile = p1 - p0;
+    for (int c = 0; c < s->C; c++)
+        for (int kh = 0; kh < s->K; kh++)
+            for (int kw = 0; kw < s->K; kw++) {
+                const float* row = col + (size_t)((c*s->K + kh)*s->K + kw) * tile;
+                for (int p = p0; p < p1; p++) {
+                    int ih = (p / s->OW) * s->stride - s->padding + kh;
+                    int iw = (p % s->OW) * s->stride - s->padding + kw;
+                    if (ih >= 0 && ih < s->H && iw >= 0 && iw < s->W)
+                        dx[((size_t)c*s->H + ih)*s->W + iw] += row[p - p0];
+                }
+            }
+}
+
+static void im2col_nhwc(const ConvShape* s, const float* x, int p0, int p1, float* col) {
+    int kkc = s->K * s->K * s->C;
+    for (int p = p0; p < p1; p++) {
+        float* row = col + (size_t)(p - p0) * kkc;
+        int oh = p / s->OW, ow = p % s->OW;
+        for (int kh = 0; kh < s->K; kh++)
+            for (int kw = 0; kw < s->K; kw++) {
+                int ih = oh * s->stride - s->padding + kh;
+                int iw = ow * s->stride - s->padding + kw;
+                float* dst = row + (kh*s->K + kw) * s->C;
+                if (ih >= 0 && ih < s->H && iw >= 0 && iw < s->W)
+                    memcpy(dst, x + ((size_t)ih*s->W + iw) * s->C, sizeof(float) * s->C);
+                else
+                    memset(dst, 0, sizeof(float) * s->C);
+            }
+    }
+}
+
+static void col2im_nhwc(const ConvShape* s, const float* col, int p0, int p1, float* dx) {
+    int kkc = s->K * s->K * s->C;
+    for (int p = p0; p < p1; p++) {
+        const float* row = col + (size_t)(p - p0) * kkc;
+        int oh = p / s->OW, ow = p % s->OW;
+        for (int kh = 0; kh < s->K; kh++)
+            for (int kw = 0; kw < s->K; kw++) {
+                int ih = oh * s->stride - s->padding + kh;
+                int iw = ow * s->stride - s->padding + kw;
+                if (ih < 0 || ih >= s->H || iw < 0 || iw >= s->W) continue;
+                const float* src = row + (kh*s->K + kw) * s->C;
+                float* dst = dx + ((size_t)ih*s->W + iw) * s->C;
+                for (int c = 0; c < s->C; c++) dst[c] += src[c];
+            }
+    }
+}
+
+static void forward_task(int begin, int end, void* arg) {
+    ConvTask* t = (ConvTask*)arg;
+    const ConvShape* s = &t->s;
+    int P = s->OH * s->OW;
+    int ckk = s->C * s->K * s->K;
+    int n_tiles = (P + s->tile - 1) / s->tile;
+    float* col = (float*)malloc(sizeof(float) * (size_t)ckk * s->tile);
+
+    for (int task = begin; task < end; task++) {
+        int n = task / n_tiles;
+        int p0 = (task % n_tiles) * s->tile;
+        int p1 = p0 + s->tile < P ? p0 + s->tile : P;
+        int tile = p1 - p0;
+
+        if (s->layout == CML_NCHW) {
+            const float* x = t->x + (size_t)n * s->C * s->H * s->W;
+            float* out = t->out + (size_t)n * s->O * P;
+            im2col_nchw(s, x, p0, p1, col);
+            gemm(0, 0, s->O, tile, ckk, 1.0f, t->w, ckk, col, tile, 0.0f, out + p0, P);
+            for (int o = 0; o < s->O; o++)
+                for (int p = p0; p < p1; p++) out[(size_t)o*P + p] += t->b[o];
+        } else {
+            const float* x = t->x + (size_t)n * s->H * s->W * s->C;
+            float* out = t->out + ((size_t)n * P + p0) * s->O;
+            im2col_nhwc(s, x, p0, p1, col);
+            gemm(0, 1, tile, s->O, ckk, 1.0f, col, ckk, t->w, ckk, 0.0f, out, s->O);
+            for (int p = 0; p < tile; p++)
+                for (int o = 0; o < s->O; o++) out[(size_t)p*s->O + o] += t->b[o];
+        }
+    }
+
+    free(col);
+}
+
+static void backward_task(int begin, int end, void* arg) {
+    ConvTask* t = (ConvTask*)arg;
+    const ConvShape* s = &t->s;
+    int P = s->OH * s->OW;
+    int ckk = s->C * s->K * s->K;
+    int in_size = s->C * s->H * s->W;
+    float* col = (float*)malloc(sizeof(float) * (size_t)ckk * s->tile);
+    float* dcol = t->dx ? (float*)malloc(sizeof(float) * (size_t)ckk * s->tile) : NULL;
+
+    int chunk = begin / t->grain;
+    float* dw = t->dw ? t->dw + (size_t)chunk * (s->O * ckk + s->O) : NULL;
+    float* db = dw ? dw + s->O * ckk : NULL;
+
+    for (int n = begin; n < end; n++) {
+        const float* x = t->x + (size_t)n * in_size;
+        float* dx = t->dx ? t->dx + (size_t)n * in_size : NULL;
+
+        for (int p0 = 0; p0 < P; p0 += s->tile) {
+            int p1 = p0 + s->tile < P ? p0 + s->tile : P;
+            int tile = p1 - p0;
+
+            if (s->layout == CML_NCHW) {
+                const float* dout = t->dout + (size_t)n * s->O * P + p0;
+                if (dw) {
+                    im2col_nchw(s, x, p0, p1, col);
+                    gemm(0, 1, s->O, ckk, tile, 1.0f, dout, P, col, tile, 1.0f, dw, ckk);
+                    for (int o = 0; o < s->O; o++)
+                        for (int p = 0; p < tile; p++) db[o] += dout[(size_t)o*P + p];
+                }
+                if (dx) {
+                    gemm(1, 0, ckk, tile, s->O, 1.0f, t->w, ckk, dout, P, 0.0f, dcol, tile);
+                    col2im_nchw(s, dcol, p0, p1, dx);
+                }
+            } else {
+                const float* dout = t->dout + ((size_t)n * P + p0) * s->O;
+                if (dw) {
+                    im2col_nhwc(s, x, p0, p1, col);
+                    gemm(1, 0, s->O, ckk, tile, 1.0f, dout, s->O, col, ckk, 1.0f, dw, ckk);
+                    for (int p = 0; p < tile; p++)
+                        for (int o = 0; o < s->O; o++) db[o] += dout[(size_t)p*s->O + o];
+                }
+                if (dx) {
+                    gemm(0, 0, tile, ckk, s->O, 1.0f, dout, s->O, t->w, ckk, 0.0f, dcol, ckk);
+                    col2im_nhwc(s, dcol, p0, p1, dx);
+                }
+            }
+        }
+    }
+
+    free(col);
+    free(dcol);
+}
+
+static void conv2d_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    Tensor* w = out->parents[1];
+    Tensor* b = out->parents[2];
+    ConvShape* s = (ConvShape*)out->ctx;
+
+    int threads = pool_num_threads();
+    int grain = (s->N + threads - 1) / threads;
+    int n_chunks = (s->N + grain - 1) / grain;
+    int w_size = s->O * s->C * s->K * s->K;
+    int need_w = w->requires_grad || b->requires_grad;
+
+    ConvTask task = { *s, x->data, w->data, NULL, out->grad, NULL,
+                      x->requires_grad ? x->grad : NULL, NULL, NULL, grain };
+    if (need_w) task.dw = (float*)calloc((size_t)n_chunks * (w_size + s->O), sizeof(float));
+
+    parallel_for(s->N, grain, backward_task, &task);
+
+    if (need_w) {
+        for (int c = 0; c < n_chunks; c++) {
+            const float* dw = task.dw + (size_t)c * (w_size + s->O);
+            if (w->requires_grad) for (int i = 0; i < w_size; i++) w->grad[i] += dw[i];
+            if (b->requires_grad) for (int o = 0; o < s->O; o++) b->grad[o] += dw[w_size + o];
+        }
+        free(task.dw);
+    }
+}
+
+Conv2d* conv2d_create(int in_channels, int out_channels, int kernel_size, int stride, int padding, int layout) {
+    Conv2d* layer = (Conv2d*)malloc(sizeof(Conv2d));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate Conv2d layer\n");
+        exit(1);
+    }
+
+    layer->in_channels = in_channels;
+    layer->out_channels = out_channels;
+    layer->kernel_size = kernel_size;
+    layer->stride = stride;
+    layer->padding = padding;
+    layer->layout = layout;
+
+    int w_shape[4] = { out_channels, in_channels, kernel_size, kernel_size };
+    if (layout == CML_NHWC) {
+        w_shape[1] = kernel_size;
+        w_shape[3] = in_channels;
+    }
+    int b_shape[1] = { out_channels };
+
+    layer->weight = tensor_randn(4, w_shape, 1);
+    layer->bias = tensor_zeros(1, b_shape, 1);
+
+    float scale = sqrtf(2.0f / (float)(in_channels * kernel_size * kernel_size));
+    for (int i = 0; i < layer->weight->size; i++) layer->weight->data[i] *= scale;
+
+    return layer;
+}
+
+Tensor* conv2d_forward(Conv2d* layer, Tensor* x) {
+    int c_axis = layer->layout == CML_NCHW ? 1 : 3;
+    if (x->ndim != 4 || x->shape[c_axis] != layer->in_channels) {
+        fprintf(stderr, "Conv2d forward shape mismatch: expected 4D input with %d channels\n", layer->in_channels);
+        exit(1);
+    }
+    tensor_eval(x);
+
+    ConvShape s;
+    s.N = x->shape[0];
+    s.C = layer->in_channels;
+    s.H = layer->layout == CML_NCHW ? x->shape[2] : x->shape[1];
+    s.W = layer->layout == CML_NCHW ? x->shape[3] : x->shape[2];
+    s.O = layer->out_channels;
+    s.K = layer->kernel_size;
+    s.stride = layer->stride;
+    s.padding = layer->padding;
+    s.OH = (s.H + 2*s.padding - s.K) / s.stride + 1;
+    s.OW = (s.W + 2*s.padding - s.K) / s.stride + 1;
+    s.layout = layer->layout;
+    if (s.OH <= 0 || s.OW <= 0) {
+        fprintf(stderr, "Conv2d forward: kernel larger than padded input\n");
+        exit(1);
+    }
+    s.tile = conv_tile(s.C * s.K * s.K, s.OH * s.OW);
+
+    int out_shape[4] = { s.N, s.O, s.OH, s.OW };
+    if (s.layout == CML_NHWC) {
+        out_shape[1] = s.OH;
+        out_shape[2] = s.OW;
+        out_shape[3] = s.O;
+    }
+    int requires_grad = x->requires_grad || layer->weight->requires_grad || layer->bias->requires_grad;
+    Tensor* out = tensor_create(4, out_shape, requires_grad);
+
+    int n_tiles = (s.OH * s.OW + s.tile - 1) / s.tile;
+    ConvTask task = { s, x->data, layer->weight->data, layer->bias->data, NULL, out->data, NULL, NULL, NULL, 1 };
+    parallel_for(s.N * n_tiles, 1, forward_task, &task);
+
+    if (out->requires_grad) {
+        ConvShape* ctx = (ConvShape*)malloc(sizeof(ConvShape));
+        *ctx = s;
+        tensor_add_parent(out, x);
+        tensor_add_parent(out, layer->weight);
+        tensor_add_parent(out, layer->bias);
+        out->backward = conv2d_backward;
+        out->ctx = ctx;
+    }
+
+    return out;
+}
+
+void conv2d_zero_grad(Conv2d* layer) {
+    tensor_zero_grad(layer->weight);
+    tensor_zero_grad(layer->bias);
+}
+
+void conv2d_free(Conv2d* layer) {
+    if (!layer) return;
+    tensor_release(layer->weight);
+    tensor_release(layer->bias);
+    free(layer);
+}
+
+typedef struct {
+    int count;
+    int argmax[];
+} PoolContext;
+
+typedef struct {
+    int C, H, W, OH, OW, K, stride, layout;
+    const float* x;
+    float* out;
+    int* argmax;
+} PoolTask;
+
+static void pool_task(int begin, int end, void* arg) {
+    PoolTask* t = (PoolTask*)arg;
+    int in_plane = t->H * t->W, out_plane = t->OH * t->OW;
+
+    for (int n = begin; n < end; n++)
+        for (int c = 0; c < t->C; c++)
+            for (int oh = 0; oh < t->OH; oh++)
+                for (int ow = 0; ow < t->OW; ow++) {
+                    float best = -FLT_MAX;
+                    int best_idx = 0;
+                    for (int kh = 0; kh < t->K; kh++)
+                        for (int kw = 0; kw < t->K; kw++) {
+                            int ih = oh * t->stride + kh, iw = ow * t->stride + kw;
+                            int idx = t->layout == CML_NCHW
+                                ? (n*t->C + c) * in_plane + ih*t->W + iw
+                                : ((n*t->H + ih) * t->W + iw) * t->C + c;
+                            if (t->x[idx] > best) { best = t->x[idx]; best_idx = idx; }
+                        }
+                    int o = t->layout == CML_NCHW
+                        ? (n*t->C + c) * out_plane + oh*t->OW + ow
+                        : ((n*t->OH + oh) * t->OW + ow) * t->C + c;
+                    t->out[o] = best;
+                    if (t->argmax) t->argmax[o] = best_idx;
+                }
+}
+
+static void maxpool2d_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    if (!x->requires_grad) return;
+
+    PoolContext* ctx = (PoolContext*)out->ctx;
+    for (int i = 0; i < ctx->count; i++)
+        x->grad[ctx->argmax[i]] += out->grad[i];
+}
+
+MaxPool2d* maxpool2d_create(int kernel_size, int stride, int layout) {
+    MaxPool2d* pool = (MaxPool2d*)malloc(sizeof(MaxPool2d));
+    pool->kernel_size = kernel_size;
+    pool->stride = stride > 0 ? stride : kernel_size;
+    pool->layout = layout;
+    return pool;
+}
+
+Tensor* maxpool2d_forward(MaxPool2d* pool, Tensor* x) {
+    if (x->ndim != 4) {
+        fprintf(stderr, "MaxPool2d forward expects a 4D input\n");
+        exit(1);
+    }
+    tensor_eval(x);
+
+    PoolTask t;
+    t.C = pool->layout == CML_NCHW ? x->shape[1] : x->shape[3];
+    t.H = pool->layout == CML_NCHW ? x->shape[2] : x->shape[1];
+    t.W = pool->layout == CML_NCHW ? x->shape[3] : x->shape[2];
+    t.K = pool->kernel_size;
+    t.stride = pool->stride;
+    t.layout = pool->layout;
+    t.OH = (t.H - t.K) / t.stride + 1;
+    t.OW = (t.W - t.K) / t.stride + 1;
+    if (t.OH <= 0 || t.OW <= 0) {
+        fprintf(stderr, "MaxPool2d forward: kernel larger than input\n");
+        exit(1);
+    }
+
+    int out_shape[4] = { x->shape[0], t.C, t.OH, t.OW };
+    if (pool->layout == CML_NHWC) {
+        out_shape[1] = t.OH;
+        out_shape[2] = t.OW;
+        out_shape[3] = t.C;
+    }
+    Tensor* out = tensor_create(4, out_shape, x->requires_grad);
+
+    PoolContext* ctx = NULL;
+    if (out->requires_grad) {
+        ctx = (PoolContext*)malloc(sizeof(PoolContext) + sizeof(int) * out->size);
+        ctx->count = out->size;
+    }
+    t.x = x->data;
+    t.out = out->data;
+    t.argmax = ctx ? ctx->argmax : NULL;
+    parallel_for(x->shape[0], 1, pool_task, &t);
+
+    if (out->requires_grad) {
+        tensor_add_parent(out, x);
+        out->backward = maxpool2d_backward;
+        out->ctx = ctx;
+    }
+
+    return out;
+}
+
+void maxpool2d_free(MaxPool2d* pool) {
+    free(pool);
+}
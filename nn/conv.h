@@ -0,0 +1,30 @@
+#ifndef CML_CONV_H
+#define CML_CONV_H
+#include "../tensor/tensor.h"
+#define CML_NCHW 0
+#define CML_NHWC 1
+typedef struct Conv2d Conv2d;
+struct Conv2d {
+    int in_channels;
+    int out_channels;
+    int kernel_size;
+    int stride;
+    int padding;
+    int layout;
+    Tensor* weight;
+    Tensor* bias;
+};
+typedef struct MaxPool2d MaxPool2d;
+struct MaxPool2d {
+    int kernel_size;
+    int stride;
+    int layout;
+};
+Conv2d* conv2d_create(int in_channels, int out_channels, int kernel_size, int stride, int padding, int layout);
+Tensor* conv2d_forward(Conv2d* layer, Tensor* x);
+void conv2d_zero_grad(Conv2d* layer);
+void conv2d_free(Conv2d* layer);
+MaxPool2d* maxpool2d_create(int kernel_size, int stride, int layout);
+Tensor* maxpool2d_forward(MaxPool2d* pool, Tensor* x);
+void maxpool2d_free(MaxPool2d* pool);
+#endif
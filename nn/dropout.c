@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "../tensor/tensor.h"
+#include "../tensor/random.h"
+#include "../parallel/pool.h"
+#include "dropout.h"
+
+#define DROPOUT_CHUNK 1024
+
+typedef struct {
+    float p;
+    float scale;
+    uint64_t seed;
+    uint64_t offset;
+} DropoutContext;
+
+typedef struct {
+    const DropoutContext* ctx;
+    const float* src;
+    float* dst;
+    int n;
+    int accumulate;
+} MaskTask;
+
+static void mask_task(int begin, int end, void* arg) {
+    MaskTask* t = (MaskTask*)arg;
+    const DropoutContext* ctx = t->ctx;
+    float u[DROPOUT_CHUNK];
+    for (int c = begin; c < end; c++) {
+        int i0 = c * DROPOUT_CHUNK;
+        int len = t->n - i0 < DROPOUT_CHUNK ? t->n - i0 : DROPOUT_CHUNK;
+        rng_uniform(u, len, 0.0f, 1.0f, ctx->seed, ctx->offset + (uint64_t)i0);
+        const float* src = t->src + i0;
+        float* dst = t->dst + i0;
+        if (t->accumulate) {
+            for (int i = 0; i < len; i++) dst[i] += u[i] >= ctx->p ? src[i] * ctx->scale : 0.0f;
+        } else {
+            for (int i = 0; i < len; i++) dst[i] = u[i] >= ctx->p ? src[i] * ctx->scale : 0.0f;
+        }
+    }
+}
+
+static void apply_mask(const DropoutContext* ctx, const float* src, float* dst, int n, int accumulate) {
+    MaskTask t = { ctx, src, dst, n, accumulate };
+    parallel_for((n + DROPOUT_CHUNK - 1) / DROPOUT_CHUNK, 0, mask_task, &t);
+}
+
+Dropout* dropout_create(float p) {
+    if (p < 0.0f || p > 1.0f) {
+        fprintf(stderr, "Dropout: p must be in [0, 1], got %f\n", p);
+        exit(1);
+    }
+
+    Dropout* layer = (Dropout*)malloc(sizeof(Dropout));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate Dropout layer\n");
+        exit(1);
+    }
+
+    layer->p = p;
+    layer->training = 1;
+    return layer;
+}
+
+static void dropout_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    if (!x->requires_grad) return;
+
+    apply_mask((DropoutContext*)out->ctx, out->grad, x->grad, x->size, 1);
+}
+
+Tensor* dropout_forward(Dropout* layer, Tensor* x) {
+    if (!layer->training || layer->p == 0.0f) {
+        tensor_retain(x);
+        return x;
+    }
+
+    DropoutContext* ctx = (DropoutContext*)malloc(sizeof(DropoutContext));
+    ctx->p = layer->p;
+    ctx->scale = layer->p < 1.0f ? 1.0f / (1.0f - layer->p) : 0.0f;
+    ctx->seed = rng_get_seed();
+    ctx->offset = rng_reserve(x->size);
+
+    Tensor* out = tensor_create(x->ndim, x->shape, x->requires_grad);
+    apply_mask(ctx, tensor_eval(x), out->data, x->size, 0);
+    out->ctx = ctx;
+
+    if (out->requires_grad) {
+        tensor_add_parent(out, x);
+        out->backward = dropout_backward;
+    }
+
+    return out;
+}
+
+void dropout_free(Dropout* layer) {
+    free(layer);
+}
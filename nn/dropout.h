@@ -0,0 +1,13 @@
+#ifndef CML_DROPOUT_H
+#define CML_DROPOUT_H
+#include <stdint.h>
+#include "../tensor/tensor.h"
+typedef struct Dropout Dropout;
+struct Dropout {
+    float p;
+    int training;
+};
+Dropout* dropout_create(float p);
+Tensor* dropout_forward(Dropout* layer, Tensor* x);
+void dropout_free(Dropout* layer);
+#endif
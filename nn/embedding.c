@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../tensor/tensor.h"
+#include "embedding.h"
+
+typedef struct {
+    Embedding* emb;
+    int n;
+    int indices[];
+} EmbeddingContext;
+
+Embedding* embedding_create(int num_embeddings, int embedding_dim) {
+    Embedding* emb = (Embedding*)malloc(sizeof(Embedding));
+    if (!emb) {
+        fprintf(stderr, "failed to allocate Embedding layer\n");
+        exit(1);
+    }
+
+    emb->num_embeddings = num_embeddings;
+    emb->embedding_dim = embedding_dim;
+    emb->requires_grad = 1;
+    emb->refcount = 1;
+
+    int w_shape[2] = { num_embeddings, embedding_dim };
+    emb->weight = tensor_randn(2, w_shape, 0);
+    memset(&emb->grad, 0, sizeof(SparseGrad));
+
+    return emb;
+}
+
+static void embedding_release(Embedding* emb) {
+    if (__atomic_sub_fetch(&emb->refcount, 1, __ATOMIC_ACQ_REL) > 0) return;
+    tensor_release(emb->weight);
+    free(emb->grad.indices);
+    free(emb->grad.values);
+    free(emb);
+}
+
+static void embedding_free_ctx(void* arg) {
+    EmbeddingContext* ctx = (EmbeddingContext*)arg;
+    embedding_release(ctx->emb);
+    free(ctx);
+}
+
+static void sparse_grad_reserve(SparseGrad* g, int nnz, int dim) {
+    if (nnz <= g->capacity) return;
+    int capacity = g->capacity ? g->capacity : 64;
+    while (capacity < nnz) capacity *= 2;
+    g->indices = (int*)realloc(g->indices, sizeof(int) * capacity);
+    g->values = (float*)realloc(g->values, sizeof(float) * (size_t)capacity * dim);
+    g->capacity = capacity;
+}
+
+static void embedding_backward(Tensor* out) {
+    EmbeddingContext* ctx = (EmbeddingContext*)out->ctx;
+    Embedding* emb = ctx->emb;
+    SparseGrad* g = &emb->grad;
+    int dim = emb->embedding_dim;
+
+    sparse_grad_reserve(g, g->nnz + ctx->n, dim);
+    memcpy(g->indices + g->nnz, ctx->indices, sizeof(int) * ctx->n);
+    memcpy(g->values + (size_t)g->nnz * dim, out->grad, sizeof(float) * (size_t)ctx->n * dim);
+    g->nnz += ctx->n;
+    g->coalesced = 0;
+}
+
+Tensor* embedding_forward(Embedding* emb, Tensor* indices) {
+    int dim = emb->embedding_dim;
+    int n = indices->size;
+
+    int out_shape[CML_MAX_DIMS];
+    if (indices->ndim >= CML_MAX_DIMS) {
+        fprintf(stderr, "Embedding forward: index tensor rank %d leaves no room for the embedding dim (CML_MAX_DIMS %d)\n",
+                indices->ndim, CML_MAX_DIMS);
+        exit(1);
+    }
+    memcpy(out_shape, indices->shape, sizeof(int) * indices->ndim);
+    out_shape[indices->ndim] = dim;
+
+    Tensor* out = tensor_create(indices->ndim + 1, out_shape, emb->requires_grad);
+    EmbeddingContext* ctx = emb->requires_grad ? (EmbeddingContext*)malloc(sizeof(EmbeddingContext) + sizeof(int) * n) : NULL;
+
+    tensor_eval(indices);
+    for (int i = 0; i < n; i++) {
+        int idx = (int)indices->data[i];
+        if (idx < 0 || idx >= emb->num_embeddings) {
+            fprintf(stderr, "Embedding forward: index %d out of range [0, %d)\n", idx, emb->num_embeddings);
+            exit(1);
+        }
+        if (ctx) ctx->indices[i] = idx;
+        memcpy(out->data + (size_t)i * dim, emb->weight->data + (size_t)idx * dim, sizeof(float) * dim);
+    }
+
+    if (!ctx) return out;
+
+    __atomic_add_fetch(&emb->refcount, 1, __ATOMIC_RELAXED);
+    ctx->emb = emb;
+    ctx->n = n;
+    out->backward = embedding_backward;
+    out->ctx = ctx;
+    out->free_ctx = embedding_free_ctx;
+    out->serial_backward = 1;
+    return out;
+}
+
+void embedding_zero_grad(Embedding* emb) {
+    emb->grad.nnz = 0;
+    emb->grad.coalesced = 1;
+}
+
+typedef struct {
+    int index;
+    int position;
+} GradEntry;
+
+static int compare_entries(const void* a, const void* b) {
+    const GradEntry* ea = (const GradEntry*)a;
+    const GradEntry* eb = (const GradEntry*)b;
+    if (ea->index != eb->index) return ea->index < eb->index ? -1 : 1;
+    return ea->position - eb->position;
+}
+
+void embedding_coalesce(Embedding* emb) {
+    SparseGrad* g = &emb->grad;
+    if (g->coalesced || g->nnz == 0) return;
+
+    int dim = emb->embedding_dim;
+    GradEntry* order = (GradEntry*)malloc(sizeof(GradEntry) * g->nnz);
+    for (int i = 0; i < g->nnz; i++) {
+        order[i].index = g->indices[i];
+        order[i].position = i;
+    }
+    qsort(order, g->nnz, sizeof(GradEntry), compare_entries);
+
+    int* indices = (int*)malloc(sizeof(int) * g->capacity);
+    float* values = (float*)malloc(sizeof(float) * (size_t)g->capacity * dim);
+    int unique = 0;
+    for (int i = 0; i < g->nnz; i++) {
+        const float* src = g->values + (size_t)order[i].position * dim;
+        if (unique > 0 && indices[unique - 1] == order[i].index) {
+            float* dst = values + (size_t)(unique - 1) * dim;
+            for (int d = 0; d < dim; d++) dst[d] += src[d];
+        } else {
+            indices[unique] = order[i].index;
+            memcpy(values + (size_t)unique * dim, src, sizeof(float) * dim);
+            unique++;
+        }
+    }
+
+    free(order);
+    free(g->indices);
+    free(g->values);
+    g->indices = indices;
+    g->values = values;
+    g->nnz = unique;
+    g->coalesced = 1;
+}
+
+void embedding_free(Embedding* emb) {
+    if (!emb) return;
+    embedding_release(emb);
+}
@@ -0,0 +1,26 @@
+#ifndef CML_EMBEDDING_H
+#define CML_EMBEDDING_H
+#include "../tensor/tensor.h"
+typedef struct SparseGrad SparseGrad;
+struct SparseGrad {
+    int* indices;
+    float* values;
+    int nnz;
+    int capacity;
+    int coalesced;
+};
+typedef struct Embedding Embedding;
+struct Embedding {
+    int num_embeddings;
+    int embedding_dim;
+    int requires_grad;
+    int refcount;
+    Tensor* weight;
+    SparseGrad grad;
+};
+Embedding* embedding_create(int num_embeddings, int embedding_dim);
+Tensor* embedding_forward(Embedding* emb, Tensor* indices);
+void embedding_zero_grad(Embedding* emb);
+void embedding_coalesce(Embedding* emb);
+void embedding_free(Embedding* emb);
+#endif
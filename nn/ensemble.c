@@ -0,0 +1,336 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../tensor/tensor.h"
+#include "../tensor/random.h"
+#include "../tensor/gemm.h"
+#include "../tensor/small_matmul.h"
+#include "../tensor/cpu.h"
+#include "../parallel/pool.h"
+#include "ensemble.h"
+
+typedef struct {
+    int relu;
+} StackedLinearContext;
+
+typedef struct {
+    int K;
+    int N;
+    int in;
+    int out;
+    int relu;
+    const SmallMatmul* kernel;
+    const float* x;
+    long x_stride;
+    const float* W;
+    const float* b;
+    float* y;
+    const float* dy;
+    float* dx;
+    float* dW;
+    float* db;
+} StackedLinearTask;
+
+Ensemble* ensemble_create(int n_models, int n_layers, const int* dims, const float* lr) {
+    Ensemble* e = (Ensemble*)malloc(sizeof(Ensemble));
+    if (!e) {
+        fprintf(stderr, "failed to allocate Ensemble\n");
+        exit(1);
+    }
+    e->n_models = n_models;
+    e->n_layers = n_layers;
+    e->dims = (int*)malloc(sizeof(int) * (n_layers + 1));
+    memcpy(e->dims, dims, sizeof(int) * (n_layers + 1));
+    e->weights = (Tensor**)malloc(sizeof(Tensor*) * n_layers);
+    e->biases = (Tensor**)malloc(sizeof(Tensor*) * n_layers);
+    e->lr = (float*)malloc(sizeof(float) * n_models);
+    for (int k = 0; k < n_models; k++) e->lr[k] = lr ? lr[k] : 0.1f;
+
+    for (int l = 0; l < n_layers; l++) {
+        int w_shape[3] = { n_models, dims[l], dims[l + 1] };
+        int b_shape[2] = { n_models, dims[l + 1] };
+        e->weights[l] = tensor_create(3, w_shape, 1);
+        e->biases[l] = tensor_zeros(2, b_shape, 1);
+    }
+    for (int k = 0; k < n_models; k++) {
+        for (int l = 0; l < n_layers; l++) {
+            long size = (long)dims[l] * dims[l + 1];
+            rng_normal(e->weights[l]->data + k * size, size, 0.0f, 1.0f, rng_get_seed(), rng_reserve(size));
+        }
+    }
+    return e;
+}
+
+static void stacked_linear_forward_task(int begin, int end, void* arg) {
+    StackedLinearTask* t = (StackedLinearTask*)arg;
+    const CpuKernels* kernels = cpu_kernels();
+    for (int k = begin; k < end; k++) {
+        const float* x = t->x + k * t->x_stride;
+        const float* W = t->W + (long)k * t->in * t->out;
+        const float* b = t->b + (long)k * t->out;
+        float* y = t->y + (long)k * t->N * t->out;
+
+        if (t->kernel) small_matmul_forward(t->kernel, t->N, t->in, t->out, x, W, y);
+        else gemm(0, 0, t->N, t->out, t->in, 1.0f, x, t->in, W, t->out, 0.0f, y, t->out);
+        for (int n = 0; n < t->N; n++) kernels->axpy(y + (long)n * t->out, 1.0f, b, t->out);
+        if (t->relu)
+            for (long i = 0; i < (long)t->N * t->out; i++)
+                if (y[i] < 0.0f) y[i] = 0.0f;
+    }
+}
+
+static void stacked_linear_backward_task(int begin, int end, void* arg) {
+    StackedLinearTask* t = (StackedLinearTask*)arg;
+    const CpuKernels* kernels = cpu_kernels();
+    long rows = (long)t->N * t->out;
+    float* masked = t->relu ? (float*)malloc(sizeof(float) * rows) : NULL;
+
+    for (int k = begin; k < end; k++) {
+        const float* x = t->x + k * t->x_stride;
+        const float* W = t->W + (long)k * t->in * t->out;
+        const float* dy = t->dy + k * rows;
+        if (t->relu) {
+            const float* y = t->y + k * rows;
+            for (long i = 0; i < rows; i++) masked[i] = y[i] > 0.0f ? dy[i] : 0.0f;
+            dy = masked;
+        }
+
+        if (t->dW) {
+            float* dW = t->dW + (long)k * t->in * t->out;
+            if (t->kernel) t->kernel->grad_b(t->N, x, dy, dW);
+            else gemm(1, 0, t->in, t->out, t->N, 1.0f, x, t->in, dy, t->out, 1.0f, dW, t->out);
+        }
+        if (t->db) {
+            float* db = t->db + (long)k * t->out;
+            for (int n = 0; n < t->N; n++) kernels->axpy(db, 1.0f, dy + (long)n * t->out, t->out);
+        }
+        if (t->dx) {
+            float* dx = t->dx + k * t->x_stride;
+            if (t->kernel) small_matmul_grad_a(t->kernel, t->N, t->in, t->out, dy, W, dx);
+            else gemm(0, 1, t->N, t->in, t->out, 1.0f, dy, t->out, W, t->out, 1.0f, dx, t->in);
+        }
+    }
+    free(masked);
+}
+
+static void stacked_linear_run(StackedLinearTask* t, pool_fn fn, int serial) {
+    if (serial || t->K < pool_num_threads()) fn(0, t->K, t);
+    else parallel_for(t->K, 1, fn, t);
+}
+
+static void stacked_linear_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    Tensor* W = out->parents[1];
+    Tensor* b = out->parents[2];
+    StackedLinearContext* ctx = (StackedLinearContext*)out->ctx;
+    int K = W->shape[0];
+
+    StackedLinearTask t = {
+        K, out->shape[1], W->shape[1], W->shape[2], ctx->relu, small_matmul_lookup(W->shape[1], W->shape[2]),
+        x->data, x->ndim == 3 ? (long)x->shape[1] * x->shape[2] : 0, W->data, b->data, out->data, out->grad,
+        x->requires_grad ? x->grad : NULL, W->requires_grad ? W->grad : NULL, b->requires_grad ? b->grad : NULL
+    };
+    stacked_linear_run(&t, stacked_linear_backward_task, t.dx && t.x_stride == 0);
+}
+
+static Tensor* stacked_linear(Tensor* x, Tensor* W, Tensor* b, int relu) {
+    int K = W->shape[0], in = W->shape[1], out_features = W->shape[2];
+    int shared = x->ndim == 2 && x->shape[1] == in;
+    if (!shared && !(x->ndim == 3 && x->shape[0] == K && x->shape[2] == in)) {
+        fprintf(stderr, "ensemble_forward: expected input [N, %d] or [%d, N, %d]\n", in, K, in);
+        return NULL;
+    }
+
+    int N = shared ? x->shape[0] : x->shape[1];
+    int shape[3] = { K, N, out_features };
+    Tensor* out = tensor_create(3, shape, x->requires_grad || W->requires_grad || b->requires_grad);
+    StackedLinearTask t = {
+        K, N, in, out_features, relu, small_matmul_lookup(in, out_features),
+        tensor_eval(x), shared ? 0 : (long)N * in, W->data, b->data, out->data, NULL, NULL, NULL, NULL
+    };
+    stacked_linear_run(&t, stacked_linear_forward_task, 0);
+
+    if (out->requires_grad) {
+        StackedLinearContext* ctx = (StackedLinearContext*)malloc(sizeof(StackedLinearContext));
+        ctx->relu = relu;
+        tensor_add_parent(out, x);
+        tensor_add_parent(out, W);
+        tensor_add_parent(out, b);
+        out->ctx = ctx;
+        out->backward = stacked_linear_backward;
+    }
+    return out;
+}
+
+Tensor* ensemble_forward(Ensemble* e, Tensor* x) {
+    Tensor* h = x;
+    tensor_retain(h);
+    for (int l = 0; l < e->n_layers; l++) {
+        Tensor* out = stacked_linear(h, e->weights[l], e->biases[l], l < e->n_layers - 1);
+        tensor_release(h);
+        if (!out) return NULL;
+        h = out;
+    }
+    return h;
+}
+
+typedef struct {
+    int K;
+    int N;
+    int C;
+    float data[];
+} StackedCEContext;
+
+typedef struct {
+    StackedCEContext* ctx;
+    const float* logits;
+    float* losses;
+} StackedCETask;
+
+static void stacked_ce_task(int begin, int end, void* arg) {
+    StackedCETask* t = (StackedCETask*)arg;
+    int N = t->ctx->N, C = t->ctx->C;
+    const float* targets = t->ctx->data + (long)t->ctx->K * N * C;
+
+    for (int k = begin; k < end; k++) {
+        float total = 0.0f;
+        for (int i = 0; i < N; i++) {
+            const float* z = t->logits + ((long)k * N + i) * C;
+            float* p = t->ctx->data + ((long)k * N + i) * C;
+            float m = z[0];
+            for (int j = 1; j < C; j++) m = z[j] > m ? z[j] : m;
+            float sum = 0.0f;
+            for (int j = 0; j < C; j++) {
+                p[j] = expf(z[j] - m);
+                sum += p[j];
+            }
+            for (int j = 0; j < C; j++) p[j] /= sum;
+            int target = (int)targets[i];
+            total += m + logf(sum) - z[target];
+            p[target] -= 1.0f;
+        }
+        t->losses[k] = total / (float)N;
+    }
+}
+
+static void stacked_ce_backward(Tensor* out) {
+    Tensor* logits = out->parents[0];
+    if (!logits->requires_grad) return;
+
+    StackedCEContext* ctx = (StackedCEContext*)out->ctx;
+    cpu_kernels()->axpy(logits->grad, out->grad[0] / (float)ctx->N, ctx->data, logits->size);
+}
+
+Tensor* ensemble_cross_entropy_loss(Tensor* logits, Tensor* targets, float* losses) {
+    if (logits->ndim != 3) {
+        fprintf(stderr, "ensemble_cross_entropy_loss: expected logits [K, N, C]\n");
+        return NULL;
+    }
+    int K = logits->shape[0], N = logits->shape[1], C = logits->shape[2];
+    if (targets->size != N || (targets->ndim != 1 && !(targets->ndim == 2 && targets->shape[1] == 1))) {
+        fprintf(stderr, "ensemble_cross_entropy_loss: expected %d targets\n", N);
+        return NULL;
+    }
+
+    StackedCEContext* ctx = (StackedCEContext*)malloc(sizeof(StackedCEContext) + sizeof(float) * ((size_t)logits->size + N));
+    ctx->K = K;
+    ctx->N = N;
+    ctx->C = C;
+    memcpy(ctx->data + logits->size, tensor_eval(targets), sizeof(float) * N);
+    for (int i = 0; i < N; i++) {
+        int target = (int)targets->data[i];
+        if (target < 0 || target >= C) {
+            fprintf(stderr, "ensemble_cross_entropy_loss: target %d out of range [0, %d)\n", target, C);
+            free(ctx);
+            return NULL;
+        }
+    }
+
+    float* per_model = losses ? losses : (float*)malloc(sizeof(float) * K);
+    StackedCETask t = { ctx, tensor_eval(logits), per_model };
+    if (K < pool_num_threads()) stacked_ce_task(0, K, &t);
+    else parallel_for(K, 1, stacked_ce_task, &t);
+
+    Tensor* loss = tensor_zeros(0, NULL, logits->requires_grad);
+    for (int k = 0; k < K; k++) loss->data[0] += per_model[k];
+    if (!losses) free(per_model);
+
+    if (loss->requires_grad) {
+        tensor_add_parent(loss, logits);
+        loss->ctx = ctx;
+        loss->backward = stacked_ce_backward;
+    } else {
+        free(ctx);
+    }
+    return loss;
+}
+
+void ensemble_zero_grad(Ensemble* e) {
+    for (int l = 0; l < e->n_layers; l++) {
+        memset(e->weights[l]->grad, 0, sizeof(float) * e->weights[l]->size);
+        memset(e->biases[l]->grad, 0, sizeof(float) * e->biases[l]->size);
+    }
+}
+
+static void sgd_models(int begin, int end, void* arg) {
+    Ensemble* e = (Ensemble*)arg;
+    const CpuKernels* kernels = cpu_kernels();
+    for (int k = begin; k < end; k++) {
+        for (int l = 0; l < e->n_layers; l++) {
+            long w = (long)e->dims[l] * e->dims[l + 1], b = e->dims[l + 1];
+            kernels->axpy(e->weights[l]->data + k * w, -e->lr[k], e->weights[l]->grad + k * w, (int)w);
+            kernels->axpy(e->biases[l]->data + k * b, -e->lr[k], e->biases[l]->grad + k * b, (int)b);
+        }
+    }
+}
+
+void ensemble_sgd_step(Ensemble* e) {
+    parallel_for(e->n_models, 0, sgd_models, e);
+}
+
+static int check_model(Ensemble* e, int model, MLP* mlp) {
+    if (model < 0 || model >= e->n_models) {
+        fprintf(stderr, "ensemble: model %d out of range [0, %d)\n", model, e->n_models);
+        return 0;
+    }
+    if (!mlp) return 1;
+    int ok = mlp->n_layers == e->n_layers;
+    for (int l = 0; l < e->n_layers && ok; l++)
+        ok = mlp->layers[l]->in_features == e->dims[l] && mlp->layers[l]->out_features == e->dims[l + 1];
+    if (!ok) fprintf(stderr, "ensemble: MLP architecture does not match the ensemble\n");
+    return ok;
+}
+
+void ensemble_set_model(Ensemble* e, int model, MLP* mlp) {
+    if (!check_model(e, model, mlp)) return;
+    for (int l = 0; l < e->n_layers; l++) {
+        long w = (long)e->dims[l] * e->dims[l + 1], b = e->dims[l + 1];
+        memcpy(e->weights[l]->data + model * w, mlp->layers[l]->weight->data, sizeof(float) * w);
+        memcpy(e->biases[l]->data + model * b, mlp->layers[l]->bias->data, sizeof(float) * b);
+    }
+}
+
+MLP* ensemble_get_model(Ensemble* e, int model) {
+    if (!check_model(e, model, NULL)) return NULL;
+    MLP* mlp = mlp_create_zeros(e->n_layers, e->dims);
+    for (int l = 0; l < e->n_layers; l++) {
+        long w = (long)e->dims[l] * e->dims[l + 1], b = e->dims[l + 1];
+        memcpy(mlp->layers[l]->weight->data, e->weights[l]->data + model * w, sizeof(float) * w);
+        memcpy(mlp->layers[l]->bias->data, e->biases[l]->data + model * b, sizeof(float) * b);
+    }
+    return mlp;
+}
+
+void ensemble_free(Ensemble* e) {
+    if (!e) return;
+    for (int l = 0; l < e->n_layers; l++) {
+        tensor_release(e->weights[l]);
+        tensor_release(e->biases[l]);
+    }
+    free(e->weights);
+    free(e->biases);
+    free(e->dims);
+    free(e->lr);
+    free(e);
+}
@@ -0,0 +1,22 @@
+#ifndef CML_ENSEMBLE_H
+#define CML_ENSEMBLE_H
+#include "../tensor/tensor.h"
+#include "mlp.h"
+typedef struct Ensemble Ensemble;
+struct Ensemble {
+    int n_models;
+    int n_layers;
+    int* dims;
+    Tensor** weights;
+    Tensor** biases;
+    float* lr;
+};
+Ensemble* ensemble_create(int n_models, int n_layers, const int* dims, const float* lr);
+Tensor* ensemble_forward(Ensemble* e, Tensor* x);
+Tensor* ensemble_cross_entropy_loss(Tensor* logits, Tensor* targets, float* losses);
+void ensemble_zero_grad(Ensemble* e);
+void ensemble_sgd_step(Ensemble* e);
+void ensemble_set_model(Ensemble* e, int model, MLP* mlp);
+MLP* ensemble_get_model(Ensemble* e, int model);
+void ensemble_free(Ensemble* e);
+#endif
@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "../tensor/tensor.h"
+#include "../tensor/cpu.h"
+#include "export.h"
+
+#define EXPORT_PER_LINE 6
+
+static int valid_name(const char* name) {
+    if (!name || !(isalpha((unsigned char)name[0]) || name[0] == '_')) return 0;
+    for (const char* c = name; *c; c++)
+        if (!isalnum((unsigned char)*c) && *c != '_') return 0;
+    return 1;
+}
+
+static void write_floats(FILE* fp, const char* qualifiers, const char* name, const char* suffix,
+                         const float* data, int n) {
+    fprintf(fp, "_Alignas(64) %sfloat %s_%s[%d] = {", qualifiers, name, suffix, n);
+    for (int i = 0; i < n; i++) {
+        if (i % EXPORT_PER_LINE == 0) fprintf(fp, "\n   ");
+        fprintf(fp, " %af,", (double)data[i]);
+    }
+    fprintf(fp, "\n};\n\n");
+}
+
+static int all_finite(const float* data, int n) {
+    for (int i = 0; i < n; i++)
+        if (!isfinite(data[i])) return 0;
+    return 1;
+}
+
+static int max_width(MLP* mlp) {
+    int width = 0;
+    for (int l = 0; l + 1 < mlp->n_layers; l++)
+        if (mlp->layers[l]->out_features > width) width = mlp->layers[l]->out_features;
+    return width;
+}
+
+static void write_forward(FILE* fp, MLP* mlp, const char* name) {
+    int n_in = mlp->layers[0]->in_features;
+    int n_out = mlp->layers[mlp->n_layers - 1]->out_features;
+    int width = max_width(mlp);
+
+    fprintf(fp, "void %s_forward(const float* restrict x, float* restrict y) {\n", name);
+    if (mlp->n_layers > 1) {
+        fprintf(fp, "    _Alignas(64) float h0[%d];\n", width);
+        if (mlp->n_layers > 2) fprintf(fp, "    _Alignas(64) float h1[%d];\n", width);
+    }
+
+    for (int l = 0; l < mlp->n_layers; l++) {
+        Linear* layer = mlp->layers[l];
+        int in = layer->in_features, out = layer->out_features;
+        int last = l == mlp->n_layers - 1;
+        char src[8], dst[8];
+        if (l == 0) strcpy(src, "x");
+        else snprintf(src, sizeof(src), "h%d", (l - 1) % 2);
+        if (last) strcpy(dst, "y");
+        else snprintf(dst, sizeof(dst), "h%d", l % 2);
+
+        fprintf(fp, "\n    for (int j = 0; j < %d; j++) %s[j] = 0.0f;\n", out, dst);
+        fprintf(fp, "    for (int k = 0; k < %d; k++) {\n", in);
+        fprintf(fp, "        float xk = %s[k];\n", src);
+        fprintf(fp, "        for (int j = 0; j < %d; j++) %s[j] += xk * %s_w%d[k * %d + j];\n", out, dst, name, l, out);
+        fprintf(fp, "    }\n");
+        if (last) {
+            fprintf(fp, "    for (int j = 0; j < %d; j++) %s[j] = %s[j] + %s_b%d[j];\n", out, dst, dst, name, l);
+        } else {
+            fprintf(fp, "    for (int j = 0; j < %d; j++) {\n", out);
+            fprintf(fp, "        float v = %s[j] + %s_b%d[j];\n", dst, name, l);
+            fprintf(fp, "        %s[j] = v > 0.0f ? v : 0.0f;\n", dst);
+            fprintf(fp, "    }\n");
+        }
+    }
+    fprintf(fp, "}\n\n");
+
+    fprintf(fp, "void %s_forward_batch(int n, const float* restrict x, float* restrict y) {\n", name);
+    fprintf(fp, "    for (int i = 0; i < n; i++) %s_forward(x + (size_t)i * %d, y + (size_t)i * %d);\n", name, n_in, n_out);
+    fprintf(fp, "}\n");
+}
+
+static int write_selftest(FILE* fp, MLP* mlp, const char* name, Tensor* test_x) {
+    int n_in = mlp->layers[0]->in_features;
+    int n_out = mlp->layers[mlp->n_layers - 1]->out_features;
+    if (test_x->ndim != 2 || test_x->shape[1] != n_in) {
+        fprintf(stderr, "mlp_export_c: test inputs must be [*, %d]\n", n_in);
+        return -1;
+    }
+
+    CpuLevel level = cpu_level();
+    cpu_set_level(CPU_GENERIC);
+    Tensor* test_y = mlp_forward(mlp, test_x);
+    float* x = tensor_eval(test_x);
+    float* y = tensor_eval(test_y);
+    cpu_set_level(level);
+    int rows = test_x->shape[0];
+    if (!all_finite(x, test_x->size) || !all_finite(y, test_y->size)) {
+        fprintf(stderr, "mlp_export_c: test vectors contain non-finite values\n");
+        tensor_release(test_y);
+        return -1;
+    }
+
+    fprintf(fp, "\n#ifdef CML_EXPORT_SELFTEST\n#include <stdio.h>\n#include <string.h>\n\n");
+    write_floats(fp, "static const ", name, "test_x", x, test_x->size);
+    write_floats(fp, "static const ", name, "test_y", y, test_y->size);
+    fprintf(fp, "int main(void) {\n");
+    fprintf(fp, "    _Alignas(64) static float y[%d];\n", rows * n_out);
+    fprintf(fp, "    %s_forward_batch(%d, %s_test_x, y);\n", name, rows, name);
+    fprintf(fp, "    int exact = 0;\n");
+    fprintf(fp, "    for (int i = 0; i < %d; i++)\n", rows);
+    fprintf(fp, "        exact += !memcmp(y + i * %d, %s_test_y + i * %d, sizeof(float) * %d);\n", n_out, name, n_out, n_out);
+    fprintf(fp, "    printf(\"%s: %%d/%d rows bit-exact\\n\", exact);\n", name, rows);
+    fprintf(fp, "    return exact == %d ? 0 : 1;\n", rows);
+    fprintf(fp, "}\n#endif\n");
+
+    tensor_release(test_y);
+    return 0;
+}
+
+static int write_header(MLP* mlp, const char* name, const char* h_path) {
+    FILE* fp = fopen(h_path, "w");
+    if (!fp) {
+        fprintf(stderr, "mlp_export_c: cannot open %s\n", h_path);
+        return -1;
+    }
+
+    char upper[256];
+    int n = 0;
+    for (; name[n] && n < (int)sizeof(upper) - 1; n++) upper[n] = (char)toupper((unsigned char)name[n]);
+    upper[n] = '\0';
+
+    fprintf(fp, "#ifndef %s_H\n#define %s_H\n", upper, upper);
+    fprintf(fp, "#define %s_IN_FEATURES %d\n", upper, mlp->layers[0]->in_features);
+    fprintf(fp, "#define %s_OUT_FEATURES %d\n", upper, mlp->layers[mlp->n_layers - 1]->out_features);
+    fprintf(fp, "void %s_forward(const float* x, float* y);\n", name);
+    fprintf(fp, "void %s_forward_batch(int n, const float* x, float* y);\n", name);
+    fprintf(fp, "#endif\n");
+
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "mlp_export_c: write to %s failed\n", h_path);
+        return -1;
+    }
+    return 0;
+}
+
+int mlp_export_c(MLP* mlp, const char* name, const char* c_path, const char* h_path, Tensor* test_x) {
+    if (!valid_name(name) || strlen(name) > 200) {
+        fprintf(stderr, "mlp_export_c: '%s' is not a valid C identifier\n", name ? name : "");
+        return -1;
+    }
+    for (int l = 0; l < mlp->n_layers; l++) {
+        Linear* layer = mlp->layers[l];
+        if (!all_finite(layer->weight->data, layer->weight->size) || !all_finite(layer->bias->data, layer->bias->size)) {
+            fprintf(stderr, "mlp_export_c: layer %d has non-finite parameters\n", l);
+            return -1;
+        }
+    }
+
+    FILE* fp = fopen(c_path, "w");
+    if (!fp) {
+        fprintf(stderr, "mlp_export_c: cannot open %s\n", c_path);
+        return -1;
+    }
+
+    fprintf(fp, "#include <stddef.h>\n\n");
+    fprintf(fp, "#if defined(__clang__)\n#pragma clang fp contract(off)\n");
+    fprintf(fp, "#elif defined(__GNUC__)\n#pragma GCC optimize(\"fp-contract=off\")\n#endif\n\n");
+
+    for (int l = 0; l < mlp->n_layers; l++) {
+        Linear* layer = mlp->layers[l];
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "w%d", l);
+        write_floats(fp, "static const ", name, suffix, layer->weight->data, layer->weight->size);
+        snprintf(suffix, sizeof(suffix), "b%d", l);
+        write_floats(fp, "static const ", name, suffix, layer->bias->data, layer->bias->size);
+    }
+    write_forward(fp, mlp, name);
+
+    int ok = !test_x || write_selftest(fp, mlp, name, test_x) == 0;
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "mlp_export_c: write to %s failed\n", c_path);
+        ok = 0;
+    }
+    if (ok && h_path) ok = write_header(mlp, name, h_path) == 0;
+    return ok ? 0 : -1;
+}
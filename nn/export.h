@@ -0,0 +1,6 @@
+#ifndef CML_EXPORT_H
+#define CML_EXPORT_H
+#include "../tensor/tensor.h"
+#include "mlp.h"
+int mlp_export_c(MLP* mlp, const char* name, const char* c_path, const char* h_path, Tensor* test_x);
+#endif
@@ -0,0 +1,338 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../tensor/tensor.h"
+#include "../tensor/gemm.h"
+#include "../tensor/random.h"
+#include "../parallel/pool.h"
+#include "large_softmax.h"
+
+#define LSM_DEFAULT_CHUNK 4096
+#define LSM_PARALLEL_MIN (1 << 15)
+
+typedef struct {
+    int N;
+    int D;
+    int C;
+    int chunk;
+    int* targets;
+    float* lse;
+} ChunkedContext;
+
+typedef struct {
+    int N;
+    int D;
+    int C;
+    int S;
+    int* targets;
+    int* samples;
+    float* probs;
+} SampledContext;
+
+static float* aligned_floats(size_t n) {
+    size_t bytes = (sizeof(float) * n + 63) & ~(size_t)63;
+    return (float*)aligned_alloc(64, bytes ? bytes : 64);
+}
+
+static void check_inputs(const char* name, Linear* proj, Tensor* h, Tensor* targets) {
+    int n_targets = targets->ndim == 2 && targets->shape[1] == 1 ? targets->shape[0] : targets->ndim == 1 ? targets->shape[0] : -1;
+    if (h->ndim != 2 || h->shape[1] != proj->in_features || n_targets != h->shape[0]) {
+        fprintf(stderr, "%s: expected h [N, %d] and targets [N] or [N, 1]\n", name, proj->in_features);
+        exit(1);
+    }
+}
+
+static int* copy_targets(int* dst, Tensor* targets, int N, int C, const char* name) {
+    float* t = tensor_eval(targets);
+    for (int i = 0; i < N; i++) {
+        int idx = (int)t[i];
+        if (idx < 0 || idx >= C) {
+            fprintf(stderr, "%s: target %d out of range [0, %d)\n", name, idx, C);
+            exit(1);
+        }
+        dst[i] = idx;
+    }
+    return dst;
+}
+
+static void run_rows(int N, long work, pool_fn fn, void* arg) {
+    if (work < LSM_PARALLEL_MIN) fn(0, N, arg);
+    else parallel_for(N, 0, fn, arg);
+}
+
+typedef struct {
+    float* logits;
+    const float* bias;
+    const int* targets;
+    int c0;
+    int width;
+    float* row_max;
+    float* row_sum;
+    float* target_logit;
+    const float* lse;
+    float scale;
+} ChunkTask;
+
+static void lse_task(int begin, int end, void* arg) {
+    ChunkTask* t = (ChunkTask*)arg;
+    const float* bias = t->bias + t->c0;
+    for (int i = begin; i < end; i++) {
+        float* row = t->logits + (size_t)i * t->width;
+        float m = t->row_max[i];
+        for (int j = 0; j < t->width; j++) {
+            row[j] += bias[j];
+            if (row[j] > m) m = row[j];
+        }
+
+        float s = t->row_sum[i] * expf(t->row_max[i] - m);
+        for (int j = 0; j < t->width; j++) s += expf(row[j] - m);
+        t->row_max[i] = m;
+        t->row_sum[i] = s;
+
+        int target = t->targets[i] - t->c0;
+        if (target >= 0 && target < t->width) t->target_logit[i] = row[target];
+    }
+}
+
+static void grad_task(int begin, int end, void* arg) {
+    ChunkTask* t = (ChunkTask*)arg;
+    const float* bias = t->bias + t->c0;
+    for (int i = begin; i < end; i++) {
+        float* row = t->logits + (size_t)i * t->width;
+        float lse = t->lse[i];
+        for (int j = 0; j < t->width; j++) row[j] = t->scale * expf(row[j] + bias[j] - lse);
+
+        int target = t->targets[i] - t->c0;
+        if (target >= 0 && target < t->width) row[target] -= t->scale;
+    }
+}
+
+static void chunked_softmax_backward(Tensor* loss) {
+    ChunkedContext* ctx = (ChunkedContext*)loss->ctx;
+    Tensor* h = loss->parents[0];
+    Tensor* W = loss->parents[1];
+    Tensor* b = loss->parents[2];
+    int N = ctx->N, D = ctx->D, C = ctx->C;
+
+    float* g = aligned_floats((size_t)N * ctx->chunk);
+    ChunkTask task = { g, b->data, ctx->targets, 0, 0, NULL, NULL, NULL, ctx->lse, loss->grad[0] / (float)N };
+
+    for (int c0 = 0; c0 < C; c0 += ctx->chunk) {
+        int width = C - c0 < ctx->chunk ? C - c0 : ctx->chunk;
+        task.c0 = c0;
+        task.width = width;
+        gemm(0, 0, N, width, D, 1.0f, h->data, D, W->data + c0, C, 0.0f, g, width);
+        run_rows(N, (long)N * width, grad_task, &task);
+
+        if (h->requires_grad) gemm(0, 1, N, D, width, 1.0f, g, width, W->data + c0, C, 1.0f, h->grad, D);
+        if (W->requires_grad) gemm(1, 0, D, width, N, 1.0f, h->data, D, g, width, 1.0f, W->grad + c0, C);
+        if (b->requires_grad) {
+            for (int i = 0; i < N; i++) {
+                const float* row = g + (size_t)i * width;
+                for (int j = 0; j < width; j++) b->grad[c0 + j] += row[j];
+            }
+        }
+    }
+
+    free(g);
+}
+
+Tensor* chunked_softmax_loss(Linear* proj, Tensor* h, Tensor* targets, int chunk_size) {
+    check_inputs("chunked_softmax_loss", proj, h, targets);
+    int N = h->shape[0], D = proj->in_features, C = proj->out_features;
+    int chunk = chunk_size > 0 ? chunk_size : LSM_DEFAULT_CHUNK;
+    if (chunk > C) chunk = C;
+
+    ChunkedContext* ctx = (ChunkedContext*)malloc(sizeof(ChunkedContext) + sizeof(int) * N + sizeof(float) * N);
+    ctx->N = N;
+    ctx->D = D;
+    ctx->C = C;
+    ctx->chunk = chunk;
+    ctx->targets = copy_targets((int*)(ctx + 1), targets, N, C, "chunked_softmax_loss");
+    ctx->lse = (float*)(ctx->targets + N);
+
+    float* logits = aligned_floats((size_t)N * chunk);
+    float* row_max = (float*)malloc(sizeof(float) * 3 * (size_t)N);
+    float* row_sum = row_max + N;
+    float* target_logit = row_sum + N;
+    for (int i = 0; i < N; i++) {
+        row_max[i] = -INFINITY;
+        row_sum[i] = 0.0f;
+    }
+
+    float* hd = tensor_eval(h);
+    ChunkTask task = { logits, proj->bias->data, ctx->targets, 0, 0, row_max, row_sum, target_logit, NULL, 0.0f };
+    for (int c0 = 0; c0 < C; c0 += chunk) {
+        int width = C - c0 < chunk ? C - c0 : chunk;
+        task.c0 = c0;
+        task.width = width;
+        gemm(0, 0, N, width, D, 1.0f, hd, D, proj->weight->data + c0, C, 0.0f, logits, width);
+        run_rows(N, (long)N * width, lse_task, &task);
+    }
+
+    float total = 0.0f;
+    for (int i = 0; i < N; i++) {
+        ctx->lse[i] = row_max[i] + logf(row_sum[i]);
+        total += ctx->lse[i] - target_logit[i];
+    }
+    free(logits);
+    free(row_max);
+
+    int requires_grad = h->requires_grad || proj->weight->requires_grad || proj->bias->requires_grad;
+    Tensor* loss = tensor_zeros(0, NULL, requires_grad);
+    loss->data[0] = total / (float)N;
+    loss->ctx = ctx;
+
+    if (loss->requires_grad) {
+        tensor_add_parent(loss, h);
+        tensor_add_parent(loss, proj->weight);
+        tensor_add_parent(loss, proj->bias);
+        loss->backward = chunked_softmax_backward;
+    }
+    return loss;
+}
+
+static float log_expected_count(int k, int C, int S) {
+    double q = log((k + 2.0) / (k + 1.0)) / log(C + 1.0);
+    return (float)log(S * q);
+}
+
+static void gather_columns(const float* W, int D, int C, const int* cols, int S, float* out) {
+    for (int d = 0; d < D; d++) {
+        const float* row = W + (size_t)d * C;
+        float* dst = out + (size_t)d * S;
+        for (int s = 0; s < S; s++) dst[s] = row[cols[s]];
+    }
+}
+
+static void sampled_softmax_backward(Tensor* loss) {
+    SampledContext* ctx = (SampledContext*)loss->ctx;
+    Tensor* h = loss->parents[0];
+    Tensor* W = loss->parents[1];
+    Tensor* b = loss->parents[2];
+    int N = ctx->N, D = ctx->D, C = ctx->C, S = ctx->S, K = S + 1;
+    float scale = loss->grad[0] / (float)N;
+
+    float* g = ctx->probs;
+    for (int i = 0; i < N; i++) {
+        float* row = g + (size_t)i * K;
+        for (int k = 0; k < K; k++) row[k] *= scale;
+        row[0] -= scale;
+    }
+
+    if (h->requires_grad) {
+        float* Ws = aligned_floats((size_t)D * S);
+        gather_columns(W->data, D, C, ctx->samples, S, Ws);
+        gemm(0, 1, N, D, S, 1.0f, g + 1, K, Ws, S, 1.0f, h->grad, D);
+        free(Ws);
+        for (int i = 0; i < N; i++) {
+            float gt = g[(size_t)i * K];
+            const float* w = W->data + ctx->targets[i];
+            float* dh = h->grad + (size_t)i * D;
+            for (int d = 0; d < D; d++) dh[d] += gt * w[(size_t)d * C];
+        }
+    }
+
+    if (W->requires_grad) {
+        float* dWs = aligned_floats((size_t)D * S);
+        gemm(1, 0, D, S, N, 1.0f, h->data, D, g + 1, K, 0.0f, dWs, S);
+        for (int d = 0; d < D; d++) {
+            float* dw = W->grad + (size_t)d * C;
+            const float* src = dWs + (size_t)d * S;
+            for (int s = 0; s < S; s++) dw[ctx->samples[s]] += src[s];
+        }
+        free(dWs);
+        for (int i = 0; i < N; i++) {
+            float gt = g[(size_t)i * K];
+            const float* x = h->data + (size_t)i * D;
+            float* dw = W->grad + ctx->targets[i];
+            for (int d = 0; d < D; d++) dw[(size_t)d * C] += gt * x[d];
+        }
+    }
+
+    if (b->requires_grad) {
+        for (int i = 0; i < N; i++) {
+            const float* row = g + (size_t)i * K;
+            b->grad[ctx->targets[i]] += row[0];
+            for (int s = 0; s < S; s++) b->grad[ctx->samples[s]] += row[s + 1];
+        }
+    }
+}
+
+Tensor* sampled_softmax_loss(Linear* proj, Tensor* h, Tensor* targets, int n_samples) {
+    check_inputs("sampled_softmax_loss", proj, h, targets);
+    int N = h->shape[0], D = proj->in_features, C = proj->out_features, S = n_samples, K = S + 1;
+    if (S <= 0) {
+        fprintf(stderr, "sampled_softmax_loss: n_samples must be positive\n");
+        exit(1);
+    }
+
+    SampledContext* ctx = (SampledContext*)malloc(sizeof(SampledContext) + sizeof(int) * ((size_t)N + S) +
+                                                  sizeof(float) * (size_t)N * K);
+    ctx->N = N;
+    ctx->D = D;
+    ctx->C = C;
+    ctx->S = S;
+    ctx->targets = copy_targets((int*)(ctx + 1), targets, N, C, "sampled_softmax_loss");
+    ctx->samples = ctx->targets + N;
+    ctx->probs = (float*)(ctx->samples + S);
+
+    float* u = (float*)malloc(sizeof(float) * S);
+    rng_uniform(u, S, 0.0f, 1.0f, rng_get_seed(), rng_reserve(S));
+    double log_range = log(C + 1.0);
+    for (int s = 0; s < S; s++) {
+        int k = (int)exp(u[s] * log_range) - 1;
+        ctx->samples[s] = k < 0 ? 0 : k >= C ? C - 1 : k;
+    }
+    free(u);
+
+    float* hd = tensor_eval(h);
+    const float* W = proj->weight->data;
+    const float* bias = proj->bias->data;
+    float* Ws = aligned_floats((size_t)D * S);
+    gather_columns(W, D, C, ctx->samples, S, Ws);
+
+    float* logits = ctx->probs;
+    gemm(0, 0, N, S, D, 1.0f, hd, D, Ws, S, 0.0f, logits + 1, K);
+    free(Ws);
+
+    float* correction = (float*)malloc(sizeof(float) * S);
+    for (int s = 0; s < S; s++) correction[s] = bias[ctx->samples[s]] - log_expected_count(ctx->samples[s], C, S);
+
+    float total = 0.0f;
+    for (int i = 0; i < N; i++) {
+        float* row = logits + (size_t)i * K;
+        const float* x = hd + (size_t)i * D;
+        int t = ctx->targets[i];
+
+        float true_logit = bias[t] - log_expected_count(t, C, S);
+        for (int d = 0; d < D; d++) true_logit += x[d] * W[(size_t)d * C + t];
+        row[0] = true_logit;
+        for (int s = 0; s < S; s++) row[s + 1] = ctx->samples[s] == t ? -INFINITY : row[s + 1] + correction[s];
+
+        float m = row[0];
+        for (int k = 1; k < K; k++) if (row[k] > m) m = row[k];
+        float sum = 0.0f;
+        for (int k = 0; k < K; k++) {
+            row[k] = expf(row[k] - m);
+            sum += row[k];
+        }
+        for (int k = 0; k < K; k++) row[k] /= sum;
+        total += m + logf(sum) - true_logit;
+    }
+    free(correction);
+
+    int requires_grad = h->requires_grad || proj->weight->requires_grad || proj->bias->requires_grad;
+    Tensor* loss = tensor_zeros(0, NULL, requires_grad);
+    loss->data[0] = total / (float)N;
+    loss->ctx = ctx;
+
+    if (loss->requires_grad) {
+        tensor_add_parent(loss, h);
+        tensor_add_parent(loss, proj->weight);
+        tensor_add_parent(loss, proj->bias);
+        loss->backward = sampled_softmax_backward;
+    }
+    return loss;
+}
@@ -0,0 +1,7 @@
+#ifndef CML_LARGE_SOFTMAX_H
+#define CML_LARGE_SOFTMAX_H
+#include "../tensor/tensor.h"
+#include "linear.h"
+Tensor* chunked_softmax_loss(Linear* proj, Tensor* h, Tensor* targets, int chunk_size);
+Tensor* sampled_softmax_loss(Linear* proj, Tensor* h, Tensor* targets, int n_samples);
+#endif
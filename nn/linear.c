@@ -1,6 +1,9 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "../tensor/tensor.h"
+#include "../tensor/random.h"
 #include "linear.h"
 
 Linear* linear_create(int in_features, int out_features) {
@@ -22,6 +25,39 @@ Linear* linear_create(int in_features, int out_features) {
     return layer;
 }
 
+Linear* linear_create_zeros(int in_features, int out_features) {
+    Linear* layer = (Linear*)malloc(sizeof(Linear));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate Linear layer\n");
+        exit(1);
+    }
+
+    layer->in_features = in_features;
+    layer->out_features = out_features;
+
+    int w_shape[2] = {in_features, out_features};
+    int b_shape[1] = {out_features};
+
+    layer->weight = tensor_zeros(2, w_shape, 1);
+    layer->bias   = tensor_zeros(1, b_shape, 1);
+
+    return layer;
+}
+
+void linear_init_xavier(Linear* layer) {
+    Tensor* w = layer->weight;
+    float limit = sqrtf(6.0f / (float)(layer->in_features + layer->out_features));
+    rng_uniform(w->data, w->size, -limit, limit, rng_get_seed(), rng_reserve(w->size));
+    memset(layer->bias->data, 0, sizeof(float) * layer->bias->size);
+}
+
+void linear_init_kaiming(Linear* layer) {
+    Tensor* w = layer->weight;
+    float std = sqrtf(2.0f / (float)layer->in_features);
+    rng_normal(w->data, w->size, 0.0f, std, rng_get_seed(), rng_reserve(w->size));
+    memset(layer->bias->data, 0, sizeof(float) * layer->bias->size);
+}
+
 Tensor* linear_forward(Linear* layer, Tensor* x) {
     if (x->ndim != 2 || x->shape[1] != layer->in_features) {
         fprintf(stderr,
@@ -45,6 +81,22 @@ Tensor* linear_forward(Linear* layer, Tensor* x) {
     return y;
 }
 
+Tensor* linear_forward_sparse(Linear* layer, CSRTensor* x) {
+    if (x->cols != layer->in_features) {
+        fprintf(stderr,
+            "Linear sparse forward shape mismatch: got [%d, %d], expected [*, %d]\n",
+            x->rows, x->cols, layer->in_features
+        );
+        exit(1);
+    }
+
+    Tensor* out = tensor_spmm(x, layer->weight);
+    Tensor* y = tensor_add_broadcast(out, layer->bias);
+    tensor_release(out);
+
+    return y;
+}
+
 void linear_zero_grad(Linear* layer) {
     tensor_zero_grad(layer->weight);
     tensor_zero_grad(layer->bias);
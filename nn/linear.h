@@ -1,6 +1,7 @@
 #ifndef CML_LINEAR_H
 #define CML_LINEAR_H
 #include "../tensor/tensor.h"
+#include "../tensor/sparse.h"
 typedef struct Linear Linear;
 struct Linear {
     int in_features;
@@ -9,7 +10,11 @@ struct Linear {
     Tensor* bias;
 };
 Linear* linear_create(int input_dim, int output_dim);
+Linear* linear_create_zeros(int input_dim, int output_dim);
+void linear_init_xavier(Linear* layer);
+void linear_init_kaiming(Linear* layer);
 Tensor* linear_forward(Linear* layer, Tensor* input);
+Tensor* linear_forward_sparse(Linear* layer, CSRTensor* input);
 void linear_zero_grad(Linear* layer);
 void linear_free(Linear* layer);
 void linear_print(Linear* layer);
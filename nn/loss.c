@@ -1,7 +1,9 @@
 #include "loss.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "../tensor/tensor.h"
+#include "../tensor/lazy.h"
 
 static Tensor* flatten_targets(Tensor* t) {
 
@@ -19,43 +21,43 @@ static Tensor* flatten_targets(Tensor* t) {
     exit(1);
 }
 typedef struct {
-    Tensor* predictions;
-    Tensor* targets;
     int N;
+    float targets[];
 } MSEContext;
 void mse_backward(Tensor* self) {
-    MSEContext* ctx = (MSEContext*)self->backward;
-    Tensor* pred = ctx->predictions;
-    Tensor* targ = ctx->targets;
+    MSEContext* ctx = (MSEContext*)self->ctx;
+    Tensor* pred = self->parents[0];
+    const float* targ = ctx->targets;
     int N = ctx->N;
 
-    Tensor* diff = tensor_sub(pred, targ);
-    Tensor* grad = tensor_mul_scalar(diff, 2.0f / (float)N);
+    if (!pred->requires_grad) return;
 
-    if (pred->grad) {
-        for (int i = 0; i < pred->size; i++)
-            pred->grad[i] += grad->data[i];
-    }
-
-    tensor_release(diff);
-    tensor_release(grad);
-    free(ctx);
+    tensor_eval(pred);
+    float scale = 2.0f * self->grad[0] / (float)N;
+    for (int i = 0; i < pred->size; i++)
+        pred->grad[i] += scale * (pred->data[i] - targ[i]);
 }
 
 Tensor* mse_loss(Tensor* predictions, Tensor* targets) {
     int N = predictions->shape[0];
 
+    lazy_begin();
     Tensor* diff = tensor_sub(predictions, targets);
     Tensor* sq = tensor_mul(diff, diff);
     Tensor* sum = tensor_sum(sq);
-    Tensor* loss = tensor_div_scalar(sum, (float)N);
-
-    MSEContext* ctx = malloc(sizeof(MSEContext));
-    ctx->predictions = predictions;
-    ctx->targets = targets;
-    ctx->N = N;
-
-    loss->backward = (void*)ctx;
+    lazy_end();
+    Tensor* loss = tensor_zeros(0, NULL, predictions->requires_grad);
+    loss->data[0] = tensor_eval(sum)[0] / (float)N;
+
+    if (loss->requires_grad) {
+        MSEContext* ctx = malloc(sizeof(MSEContext) + sizeof(float) * predictions->size);
+        memcpy(ctx->targets, tensor_eval(targets), sizeof(float) * predictions->size);
+        ctx->N = N;
+
+        tensor_add_parent(loss, predictions);
+        loss->backward = mse_backward;
+        loss->ctx = ctx;
+    }
 
     tensor_release(diff);
     tensor_release(sq);
@@ -65,36 +67,32 @@ Tensor* mse_loss(Tensor* predictions, Tensor* targets) {
 }
 
 typedef struct {
-    Tensor* logits;
-    Tensor* targets;  
     int N;
     int C;
+    float targets[];
 } CEContext;
 
 void ce_backward(Tensor* self) {
-    CEContext* ctx = (CEContext*)self->backward;
-    Tensor* logits = ctx->logits;
-    Tensor* targets = ctx->targets;
+    CEContext* ctx = (CEContext*)self->ctx;
+    Tensor* logits = self->parents[0];
+    const float* targets = ctx->targets;
     int N = ctx->N;
     int C = ctx->C;
 
+    if (!logits->requires_grad) return;
+
     Tensor* probs = tensor_softmax(logits);
 
     for (int i = 0; i < N; i++) {
-        int idx = (int)targets->data[i];
+        int idx = (int)targets[i];
         probs->data[i * C + idx] -= 1.0f;
     }
 
-    Tensor* grad = tensor_div_scalar(probs, (float)N);
-
-    if (logits->grad) {
-        for (int i = 0; i < logits->size; i++)
-            logits->grad[i] += grad->data[i];
-    }
+    float scale = self->grad[0] / (float)N;
+    for (int i = 0; i < logits->size; i++)
+        logits->grad[i] += scale * probs->data[i];
 
     tensor_release(probs);
-    tensor_release(grad);
-    free(ctx);
 }
 Tensor* cross_entropy_loss(Tensor* logits, Tensor* targets) {
     int N = logits->shape[0];
@@ -115,19 +113,27 @@ Tensor* cross_entropy_loss(Tensor* logits, Tensor* targets) {
     
     Tensor* exp_logits = tensor_exp(shifted);
     Tensor* sum_exp = tensor_sum_axis(exp_logits, 1);
+    lazy_begin();
     Tensor* log_sum = tensor_log(sum_exp);
     Tensor* target_logits = tensor_gather(logits, flat_targets);
     Tensor* diff = tensor_sub(log_sum, target_logits); 
     Tensor* loss_sum = tensor_sum(diff);
-    Tensor* loss = tensor_div_scalar(loss_sum, (float)N);
-
-    CEContext* ctx = malloc(sizeof(CEContext)); 
-    ctx->logits = logits;
-    ctx->targets = flat_targets; 
-    ctx->N = N;
-    ctx->C = C;
-
-    loss->backward = (void*)ctx;
+    lazy_end();
+    float total = tensor_eval(loss_sum)[0];
+    for (int i = 0; i < N; i++) total += max_logits->data[i];
+    Tensor* loss = tensor_zeros(0, NULL, logits->requires_grad);
+    loss->data[0] = total / (float)N;
+
+    if (loss->requires_grad) {
+        CEContext* ctx = malloc(sizeof(CEContext) + sizeof(float) * N);
+        memcpy(ctx->targets, tensor_eval(flat_targets), sizeof(float) * N);
+        ctx->N = N;
+        ctx->C = C;
+
+        tensor_add_parent(loss, logits);
+        loss->backward = ce_backward;
+        loss->ctx = ctx;
+    }
 
     tensor_release(max_logits);
     tensor_release(shifted); 
@@ -137,5 +143,6 @@ Tensor* cross_entropy_loss(Tensor* logits, Tensor* targets) {
     tensor_release(target_logits);
     tensor_release(diff);
     tensor_release(loss_sum);
+    if (flat_targets != targets) tensor_release(flat_targets);
     return loss;
 }
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../tensor/tensor.h"
+#include "../tensor/lazy.h"
+#include "activations.h"
+#include "mlp.h"
+
+#define MLP_MAGIC 0x4d4c4d43u
+#define MLP_VERSION 1u
+
+static MLP* mlp_alloc(int n_layers) {
+    MLP* mlp = (MLP*)malloc(sizeof(MLP));
+    if (!mlp) {
+        fprintf(stderr, "failed to allocate MLP\n");
+        exit(1);
+    }
+    mlp->n_layers = n_layers;
+    mlp->layers = (Linear**)calloc(n_layers, sizeof(Linear*));
+    return mlp;
+}
+
+MLP* mlp_create(int n_layers, const int* dims) {
+    MLP* mlp = mlp_alloc(n_layers);
+    for (int l = 0; l < n_layers; l++)
+        mlp->layers[l] = linear_create(dims[l], dims[l + 1]);
+    return mlp;
+}
+
+MLP* mlp_create_zeros(int n_layers, const int* dims) {
+    MLP* mlp = mlp_alloc(n_layers);
+    for (int l = 0; l < n_layers; l++)
+        mlp->layers[l] = linear_create_zeros(dims[l], dims[l + 1]);
+    return mlp;
+}
+
+Tensor* mlp_forward(MLP* mlp, Tensor* x) {
+    Tensor* h = x;
+    tensor_retain(h);
+    for (int l = 0; l < mlp->n_layers; l++) {
+        lazy_begin();
+        Tensor* out = linear_forward(mlp->layers[l], h);
+        tensor_release(h);
+        if (l == mlp->n_layers - 1) {
+            lazy_end();
+            tensor_eval(out);
+            return out;
+        }
+        h = relu(out);
+        lazy_end();
+        tensor_eval(h);
+        tensor_release(out);
+    }
+    return h;
+}
+
+int mlp_num_params(MLP* mlp) {
+    return 2 * mlp->n_layers;
+}
+
+void mlp_params(MLP* mlp, Tensor** out) {
+    for (int l = 0; l < mlp->n_layers; l++) {
+        out[2 * l] = mlp->layers[l]->weight;
+        out[2 * l + 1] = mlp->layers[l]->bias;
+    }
+}
+
+int mlp_save(MLP* mlp, const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "mlp_save: cannot open %s\n", path);
+        return -1;
+    }
+
+    uint32_t header[3] = { MLP_MAGIC, MLP_VERSION, (uint32_t)mlp->n_layers };
+    int ok = fwrite(header, sizeof(header), 1, fp) == 1;
+    for (int l = 0; l < mlp->n_layers && ok; l++) {
+        uint32_t dims[2] = { (uint32_t)mlp->layers[l]->in_features, (uint32_t)mlp->layers[l]->out_features };
+        ok = fwrite(dims, sizeof(dims), 1, fp) == 1;
+    }
+    for (int l = 0; l < mlp->n_layers && ok; l++) {
+        Linear* layer = mlp->layers[l];
+        ok = fwrite(layer->weight->data, sizeof(float), layer->weight->size, fp) == (size_t)layer->weight->size &&
+             fwrite(layer->bias->data, sizeof(float), layer->bias->size, fp) == (size_t)layer->bias->size;
+    }
+
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "mlp_save: write to %s failed\n", path);
+    return ok ? 0 : -1;
+}
+
+MLP* mlp_load(const char* path, int requires_grad) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "mlp_load: cannot open %s\n", path);
+        return NULL;
+    }
+
+    uint32_t header[3];
+    if (fread(header, sizeof(header), 1, fp) != 1 || header[0] != MLP_MAGIC || header[1] != MLP_VERSION || header[2] == 0) {
+        fprintf(stderr, "mlp_load: %s is not a CML model file\n", path);
+        fclose(fp);
+        return NULL;
+    }
+
+    MLP* mlp = mlp_alloc((int)header[2]);
+    int ok = 1;
+    for (int l = 0; l < mlp->n_layers && ok; l++) {
+        uint32_t dims[2];
+        ok = fread(dims, sizeof(dims), 1, fp) == 1 && dims[0] > 0 && dims[1] > 0;
+        if (!ok) break;
+
+        Linear* layer = (Linear*)malloc(sizeof(Linear));
+        layer->in_features = (int)dims[0];
+        layer->out_features = (int)dims[1];
+        int w_shape[2] = { layer->in_features, layer->out_features };
+        int b_shape[1] = { layer->out_features };
+        layer->weight = tensor_create(2, w_shape, requires_grad);
+        layer->bias = tensor_create(1, b_shape, requires_grad);
+        mlp->layers[l] = layer;
+        if (l > 0 && mlp->layers[l - 1]->out_features != layer->in_features) ok = 0;
+    }
+    for (int l = 0; l < mlp->n_layers && ok; l++) {
+        Linear* layer = mlp->layers[l];
+        ok = fread(layer->weight->data, sizeof(float), layer->weight->size, fp) == (size_t)layer->weight->size &&
+             fread(layer->bias->data, sizeof(float), layer->bias->size, fp) == (size_t)layer->bias->size;
+    }
+    fclose(fp);
+
+    if (!ok) {
+        fprintf(stderr, "mlp_load: %s is truncated or inconsistent\n", path);
+        mlp_free(mlp);
+        return NULL;
+    }
+    return mlp;
+}
+
+void mlp_free(MLP* mlp) {
+    if (!mlp) return;
+    for (int l = 0; l < mlp->n_layers; l++) linear_free(mlp->layers[l]);
+    free(mlp->layers);
+    free(mlp);
+}
@@ -0,0 +1,18 @@
+#ifndef CML_MLP_H
+#define CML_MLP_H
+#include "../tensor/tensor.h"
+#include "linear.h"
+typedef struct MLP MLP;
+struct MLP {
+    int n_layers;
+    Linear** layers;
+};
+MLP* mlp_create(int n_layers, const int* dims);
+MLP* mlp_create_zeros(int n_layers, const int* dims);
+Tensor* mlp_forward(MLP* mlp, Tensor* x);
+int mlp_num_params(MLP* mlp);
+void mlp_params(MLP* mlp, Tensor** out);
+int mlp_save(MLP* mlp, const char* path);
+MLP* mlp_load(const char* path, int requires_grad);
+void mlp_free(MLP* mlp);
+#endif
@@ -0,0 +1,456 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../tensor/tensor.h"
+#include "../parallel/pool.h"
+#include "norm.h"
+
+#define NORM_LANES 8
+#define NORM_PARTS 32
+#define NORM_COL_BLOCK 64
+#define NORM_PARALLEL_MIN (1 << 15)
+
+typedef struct {
+    int rows;
+    int features;
+    int training;
+    float* mean;
+    float* rstd;
+} NormContext;
+
+static NormContext* context_create(int rows, int features, int n_stats, int training) {
+    NormContext* ctx = (NormContext*)malloc(sizeof(NormContext) + sizeof(float) * 2 * (size_t)n_stats);
+    ctx->rows = rows;
+    ctx->features = features;
+    ctx->training = training;
+    ctx->mean = (float*)(ctx + 1);
+    ctx->rstd = ctx->mean + n_stats;
+    return ctx;
+}
+
+static void run(int n, pool_fn fn, void* arg, long work) {
+    if (work < NORM_PARALLEL_MIN) fn(0, n, arg);
+    else parallel_for(n, 0, fn, arg);
+}
+
+static Tensor* affine_param(int features, float value) {
+    int shape[1] = { features };
+    Tensor* t = tensor_create(1, shape, 1);
+    for (int i = 0; i < features; i++) t->data[i] = value;
+    return t;
+}
+
+static void row_stats(const float* restrict x, int n, float eps, float* mean_out, float* rstd_out) {
+    float m[NORM_LANES] = { 0 }, m2[NORM_LANES] = { 0 };
+    int blocks = n / NORM_LANES;
+    for (int b = 0; b < blocks; b++) {
+        const float* xb = x + b * NORM_LANES;
+        float inv = 1.0f / (float)(b + 1);
+        for (int l = 0; l < NORM_LANES; l++) {
+            float d = xb[l] - m[l];
+            m[l] += d * inv;
+            m2[l] += d * (xb[l] - m[l]);
+        }
+    }
+
+    float mean = 0.0f, M2 = 0.0f, count = 0.0f;
+    for (int l = 0; l < NORM_LANES && blocks; l++) {
+        float total = count + (float)blocks;
+        float d = m[l] - mean;
+        mean += d * (float)blocks / total;
+        M2 += m2[l] + d * d * count * (float)blocks / total;
+        count = total;
+    }
+    for (int i = blocks * NORM_LANES; i < n; i++) {
+        count += 1.0f;
+        float d = x[i] - mean;
+        mean += d / count;
+        M2 += d * (x[i] - mean);
+    }
+
+    *mean_out = mean;
+    *rstd_out = 1.0f / sqrtf(M2 / (float)n + eps);
+}
+
+typedef struct {
+    const NormContext* ctx;
+    const float* x;
+    const float* gamma;
+    const float* beta;
+    const float* dy;
+    float* y;
+    float* dx;
+    float* partials;
+    float eps;
+    int n_parts;
+} NormTask;
+
+static void layernorm_row(const float* restrict x, const float* restrict gamma, const float* restrict beta,
+                          float* restrict y, int F, float mean, float rstd) {
+    int full = F - F % NORM_LANES;
+    for (int j0 = 0; j0 < full; j0 += NORM_LANES)
+        for (int l = 0; l < NORM_LANES; l++) y[j0 + l] = (x[j0 + l] - mean) * rstd * gamma[j0 + l] + beta[j0 + l];
+    for (int j = full; j < F; j++) y[j] = (x[j] - mean) * rstd * gamma[j] + beta[j];
+}
+
+static void layernorm_task(int begin, int end, void* arg) {
+    NormTask* t = (NormTask*)arg;
+    int F = t->ctx->features;
+    for (int r = begin; r < end; r++) {
+        const float* x = t->x + (size_t)r * F;
+        float mean, rstd;
+        row_stats(x, F, t->eps, &mean, &rstd);
+        t->ctx->mean[r] = mean;
+        t->ctx->rstd[r] = rstd;
+        layernorm_row(x, t->gamma, t->beta, t->y + (size_t)r * F, F, mean, rstd);
+    }
+}
+
+static void layernorm_row_grad(const float* restrict x, const float* restrict dy, const float* restrict gamma,
+                               float* restrict dx, int F, float mean, float rstd) {
+    float sum_g[NORM_LANES] = { 0 }, sum_gx[NORM_LANES] = { 0 };
+    int full = F - F % NORM_LANES;
+    for (int j0 = 0; j0 < full; j0 += NORM_LANES) {
+        for (int l = 0; l < NORM_LANES; l++) {
+            float g = dy[j0 + l] * gamma[j0 + l];
+            sum_g[l] += g;
+            sum_gx[l] += g * (x[j0 + l] - mean) * rstd;
+        }
+    }
+    for (int j = full; j < F; j++) {
+        float g = dy[j] * gamma[j];
+        sum_g[0] += g;
+        sum_gx[0] += g * (x[j] - mean) * rstd;
+    }
+
+    float c1 = 0.0f, c2 = 0.0f;
+    for (int l = 0; l < NORM_LANES; l++) {
+        c1 += sum_g[l];
+        c2 += sum_gx[l];
+    }
+    c1 /= (float)F;
+    c2 /= (float)F;
+
+    for (int j0 = 0; j0 < full; j0 += NORM_LANES)
+        for (int l = 0; l < NORM_LANES; l++) {
+            int j = j0 + l;
+            dx[j] += rstd * (dy[j] * gamma[j] - c1 - (x[j] - mean) * rstd * c2);
+        }
+    for (int j = full; j < F; j++) dx[j] += rstd * (dy[j] * gamma[j] - c1 - (x[j] - mean) * rstd * c2);
+}
+
+static void layernorm_param_grad(const float* restrict x, const float* restrict dy, float* restrict dgamma,
+                                 float* restrict dbeta, int F, float mean, float rstd) {
+    int full = F - F % NORM_LANES;
+    for (int j0 = 0; j0 < full; j0 += NORM_LANES)
+        for (int l = 0; l < NORM_LANES; l++) {
+            int j = j0 + l;
+            dgamma[j] += dy[j] * (x[j] - mean) * rstd;
+            dbeta[j] += dy[j];
+        }
+    for (int j = full; j < F; j++) {
+        dgamma[j] += dy[j] * (x[j] - mean) * rstd;
+        dbeta[j] += dy[j];
+    }
+}
+
+static void layernorm_backward_task(int begin, int end, void* arg) {
+    NormTask* t = (NormTask*)arg;
+    int rows = t->ctx->rows, F = t->ctx->features;
+
+    for (int p = begin; p < end; p++) {
+        int r0 = (int)((long)rows * p / t->n_parts);
+        int r1 = (int)((long)rows * (p + 1) / t->n_parts);
+        float* dgamma = t->partials ? t->partials + (size_t)p * 2 * F : NULL;
+        if (dgamma) memset(dgamma, 0, sizeof(float) * 2 * F);
+
+        for (int r = r0; r < r1; r++) {
+            const float* x = t->x + (size_t)r * F;
+            const float* dy = t->dy + (size_t)r * F;
+            float mean = t->ctx->mean[r], rstd = t->ctx->rstd[r];
+            if (t->dx) layernorm_row_grad(x, dy, t->gamma, t->dx + (size_t)r * F, F, mean, rstd);
+            if (dgamma) layernorm_param_grad(x, dy, dgamma, dgamma + F, F, mean, rstd);
+        }
+    }
+}
+
+static void reduce_partials(const float* partials, int n_parts, int F, Tensor* gamma, Tensor* beta) {
+    for (int p = 0; p < n_parts; p++) {
+        const float* dgamma = partials + (size_t)p * 2 * F;
+        const float* dbeta = dgamma + F;
+        if (gamma->requires_grad)
+            for (int j = 0; j < F; j++) gamma->grad[j] += dgamma[j];
+        if (beta->requires_grad)
+            for (int j = 0; j < F; j++) beta->grad[j] += dbeta[j];
+    }
+}
+
+static void layernorm_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    Tensor* gamma = out->parents[1];
+    Tensor* beta = out->parents[2];
+    NormContext* ctx = (NormContext*)out->ctx;
+    int params = gamma->requires_grad || beta->requires_grad;
+
+    NormTask t = { ctx, x->data, gamma->data, NULL, out->grad, NULL, NULL, NULL, 0.0f, 0 };
+    t.dx = x->requires_grad ? x->grad : NULL;
+    t.n_parts = ctx->rows < NORM_PARTS ? ctx->rows : NORM_PARTS;
+    if (params) t.partials = (float*)malloc(sizeof(float) * 2 * (size_t)t.n_parts * ctx->features);
+
+    run(t.n_parts, layernorm_backward_task, &t, (long)x->size);
+    if (params) {
+        reduce_partials(t.partials, t.n_parts, ctx->features, gamma, beta);
+        free(t.partials);
+    }
+}
+
+LayerNorm* layernorm_create(int features, float eps) {
+    LayerNorm* layer = (LayerNorm*)malloc(sizeof(LayerNorm));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate LayerNorm layer\n");
+        exit(1);
+    }
+
+    layer->features = features;
+    layer->eps = eps;
+    layer->gamma = affine_param(features, 1.0f);
+    layer->beta = affine_param(features, 0.0f);
+    return layer;
+}
+
+Tensor* layernorm_forward(LayerNorm* layer, Tensor* x) {
+    if (x->ndim < 1 || x->shape[x->ndim - 1] != layer->features) {
+        fprintf(stderr, "LayerNorm forward shape mismatch: last dim %d, expected %d\n",
+                x->ndim ? x->shape[x->ndim - 1] : 0, layer->features);
+        exit(1);
+    }
+
+    int rows = x->size / layer->features;
+    int requires_grad = x->requires_grad || layer->gamma->requires_grad || layer->beta->requires_grad;
+    NormContext* ctx = context_create(rows, layer->features, rows, 1);
+    Tensor* out = tensor_create(x->ndim, x->shape, requires_grad);
+
+    NormTask t = { ctx, tensor_eval(x), layer->gamma->data, layer->beta->data, NULL, out->data, NULL, NULL, layer->eps, 0 };
+    run(rows, layernorm_task, &t, (long)x->size);
+    out->ctx = ctx;
+
+    if (out->requires_grad) {
+        tensor_add_parent(out, x);
+        tensor_add_parent(out, layer->gamma);
+        tensor_add_parent(out, layer->beta);
+        out->backward = layernorm_backward;
+    }
+
+    return out;
+}
+
+void layernorm_free(LayerNorm* layer) {
+    if (!layer) return;
+    tensor_release(layer->gamma);
+    tensor_release(layer->beta);
+    free(layer);
+}
+
+typedef struct {
+    NormTask base;
+    BatchNorm1d* layer;
+} BatchNormTask;
+
+#define NORM_INLINE static inline __attribute__((always_inline))
+
+NORM_INLINE void column_welford(const float* x, int N, int F, float* restrict m, float* restrict m2, int w) {
+    for (int i = 0; i < N; i++) {
+        const float* restrict xi = x + (size_t)i * F;
+        float inv = 1.0f / (float)(i + 1);
+        for (int j = 0; j < w; j++) {
+            float d = xi[j] - m[j];
+            m[j] += d * inv;
+            m2[j] += d * (xi[j] - m[j]);
+        }
+    }
+}
+
+NORM_INLINE void row_affine(const float* restrict x, float* restrict y, const float* restrict scale,
+                            const float* restrict shift, int w) {
+    for (int j = 0; j < w; j++) y[j] = x[j] * scale[j] + shift[j];
+}
+
+NORM_INLINE void column_affine(const float* x, float* y, int N, int F, const float* scale, const float* shift, int w) {
+    for (int i = 0; i < N; i++) row_affine(x + (size_t)i * F, y + (size_t)i * F, scale, shift, w);
+}
+
+NORM_INLINE void column_grad_sums(const float* x, const float* dy, int N, int F, const float* restrict mean,
+                                  const float* restrict rstd, float* restrict sum_dy, float* restrict sum_dyx, int w) {
+    for (int i = 0; i < N; i++) {
+        const float* restrict xi = x + (size_t)i * F;
+        const float* restrict dyi = dy + (size_t)i * F;
+        for (int j = 0; j < w; j++) {
+            sum_dy[j] += dyi[j];
+            sum_dyx[j] += dyi[j] * (xi[j] - mean[j]) * rstd[j];
+        }
+    }
+}
+
+NORM_INLINE void row_grad_input(const float* restrict x, const float* restrict dy, float* restrict dx,
+                                const float* restrict mean, const float* restrict rstd, const float* restrict scale,
+                                const float* restrict c1, const float* restrict c2, int w) {
+    for (int j = 0; j < w; j++) dx[j] += scale[j] * (dy[j] - c1[j] - (x[j] - mean[j]) * rstd[j] * c2[j]);
+}
+
+NORM_INLINE void column_grad_input(const float* x, const float* dy, float* dx, int N, int F, const float* mean,
+                                   const float* rstd, const float* scale, const float* c1, const float* c2, int w) {
+    for (int i = 0; i < N; i++) {
+        size_t off = (size_t)i * F;
+        row_grad_input(x + off, dy + off, dx + off, mean, rstd, scale, c1, c2, w);
+    }
+}
+
+static void batchnorm_task(int begin, int end, void* arg) {
+    BatchNormTask* bt = (BatchNormTask*)arg;
+    NormTask* t = &bt->base;
+    const NormContext* ctx = t->ctx;
+    BatchNorm1d* layer = bt->layer;
+    int N = ctx->rows, F = ctx->features;
+
+    for (int block = begin; block < end; block++) {
+        int j0 = block * NORM_COL_BLOCK;
+        int w = F - j0 < NORM_COL_BLOCK ? F - j0 : NORM_COL_BLOCK;
+        float* mean = ctx->mean + j0;
+        float* rstd = ctx->rstd + j0;
+
+        if (ctx->training) {
+            float m[NORM_COL_BLOCK] = { 0 }, m2[NORM_COL_BLOCK] = { 0 };
+            if (w == NORM_COL_BLOCK) column_welford(t->x + j0, N, F, m, m2, NORM_COL_BLOCK);
+            else column_welford(t->x + j0, N, F, m, m2, w);
+
+            float unbias = N > 1 ? (float)N / (float)(N - 1) : 1.0f;
+            for (int j = 0; j < w; j++) {
+                float var = m2[j] / (float)N;
+                mean[j] = m[j];
+                rstd[j] = 1.0f / sqrtf(var + t->eps);
+                layer->running_mean[j0 + j] += layer->momentum * (m[j] - layer->running_mean[j0 + j]);
+                layer->running_var[j0 + j] += layer->momentum * (var * unbias - layer->running_var[j0 + j]);
+            }
+        } else {
+            for (int j = 0; j < w; j++) {
+                mean[j] = layer->running_mean[j0 + j];
+                rstd[j] = 1.0f / sqrtf(layer->running_var[j0 + j] + t->eps);
+            }
+        }
+
+        float scale[NORM_COL_BLOCK], shift[NORM_COL_BLOCK];
+        for (int j = 0; j < w; j++) {
+            scale[j] = rstd[j] * t->gamma[j0 + j];
+            shift[j] = t->beta[j0 + j] - mean[j] * scale[j];
+        }
+        if (w == NORM_COL_BLOCK) column_affine(t->x + j0, t->y + j0, N, F, scale, shift, NORM_COL_BLOCK);
+        else column_affine(t->x + j0, t->y + j0, N, F, scale, shift, w);
+    }
+}
+
+static void batchnorm_backward_task(int begin, int end, void* arg) {
+    NormTask* t = (NormTask*)arg;
+    const NormContext* ctx = t->ctx;
+    int N = ctx->rows, F = ctx->features;
+
+    for (int block = begin; block < end; block++) {
+        int j0 = block * NORM_COL_BLOCK;
+        int w = F - j0 < NORM_COL_BLOCK ? F - j0 : NORM_COL_BLOCK;
+        const float* mean = ctx->mean + j0;
+        const float* rstd = ctx->rstd + j0;
+
+        float sum_dy[NORM_COL_BLOCK] = { 0 }, sum_dyx[NORM_COL_BLOCK] = { 0 };
+        if (w == NORM_COL_BLOCK) column_grad_sums(t->x + j0, t->dy + j0, N, F, mean, rstd, sum_dy, sum_dyx, NORM_COL_BLOCK);
+        else column_grad_sums(t->x + j0, t->dy + j0, N, F, mean, rstd, sum_dy, sum_dyx, w);
+
+        if (t->partials) {
+            memcpy(t->partials + j0, sum_dyx, sizeof(float) * w);
+            memcpy(t->partials + F + j0, sum_dy, sizeof(float) * w);
+        }
+        if (!t->dx) continue;
+
+        float scale[NORM_COL_BLOCK], c1[NORM_COL_BLOCK], c2[NORM_COL_BLOCK];
+        for (int j = 0; j < w; j++) {
+            scale[j] = t->gamma[j0 + j] * rstd[j];
+            c1[j] = ctx->training ? sum_dy[j] / (float)N : 0.0f;
+            c2[j] = ctx->training ? sum_dyx[j] / (float)N : 0.0f;
+        }
+        if (w == NORM_COL_BLOCK)
+            column_grad_input(t->x + j0, t->dy + j0, t->dx + j0, N, F, mean, rstd, scale, c1, c2, NORM_COL_BLOCK);
+        else column_grad_input(t->x + j0, t->dy + j0, t->dx + j0, N, F, mean, rstd, scale, c1, c2, w);
+    }
+}
+
+static void batchnorm_backward(Tensor* out) {
+    Tensor* x = out->parents[0];
+    Tensor* gamma = out->parents[1];
+    Tensor* beta = out->parents[2];
+    NormContext* ctx = (NormContext*)out->ctx;
+    int F = ctx->features;
+    int params = gamma->requires_grad || beta->requires_grad;
+
+    NormTask t = { ctx, x->data, gamma->data, NULL, out->grad, NULL, NULL, NULL, 0.0f, 1 };
+    t.dx = x->requires_grad ? x->grad : NULL;
+    if (params) t.partials = (float*)malloc(sizeof(float) * 2 * (size_t)F);
+
+    run((F + NORM_COL_BLOCK - 1) / NORM_COL_BLOCK, batchnorm_backward_task, &t, (long)x->size);
+    if (params) {
+        reduce_partials(t.partials, 1, F, gamma, beta);
+        free(t.partials);
+    }
+}
+
+BatchNorm1d* batchnorm1d_create(int features, float eps, float momentum) {
+    BatchNorm1d* layer = (BatchNorm1d*)malloc(sizeof(BatchNorm1d));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate BatchNorm1d layer\n");
+        exit(1);
+    }
+
+    layer->features = features;
+    layer->eps = eps;
+    layer->momentum = momentum;
+    layer->training = 1;
+    layer->gamma = affine_param(features, 1.0f);
+    layer->beta = affine_param(features, 0.0f);
+    layer->running_mean = (float*)calloc(features, sizeof(float));
+    layer->running_var = (float*)malloc(sizeof(float) * features);
+    for (int i = 0; i < features; i++) layer->running_var[i] = 1.0f;
+    return layer;
+}
+
+Tensor* batchnorm1d_forward(BatchNorm1d* layer, Tensor* x) {
+    if (x->ndim != 2 || x->shape[1] != layer->features) {
+        fprintf(stderr, "BatchNorm1d forward shape mismatch: got [%d, %d], expected [*, %d]\n",
+                x->shape[0], x->ndim > 1 ? x->shape[1] : 0, layer->features);
+        exit(1);
+    }
+
+    int N = x->shape[0], F = layer->features;
+    int requires_grad = x->requires_grad || layer->gamma->requires_grad || layer->beta->requires_grad;
+    NormContext* ctx = context_create(N, F, F, layer->training);
+    Tensor* out = tensor_create(2, x->shape, requires_grad);
+
+    BatchNormTask t = { { ctx, tensor_eval(x), layer->gamma->data, layer->beta->data, NULL, out->data, NULL, NULL, layer->eps, 0 }, layer };
+    run((F + NORM_COL_BLOCK - 1) / NORM_COL_BLOCK, batchnorm_task, &t, (long)x->size);
+    out->ctx = ctx;
+
+    if (out->requires_grad) {
+        tensor_add_parent(out, x);
+        tensor_add_parent(out, layer->gamma);
+        tensor_add_parent(out, layer->beta);
+        out->backward = batchnorm_backward;
+    }
+
+    return out;
+}
+
+void batchnorm1d_free(BatchNorm1d* layer) {
+    if (!layer) return;
+    tensor_release(layer->gamma);
+    tensor_release(layer->beta);
+    free(layer->running_mean);
+    free(layer->running_var);
+    free(layer);
+}
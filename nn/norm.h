@@ -0,0 +1,29 @@
+#ifndef CML_NORM_H
+#define CML_NORM_H
+#include "../tensor/tensor.h"
+typedef struct LayerNorm LayerNorm;
+struct LayerNorm {
+    int features;
+    float eps;
+    Tensor* gamma;
+    Tensor* beta;
+};
+LayerNorm* layernorm_create(int features, float eps);
+Tensor* layernorm_forward(LayerNorm* layer, Tensor* x);
+void layernorm_free(LayerNorm* layer);
+
+typedef struct BatchNorm1d BatchNorm1d;
+struct BatchNorm1d {
+    int features;
+    float eps;
+    float momentum;
+    int training;
+    Tensor* gamma;
+    Tensor* beta;
+    float* running_mean;
+    float* running_var;
+};
+BatchNorm1d* batchnorm1d_create(int features, float eps, float momentum);
+Tensor* batchnorm1d_forward(BatchNorm1d* layer, Tensor* x);
+void batchnorm1d_free(BatchNorm1d* layer);
+#endif
@@ -0,0 +1,435 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../tensor/tensor.h"
+#include "../tensor/random.h"
+#include "../tensor/gemm.h"
+#include "../tensor/cpu.h"
+#include "../parallel/pool.h"
+#include "rnn.h"
+
+#define RNN_PARALLEL_MIN (1 << 14)
+
+typedef struct {
+    int T;
+    int N;
+    int in;
+    int H;
+    int has_h0;
+    int has_c0;
+    float data[];
+} RNNContext;
+
+typedef struct {
+    int H;
+    float* gates;
+    const float* c_prev;
+    float* c;
+    float* tc;
+    float* h;
+    const float* dh_out;
+    float* dh;
+    float* dc;
+    float* dgates;
+} LSTMTask;
+
+typedef struct {
+    int H;
+    float* gates;
+    const float* hp;
+    const float* h_prev;
+    float* hn;
+    float* h;
+    const float* dh_out;
+    float* dh;
+    float* dgates;
+    float* dhp;
+} GRUTask;
+
+static float sigmoidf(float x) {
+    return 1.0f / (1.0f + expf(-x));
+}
+
+static float tanh_expf(float x) {
+    return 2.0f / (1.0f + expf(-2.0f * x)) - 1.0f;
+}
+
+static Tensor* rnn_param(int ndim, const int* shape, float limit) {
+    Tensor* t = tensor_create(ndim, shape, 1);
+    rng_uniform(t->data, t->size, -limit, limit, rng_get_seed(), rng_reserve(t->size));
+    return t;
+}
+
+static void run_rows(int N, int H, pool_fn fn, void* task) {
+    if ((long)N * H < RNN_PARALLEL_MIN) fn(0, N, task);
+    else parallel_for(N, 0, fn, task);
+}
+
+static void fill_rows(float* out, const float* row, int rows, int cols) {
+    for (int r = 0; r < rows; r++) memcpy(out + (size_t)r * cols, row, sizeof(float) * cols);
+}
+
+static void column_sums(float* out, const float* m, int rows, int cols) {
+    const CpuKernels* kernels = cpu_kernels();
+    for (int r = 0; r < rows; r++) kernels->axpy(out, 1.0f, m + (size_t)r * cols, cols);
+}
+
+static void check_input(const char* name, Tensor* x, int input_size) {
+    if (x->ndim != 3 || x->shape[2] != input_size) {
+        fprintf(stderr, "%s forward shape mismatch: got %d-D input, expected [T, N, %d]\n", name, x->ndim, input_size);
+        exit(1);
+    }
+}
+
+static void check_state(const char* name, Tensor* s, int N, int H) {
+    if (s && s->size != N * H) {
+        fprintf(stderr, "%s forward: initial state has %d values, expected [%d, %d]\n", name, s->size, N, H);
+        exit(1);
+    }
+}
+
+LSTM* lstm_create(int input_size, int hidden_size) {
+    LSTM* layer = (LSTM*)malloc(sizeof(LSTM));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate LSTM layer\n");
+        exit(1);
+    }
+
+    layer->input_size = input_size;
+    layer->hidden_size = hidden_size;
+    float limit = 1.0f / sqrtf((float)hidden_size);
+    int w_ih_shape[2] = { input_size, 4 * hidden_size };
+    int w_hh_shape[2] = { hidden_size, 4 * hidden_size };
+    int b_shape[1] = { 4 * hidden_size };
+    layer->w_ih = rnn_param(2, w_ih_shape, limit);
+    layer->w_hh = rnn_param(2, w_hh_shape, limit);
+    layer->bias = rnn_param(1, b_shape, limit);
+    return layer;
+}
+
+static void lstm_cell_rows(int begin, int end, void* arg) {
+    LSTMTask* t = (LSTMTask*)arg;
+    int H = t->H;
+    for (int n = begin; n < end; n++) {
+        float* g = t->gates + (size_t)n * 4 * H;
+        const float* c_prev = t->c_prev + (size_t)n * H;
+        float* c = t->c + (size_t)n * H;
+        float* tc = t->tc + (size_t)n * H;
+        float* h = t->h + (size_t)n * H;
+        for (int j = 0; j < H; j++) {
+            float i = sigmoidf(g[j]);
+            float f = sigmoidf(g[H + j]);
+            float u = tanh_expf(g[2 * H + j]);
+            float o = sigmoidf(g[3 * H + j]);
+            c[j] = f * c_prev[j] + i * u;
+            tc[j] = tanh_expf(c[j]);
+            h[j] = o * tc[j];
+            g[j] = i;
+            g[H + j] = f;
+            g[2 * H + j] = u;
+            g[3 * H + j] = o;
+        }
+    }
+}
+
+static void lstm_cell_backward_rows(int begin, int end, void* arg) {
+    LSTMTask* t = (LSTMTask*)arg;
+    int H = t->H;
+    for (int n = begin; n < end; n++) {
+        const float* g = t->gates + (size_t)n * 4 * H;
+        float* dg = t->dgates + (size_t)n * 4 * H;
+        const float* c_prev = t->c_prev + (size_t)n * H;
+        const float* tc = t->tc + (size_t)n * H;
+        const float* dh_out = t->dh_out + (size_t)n * H;
+        const float* dh_next = t->dh + (size_t)n * H;
+        float* dc_next = t->dc + (size_t)n * H;
+        for (int j = 0; j < H; j++) {
+            float i = g[j], f = g[H + j], u = g[2 * H + j], o = g[3 * H + j];
+            float dh = dh_out[j] + dh_next[j];
+            float dc = dc_next[j] + dh * o * (1.0f - tc[j] * tc[j]);
+            dg[j] = dc * u * i * (1.0f - i);
+            dg[H + j] = dc * c_prev[j] * f * (1.0f - f);
+            dg[2 * H + j] = dc * i * (1.0f - u * u);
+            dg[3 * H + j] = dh * tc[j] * o * (1.0f - o);
+            dc_next[j] = dc * f;
+        }
+    }
+}
+
+static void lstm_backward(Tensor* out) {
+    RNNContext* ctx = (RNNContext*)out->ctx;
+    Tensor* x = out->parents[0];
+    Tensor* w_ih = out->parents[1];
+    Tensor* w_hh = out->parents[2];
+    Tensor* bias = out->parents[3];
+    Tensor* h0 = ctx->has_h0 ? out->parents[4] : NULL;
+    Tensor* c0 = ctx->has_c0 ? out->parents[4 + ctx->has_h0] : NULL;
+    int T = ctx->T, N = ctx->N, in = ctx->in, H = ctx->H, G = 4 * H;
+    long step = (long)N * H;
+    float* gates = ctx->data;
+    float* cells = gates + (size_t)T * N * G;
+    float* tanh_c = cells + (T + 1) * step;
+
+    float* dgates = (float*)malloc(sizeof(float) * (size_t)T * N * G);
+    float* dh = (float*)calloc(step, sizeof(float));
+    float* dc = (float*)calloc(step, sizeof(float));
+
+    for (int t = T - 1; t >= 0; t--) {
+        float* dg = dgates + (size_t)t * N * G;
+        LSTMTask task = { H, gates + (size_t)t * N * G, cells + t * step, NULL, tanh_c + t * step, NULL,
+                          out->grad + t * step, dh, dc, dg };
+        run_rows(N, H, lstm_cell_backward_rows, &task);
+        if (t > 0 || (h0 && h0->requires_grad))
+            gemm(0, 1, N, H, G, 1.0f, dg, G, w_hh->data, G, 0.0f, dh, H);
+    }
+
+    if (w_ih->requires_grad) gemm(1, 0, in, G, T * N, 1.0f, x->data, in, dgates, G, 1.0f, w_ih->grad, G);
+    if (bias->requires_grad) column_sums(bias->grad, dgates, T * N, G);
+    if (x->requires_grad) gemm(0, 1, T * N, in, G, 1.0f, dgates, G, w_ih->data, G, 1.0f, x->grad, in);
+    if (w_hh->requires_grad) {
+        if (T > 1) gemm(1, 0, H, G, (T - 1) * N, 1.0f, out->data, H, dgates + (size_t)N * G, G, 1.0f, w_hh->grad, G);
+        if (h0) gemm(1, 0, H, G, N, 1.0f, h0->data, H, dgates, G, 1.0f, w_hh->grad, G);
+    }
+    if (h0 && h0->requires_grad) cpu_kernels()->axpy(h0->grad, 1.0f, dh, (int)step);
+    if (c0 && c0->requires_grad) cpu_kernels()->axpy(c0->grad, 1.0f, dc, (int)step);
+
+    free(dgates);
+    free(dh);
+    free(dc);
+}
+
+Tensor* lstm_forward(LSTM* layer, Tensor* x, Tensor* h0, Tensor* c0) {
+    check_input("LSTM", x, layer->input_size);
+    int T = x->shape[0], N = x->shape[1], in = layer->input_size, H = layer->hidden_size, G = 4 * H;
+    check_state("LSTM", h0, N, H);
+    check_state("LSTM", c0, N, H);
+    long step = (long)N * H;
+
+    int requires_grad = x->requires_grad || layer->w_ih->requires_grad || layer->w_hh->requires_grad ||
+                        layer->bias->requires_grad || (h0 && h0->requires_grad) || (c0 && c0->requires_grad);
+    RNNContext* ctx = (RNNContext*)malloc(sizeof(RNNContext) + sizeof(float) * ((size_t)T * N * G + (size_t)(2 * T + 1) * step));
+    ctx->T = T;
+    ctx->N = N;
+    ctx->in = in;
+    ctx->H = H;
+    ctx->has_h0 = h0 != NULL;
+    ctx->has_c0 = c0 != NULL;
+    float* gates = ctx->data;
+    float* cells = gates + (size_t)T * N * G;
+    float* tanh_c = cells + (T + 1) * step;
+
+    int shape[3] = { T, N, H };
+    Tensor* out = tensor_create(3, shape, requires_grad);
+
+    fill_rows(gates, layer->bias->data, T * N, G);
+    gemm(0, 0, T * N, G, in, 1.0f, tensor_eval(x), in, layer->w_ih->data, G, 1.0f, gates, G);
+    if (c0) memcpy(cells, tensor_eval(c0), sizeof(float) * step);
+    else memset(cells, 0, sizeof(float) * step);
+
+    const float* h_prev = h0 ? tensor_eval(h0) : NULL;
+    for (int t = 0; t < T; t++) {
+        float* g = gates + (size_t)t * N * G;
+        if (h_prev) gemm(0, 0, N, G, H, 1.0f, h_prev, H, layer->w_hh->data, G, 1.0f, g, G);
+        LSTMTask task = { H, g, cells + t * step, cells + (t + 1) * step, tanh_c + t * step,
+                          out->data + t * step, NULL, NULL, NULL, NULL };
+        run_rows(N, H, lstm_cell_rows, &task);
+        h_prev = out->data + t * step;
+    }
+
+    if (!requires_grad) {
+        free(ctx);
+        return out;
+    }
+
+    out->ctx = ctx;
+    tensor_add_parent(out, x);
+    tensor_add_parent(out, layer->w_ih);
+    tensor_add_parent(out, layer->w_hh);
+    tensor_add_parent(out, layer->bias);
+    if (h0) tensor_add_parent(out, h0);
+    if (c0) tensor_add_parent(out, c0);
+    out->backward = lstm_backward;
+    return out;
+}
+
+void lstm_free(LSTM* layer) {
+    if (!layer) return;
+    tensor_release(layer->w_ih);
+    tensor_release(layer->w_hh);
+    tensor_release(layer->bias);
+    free(layer);
+}
+
+GRU* gru_create(int input_size, int hidden_size) {
+    GRU* layer = (GRU*)malloc(sizeof(GRU));
+    if (!layer) {
+        fprintf(stderr, "failed to allocate GRU layer\n");
+        exit(1);
+    }
+
+    layer->input_size = input_size;
+    layer->hidden_size = hidden_size;
+    float limit = 1.0f / sqrtf((float)hidden_size);
+    int w_ih_shape[2] = { input_size, 3 * hidden_size };
+    int w_hh_shape[2] = { hidden_size, 3 * hidden_size };
+    int b_shape[1] = { 3 * hidden_size };
+    layer->w_ih = rnn_param(2, w_ih_shape, limit);
+    layer->w_hh = rnn_param(2, w_hh_shape, limit);
+    layer->b_ih = rnn_param(1, b_shape, limit);
+    layer->b_hh = rnn_param(1, b_shape, limit);
+    return layer;
+}
+
+static void gru_cell_rows(int begin, int end, void* arg) {
+    GRUTask* t = (GRUTask*)arg;
+    int H = t->H;
+    for (int n = begin; n < end; n++) {
+        float* g = t->gates + (size_t)n * 3 * H;
+        const float* hp = t->hp + (size_t)n * 3 * H;
+        const float* h_prev = t->h_prev ? t->h_prev + (size_t)n * H : NULL;
+        float* hn = t->hn + (size_t)n * H;
+        float* h = t->h + (size_t)n * H;
+        for (int j = 0; j < H; j++) {
+            float r = sigmoidf(g[j] + hp[j]);
+            float z = sigmoidf(g[H + j] + hp[H + j]);
+            float u = tanh_expf(g[2 * H + j] + r * hp[2 * H + j]);
+            h[j] = (1.0f - z) * u + z * (h_prev ? h_prev[j] : 0.0f);
+            hn[j] = hp[2 * H + j];
+            g[j] = r;
+            g[H + j] = z;
+            g[2 * H + j] = u;
+        }
+    }
+}
+
+static void gru_cell_backward_rows(int begin, int end, void* arg) {
+    GRUTask* t = (GRUTask*)arg;
+    int H = t->H;
+    for (int n = begin; n < end; n++) {
+        const float* g = t->gates + (size_t)n * 3 * H;
+        float* dg = t->dgates + (size_t)n * 3 * H;
+        float* dhp = t->dhp + (size_t)n * 3 * H;
+        const float* h_prev = t->h_prev ? t->h_prev + (size_t)n * H : NULL;
+        const float* hn = t->hn + (size_t)n * H;
+        const float* dh_out = t->dh_out + (size_t)n * H;
+        float* dh_next = t->dh + (size_t)n * H;
+        for (int j = 0; j < H; j++) {
+            float r = g[j], z = g[H + j], u = g[2 * H + j];
+            float dh = dh_out[j] + dh_next[j];
+            float du = dh * (1.0f - z) * (1.0f - u * u);
+            float dz = dh * ((h_prev ? h_prev[j] : 0.0f) - u) * z * (1.0f - z);
+            float dr = du * hn[j] * r * (1.0f - r);
+            dg[j] = dr;
+            dg[H + j] = dz;
+            dg[2 * H + j] = du;
+            dhp[j] = dr;
+            dhp[H + j] = dz;
+            dhp[2 * H + j] = du * r;
+            dh_next[j] = dh * z;
+        }
+    }
+}
+
+static void gru_backward(Tensor* out) {
+    RNNContext* ctx = (RNNContext*)out->ctx;
+    Tensor* x = out->parents[0];
+    Tensor* w_ih = out->parents[1];
+    Tensor* w_hh = out->parents[2];
+    Tensor* b_ih = out->parents[3];
+    Tensor* b_hh = out->parents[4];
+    Tensor* h0 = ctx->has_h0 ? out->parents[5] : NULL;
+    int T = ctx->T, N = ctx->N, in = ctx->in, H = ctx->H, G = 3 * H;
+    long step = (long)N * H;
+    float* gates = ctx->data;
+    float* hn = gates + (size_t)T * N * G;
+
+    float* dgates = (float*)malloc(sizeof(float) * (size_t)T * N * G);
+    float* dhp = (float*)malloc(sizeof(float) * (size_t)T * N * G);
+    float* dh = (float*)calloc(step, sizeof(float));
+
+    for (int t = T - 1; t >= 0; t--) {
+        float* dhp_t = dhp + (size_t)t * N * G;
+        const float* h_prev = t > 0 ? out->data + (t - 1) * step : h0 ? h0->data : NULL;
+        GRUTask task = { H, gates + (size_t)t * N * G, NULL, h_prev, hn + t * step, NULL,
+                         out->grad + t * step, dh, dgates + (size_t)t * N * G, dhp_t };
+        run_rows(N, H, gru_cell_backward_rows, &task);
+        if (t > 0 || (h0 && h0->requires_grad))
+            gemm(0, 1, N, H, G, 1.0f, dhp_t, G, w_hh->data, G, 1.0f, dh, H);
+    }
+
+    if (w_ih->requires_grad) gemm(1, 0, in, G, T * N, 1.0f, x->data, in, dgates, G, 1.0f, w_ih->grad, G);
+    if (b_ih->requires_grad) column_sums(b_ih->grad, dgates, T * N, G);
+    if (x->requires_grad) gemm(0, 1, T * N, in, G, 1.0f, dgates, G, w_ih->data, G, 1.0f, x->grad, in);
+    if (w_hh->requires_grad) {
+        if (T > 1) gemm(1, 0, H, G, (T - 1) * N, 1.0f, out->data, H, dhp + (size_t)N * G, G, 1.0f, w_hh->grad, G);
+        if (h0) gemm(1, 0, H, G, N, 1.0f, h0->data, H, dhp, G, 1.0f, w_hh->grad, G);
+    }
+    if (b_hh->requires_grad) column_sums(b_hh->grad, dhp, T * N, G);
+    if (h0 && h0->requires_grad) cpu_kernels()->axpy(h0->grad, 1.0f, dh, (int)step);
+
+    free(dgates);
+    free(dhp);
+    free(dh);
+}
+
+Tensor* gru_forward(GRU* layer, Tensor* x, Tensor* h0) {
+    check_input("GRU", x, layer->input_size);
+    int T = x->shape[0], N = x->shape[1], in = layer->input_size, H = layer->hidden_size, G = 3 * H;
+    check_state("GRU", h0, N, H);
+    long step = (long)N * H;
+
+    int requires_grad = x->requires_grad || layer->w_ih->requires_grad || layer->w_hh->requires_grad ||
+                        layer->b_ih->requires_grad || layer->b_hh->requires_grad || (h0 && h0->requires_grad);
+    RNNContext* ctx = (RNNContext*)malloc(sizeof(RNNContext) + sizeof(float) * ((size_t)T * N * G + (size_t)T * step));
+    ctx->T = T;
+    ctx->N = N;
+    ctx->in = in;
+    ctx->H = H;
+    ctx->has_h0 = h0 != NULL;
+    ctx->has_c0 = 0;
+    float* gates = ctx->data;
+    float* hn = gates + (size_t)T * N * G;
+    float* hp = (float*)malloc(sizeof(float) * (size_t)N * G);
+
+    int shape[3] = { T, N, H };
+    Tensor* out = tensor_create(3, shape, requires_grad);
+
+    fill_rows(gates, layer->b_ih->data, T * N, G);
+    gemm(0, 0, T * N, G, in, 1.0f, tensor_eval(x), in, layer->w_ih->data, G, 1.0f, gates, G);
+
+    const float* h_prev = h0 ? tensor_eval(h0) : NULL;
+    for (int t = 0; t < T; t++) {
+        fill_rows(hp, layer->b_hh->data, N, G);
+        if (h_prev) gemm(0, 0, N, G, H, 1.0f, h_prev, H, layer->w_hh->data, G, 1.0f, hp, G);
+        GRUTask task = { H, gates + (size_t)t * N * G, hp, h_prev, hn + t * step,
+                         out->data + t * step, NULL, NULL, NULL, NULL };
+        run_rows(N, H, gru_cell_rows, &task);
+        h_prev = out->data + t * step;
+    }
+    free(hp);
+
+    if (!requires_grad) {
+        free(ctx);
+        return out;
+    }
+
+    out->ctx = ctx;
+    tensor_add_parent(out, x);
+    tensor_add_parent(out, layer->w_ih);
+    tensor_add_parent(out, layer->w_hh);
+    tensor_add_parent(out, layer->b_ih);
+    tensor_add_parent(out, layer->b_hh);
+    if (h0) tensor_add_parent(out, h0);
+    out->backward = gru_backward;
+    return out;
+}
+
+void gru_free(GRU* layer) {
+    if (!layer) return;
+    tensor_release(layer->w_ih);
+    tensor_release(layer->w_hh);
+    tensor_release(layer->b_ih);
+    tensor_release(layer->b_hh);
+    free(layer);
+}
@@ -0,0 +1,28 @@
+#ifndef CML_RNN_H
+#define CML_RNN_H
+#include "../tensor/tensor.h"
+typedef struct LSTM LSTM;
+struct LSTM {
+    int input_size;
+    int hidden_size;
+    Tensor* w_ih;
+    Tensor* w_hh;
+    Tensor* bias;
+};
+LSTM* lstm_create(int input_size, int hidden_size);
+Tensor* lstm_forward(LSTM* layer, Tensor* x, Tensor* h0, Tensor* c0);
+void lstm_free(LSTM* layer);
+
+typedef struct GRU GRU;
+struct GRU {
+    int input_size;
+    int hidden_size;
+    Tensor* w_ih;
+    Tensor* w_hh;
+    Tensor* b_ih;
+    Tensor* b_hh;
+};
+GRU* gru_create(int input_size, int hidden_size);
+Tensor* gru_forward(GRU* layer, Tensor* x, Tensor* h0);
+void gru_free(GRU* layer);
+#endif
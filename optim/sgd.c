@@ -1,11 +1,10 @@
 #include "sgd.h"
 #include <stdlib.h>
 #include "../tensor/tensor.h"
+#include "../tensor/cpu.h"
 void sgd_step(Tensor* param, float lr) {
     if (!param || !param->grad) return;
-    for (int i = 0; i < param->size; i++) {
-        param->data[i] -= lr * param->grad[i];
-    }
+    cpu_kernels()->axpy(param->data, -lr, param->grad, param->size);
 }
 void sgd_step_params(Tensor** params, int n_params, float lr) {
     for (int i = 0; i < n_params; i++) {
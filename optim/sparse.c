@@ -0,0 +1,67 @@
+#include "sparse.h"
+#include <stdlib.h>
+#include <math.h>
+#include "../parallel/pool.h"
+
+typedef struct {
+    Embedding* emb;
+    float lr;
+    float eps;
+    float* state;
+} SparseUpdate;
+
+static void sgd_rows(int begin, int end, void* arg) {
+    SparseUpdate* u = (SparseUpdate*)arg;
+    SparseGrad* g = &u->emb->grad;
+    int dim = u->emb->embedding_dim;
+
+    for (int r = begin; r < end; r++) {
+        float* w = u->emb->weight->data + (size_t)g->indices[r] * dim;
+        const float* v = g->values + (size_t)r * dim;
+        for (int d = 0; d < dim; d++) w[d] -= u->lr * v[d];
+    }
+}
+
+static void adagrad_rows(int begin, int end, void* arg) {
+    SparseUpdate* u = (SparseUpdate*)arg;
+    SparseGrad* g = &u->emb->grad;
+    int dim = u->emb->embedding_dim;
+
+    for (int r = begin; r < end; r++) {
+        size_t row = (size_t)g->indices[r] * dim;
+        float* w = u->emb->weight->data + row;
+        float* s = u->state + row;
+        const float* v = g->values + (size_t)r * dim;
+        for (int d = 0; d < dim; d++) {
+            s[d] += v[d] * v[d];
+            w[d] -= u->lr * v[d] / (sqrtf(s[d]) + u->eps);
+        }
+    }
+}
+
+void sparse_sgd_step(Embedding* emb, float lr) {
+    embedding_coalesce(emb);
+    SparseUpdate u = { emb, lr, 0.0f, NULL };
+    parallel_for(emb->grad.nnz, 256, sgd_rows, &u);
+}
+
+SparseAdagrad* sparse_adagrad_create(Embedding* emb, float lr, float eps) {
+    SparseAdagrad* opt = (SparseAdagrad*)malloc(sizeof(SparseAdagrad));
+    opt->emb = emb;
+    opt->lr = lr;
+    opt->eps = eps;
+    opt->state = (float*)calloc((size_t)emb->num_embeddings * emb->embedding_dim, sizeof(float));
+    return opt;
+}
+
+void sparse_adagrad_step(SparseAdagrad* opt) {
+    embedding_coalesce(opt->emb);
+    SparseUpdate u = { opt->emb, opt->lr, opt->eps, opt->state };
+    parallel_for(opt->emb->grad.nnz, 256, adagrad_rows, &u);
+}
+
+void sparse_adagrad_free(SparseAdagrad* opt) {
+    if (!opt) return;
+    free(opt->state);
+    free(opt);
+}
@@ -0,0 +1,15 @@
+#ifndef SPARSE_OPTIM_H
+#define SPARSE_OPTIM_H
+#include "../nn/embedding.h"
+typedef struct SparseAdagrad SparseAdagrad;
+struct SparseAdagrad {
+    Embedding* emb;
+    float lr;
+    float eps;
+    float* state;
+};
+void sparse_sgd_step(Embedding* emb, float lr);
+SparseAdagrad* sparse_adagrad_create(Embedding* emb, float lr, float eps);
+void sparse_adagrad_step(SparseAdagrad* opt);
+void sparse_adagrad_free(SparseAdagrad* opt);
+#endif
@@ -0,0 +1,150 @@
+#include "data_parallel.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include "pool.h"
+#include "../optim/sgd.h"
+
+static Linear* linear_replica(Linear* layer) {
+    Linear* r = (Linear*)malloc(sizeof(Linear));
+    r->in_features = layer->in_features;
+    r->out_features = layer->out_features;
+    r->weight = tensor_from_data(layer->weight->ndim, layer->weight->shape, layer->weight->data, 1);
+    r->bias = tensor_from_data(layer->bias->ndim, layer->bias->shape, layer->bias->data, 1);
+    return r;
+}
+
+static Tensor* replica_param(DataParallel* dp, int r, int p) {
+    Linear* layer = dp->replicas[r][p / 2];
+    return p % 2 == 0 ? layer->weight : layer->bias;
+}
+
+DataParallel* dp_create(Linear** layers, int n_layers, int n_replicas, dp_loss_fn loss_fn) {
+    if (n_layers <= 0 || n_replicas <= 0 || !loss_fn) {
+        fprintf(stderr, "dp_create invalid arguments\n");
+        return NULL;
+    }
+
+    DataParallel* dp = (DataParallel*)malloc(sizeof(DataParallel));
+    dp->layers = layers;
+    dp->n_layers = n_layers;
+    dp->n_replicas = n_replicas;
+    dp->loss_fn = loss_fn;
+
+    dp->replicas = (Linear***)malloc(sizeof(Linear**) * n_replicas);
+    dp->replicas[0] = layers;
+    for (int r = 1; r < n_replicas; r++) {
+        dp->replicas[r] = (Linear**)malloc(sizeof(Linear*) * n_layers);
+        for (int l = 0; l < n_layers; l++)
+            dp->replicas[r][l] = linear_replica(layers[l]);
+    }
+
+    dp->n_params = 2 * n_layers;
+    dp->params = (Tensor**)malloc(sizeof(Tensor*) * dp->n_params);
+    dp->param_offsets = (int*)malloc(sizeof(int) * (dp->n_params + 1));
+    dp->total_params = 0;
+    for (int p = 0; p < dp->n_params; p++) {
+        dp->params[p] = replica_param(dp, 0, p);
+        dp->param_offsets[p] = dp->total_params;
+        dp->total_params += dp->params[p]->size;
+    }
+    dp->param_offsets[dp->n_params] = dp->total_params;
+
+    dp->losses = (float*)calloc(n_replicas, sizeof(float));
+    dp->weights = (float*)calloc(n_replicas, sizeof(float));
+    return dp;
+}
+
+static Tensor* shard_rows(Tensor* t, int begin, int end) {
+    int row = t->ndim == 2 ? t->shape[1] : 1;
+    int shape[2] = { end - begin, row };
+    return tensor_from_data(t->ndim, shape, t->data + (size_t)begin * row, 0);
+}
+
+typedef struct {
+    DataParallel* dp;
+    Tensor* x;
+    Tensor* y;
+} StepContext;
+
+static void replica_task(int begin, int end, void* arg) {
+    StepContext* ctx = (StepContext*)arg;
+    DataParallel* dp = ctx->dp;
+    int N = ctx->x->shape[0];
+
+    for (int r = begin; r < end; r++) {
+        for (int p = 0; p < dp->n_params; p++)
+            tensor_zero_grad(replica_param(dp, r, p));
+
+        int row_begin = (int)((long)N * r / dp->n_replicas);
+        int row_end = (int)((long)N * (r + 1) / dp->n_replicas);
+        dp->losses[r] = 0.0f;
+        dp->weights[r] = (float)(row_end - row_begin) / (float)N;
+        if (row_end == row_begin) continue;
+
+        Tensor* xs = shard_rows(ctx->x, row_begin, row_end);
+        Tensor* ys = shard_rows(ctx->y, row_begin, row_end);
+
+        Tensor* loss = dp->loss_fn(dp->replicas[r], dp->n_layers, xs, ys);
+        tensor_backward(loss);
+        dp->losses[r] = loss->data[0];
+
+        tensor_release(loss);
+        tensor_release(xs);
+        tensor_release(ys);
+    }
+}
+
+static void reduce_task(int begin, int end, void* arg) {
+    DataParallel* dp = (DataParallel*)arg;
+
+    for (int p = 0; p < dp->n_params; p++) {
+        int lo = dp->param_offsets[p] > begin ? dp->param_offsets[p] : begin;
+        int hi = dp->param_offsets[p + 1] < end ? dp->param_offsets[p + 1] : end;
+        if (lo >= hi) continue;
+
+        lo -= dp->param_offsets[p];
+        hi -= dp->param_offsets[p];
+        float* g = dp->params[p]->grad;
+        float w0 = dp->weights[0];
+        for (int i = lo; i < hi; i++) g[i] *= w0;
+
+        for (int r = 1; r < dp->n_replicas; r++) {
+            const float* gr = replica_param(dp, r, p)->grad;
+            float wr = dp->weights[r];
+            for (int i = lo; i < hi; i++) g[i] += wr * gr[i];
+        }
+    }
+}
+
+float dp_step(DataParallel* dp, Tensor* x, Tensor* y, float lr) {
+    if (x->shape[0] != y->shape[0]) {
+        fprintf(stderr, "dp_step batch size mismatch\n");
+        return 0.0f;
+    }
+
+    StepContext ctx = { dp, x, y };
+    parallel_for(dp->n_replicas, 1, replica_task, &ctx);
+    parallel_for(dp->total_params, 4096, reduce_task, dp);
+
+    sgd_step_params(dp->params, dp->n_params, lr);
+
+    float loss = 0.0f;
+    for (int r = 0; r < dp->n_replicas; r++)
+        loss += dp->weights[r] * dp->losses[r];
+    return loss;
+}
+
+void dp_free(DataParallel* dp) {
+    if (!dp) return;
+    for (int r = 1; r < dp->n_replicas; r++) {
+        for (int l = 0; l < dp->n_layers; l++)
+            linear_free(dp->replicas[r][l]);
+        free(dp->replicas[r]);
+    }
+    free(dp->replicas);
+    free(dp->params);
+    free(dp->param_offsets);
+    free(dp->losses);
+    free(dp->weights);
+    free(dp);
+}
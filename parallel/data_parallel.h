@@ -0,0 +1,23 @@
+#ifndef CML_DATA_PARALLEL_H
+#define CML_DATA_PARALLEL_H
+#include "../tensor/tensor.h"
+#include "../nn/linear.h"
+typedef Tensor* (*dp_loss_fn)(Linear** layers, int n_layers, Tensor* x, Tensor* y);
+typedef struct DataParallel DataParallel;
+struct DataParallel {
+    Linear** layers;
+    int n_layers;
+    int n_replicas;
+    Linear*** replicas;
+    Tensor** params;
+    int n_params;
+    int* param_offsets;
+    int total_params;
+    dp_loss_fn loss_fn;
+    float* losses;
+    float* weights;
+};
+DataParallel* dp_create(Linear** layers, int n_layers, int n_replicas, dp_loss_fn loss_fn);
+float dp_step(DataParallel* dp, Tensor* x, Tensor* y, float lr);
+void dp_free(DataParallel* dp);
+#endif
@@ -0,0 +1,609 @@
+#include "dist.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+
+#define DIST_DEFAULT_PORT 29500
+#define DIST_CONNECT_RETRIES 600
+#define SHM_SLOT_FLOATS (1 << 20)
+#define SHM_READY 0x434d4c31
+
+typedef struct {
+    unsigned arrived;
+    unsigned sense;
+    unsigned attached;
+    unsigned ready;
+    unsigned generation;
+    char pad[44];
+} ShmHeader;
+
+typedef struct {
+    Tensor* param;
+    int bucket;
+    int offset;
+    int ready;
+} ParamSlot;
+
+typedef struct {
+    float* buffer;
+    int count;
+    int n_params;
+    int pending;
+    int submitted;
+} Bucket;
+
+typedef struct {
+    int rank;
+    int world_size;
+    int initialized;
+    int use_shm;
+
+    int send_fd;
+    int recv_fd;
+
+    ShmHeader* shm;
+    float* shm_slots;
+    size_t shm_bytes;
+    char shm_name[64];
+    unsigned local_sense;
+
+    ParamSlot* params;
+    int n_params;
+    Bucket* buckets;
+    int n_buckets;
+    int completed;
+    float scale;
+
+    pthread_t comm_thread;
+    int comm_running;
+    int comm_stop;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} DistState;
+
+static DistState dist = {
+    .world_size = 1,
+    .send_fd = -1,
+    .recv_fd = -1,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static int env_int(const char* name, int fallback) {
+    const char* v = getenv(name);
+    return v && *v ? atoi(v) : fallback;
+}
+
+static void host_for_rank(int rank, char* out, size_t len) {
+    const char* hosts = getenv("CML_HOSTS");
+    snprintf(out, len, "127.0.0.1");
+    if (!hosts || !*hosts) return;
+
+    const char* p = hosts;
+    for (int r = 0; r < rank; r++) {
+        const char* comma = strchr(p, ',');
+        if (!comma) break;
+        p = comma + 1;
+    }
+    size_t n = strcspn(p, ",");
+    if (n >= len) n = len - 1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+}
+
+static int all_hosts_local(void) {
+    const char* hosts = getenv("CML_HOSTS");
+    if (!hosts || !*hosts) return 1;
+    char first[256], other[256];
+    host_for_rank(0, first, sizeof(first));
+    for (int r = 1; r < dist.world_size; r++) {
+        host_for_rank(r, other, sizeof(other));
+        if (strcmp(first, other) != 0) return 0;
+    }
+    return 1;
+}
+
+static int tcp_listen(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int tcp_connect(const char* host, int port) {
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, service, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (int attempt = 0; attempt < DIST_CONNECT_RETRIES; attempt++) {
+        fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) == 0) break;
+        if (fd >= 0) close(fd);
+        fd = -1;
+        usleep(100000);
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static void tcp_tune(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static int tcp_setup(void) {
+    int port = env_int("CML_PORT", DIST_DEFAULT_PORT);
+    int next = (dist.rank + 1) % dist.world_size;
+    char host[256];
+
+    int listen_fd = tcp_listen(port + dist.rank);
+    if (listen_fd < 0) {
+        fprintf(stderr, "dist: rank %d cannot listen on port %d\n", dist.rank, port + dist.rank);
+        return -1;
+    }
+
+    host_for_rank(next, host, sizeof(host));
+    dist.send_fd = tcp_connect(host, port + next);
+    if (dist.send_fd < 0) {
+        fprintf(stderr, "dist: rank %d cannot connect to %s:%d\n", dist.rank, host, port + next);
+        close(listen_fd);
+        return -1;
+    }
+
+    dist.recv_fd = accept(listen_fd, NULL, NULL);
+    close(listen_fd);
+    if (dist.recv_fd < 0) {
+        fprintf(stderr, "dist: rank %d accept failed\n", dist.rank);
+        return -1;
+    }
+
+    tcp_tune(dist.send_fd);
+    tcp_tune(dist.recv_fd);
+    return 0;
+}
+
+static int exchange(const void* send_buf, size_t send_bytes, void* recv_buf, size_t recv_bytes) {
+    const char* s = (const char*)send_buf;
+    char* r = (char*)recv_buf;
+    size_t sent = 0, received = 0;
+
+    while (sent < send_bytes || received < recv_bytes) {
+        struct pollfd fds[2];
+        int n = 0;
+        if (sent < send_bytes) { fds[n].fd = dist.send_fd; fds[n].events = POLLOUT; n++; }
+        if (received < recv_bytes) { fds[n].fd = dist.recv_fd; fds[n].events = POLLIN; n++; }
+        if (poll(fds, n, -1) < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (!fds[i].revents) continue;
+            if (fds[i].fd == dist.send_fd && sent < send_bytes) {
+                ssize_t k = send(dist.send_fd, s + sent, send_bytes - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+                if (k > 0) sent += (size_t)k;
+                else if (k < 0 && errno != EAGAIN && errno != EINTR) return -1;
+            } else if (fds[i].fd == dist.recv_fd && received < recv_bytes) {
+                ssize_t k = recv(dist.recv_fd, r + received, recv_bytes - received, MSG_DONTWAIT);
+                if (k > 0) received += (size_t)k;
+                else if (k == 0) return -1;
+                else if (errno != EAGAIN && errno != EINTR) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int chunk_begin(int count, int c) {
+    return (int)((long)count * c / dist.world_size);
+}
+
+static void ring_all_reduce(float* data, int count) {
+    int W = dist.world_size;
+    int max_chunk = count / W + 1;
+    float* tmp = (float*)malloc(sizeof(float) * max_chunk);
+
+    for (int step = 0; step < W - 1; step++) {
+        int send_c = ((dist.rank - step) % W + W) % W;
+        int recv_c = ((dist.rank - step - 1) % W + W) % W;
+        int s0 = chunk_begin(count, send_c), s1 = chunk_begin(count, send_c + 1);
+        int r0 = chunk_begin(count, recv_c), r1 = chunk_begin(count, recv_c + 1);
+
+        if (exchange(data + s0, sizeof(float) * (s1 - s0), tmp, sizeof(float) * (r1 - r0)) < 0) {
+            fprintf(stderr, "dist: rank %d ring exchange failed\n", dist.rank);
+            exit(1);
+        }
+        for (int i = 0; i < r1 - r0; i++) data[r0 + i] += tmp[i];
+    }
+
+    for (int step = 0; step < W - 1; step++) {
+        int send_c = ((dist.rank + 1 - step) % W + W) % W;
+        int recv_c = ((dist.rank - step) % W + W) % W;
+        int s0 = chunk_begin(count, send_c), s1 = chunk_begin(count, send_c + 1);
+        int r0 = chunk_begin(count, recv_c), r1 = chunk_begin(count, recv_c + 1);
+
+        if (exchange(data + s0, sizeof(float) * (s1 - s0), data + r0, sizeof(float) * (r1 - r0)) < 0) {
+            fprintf(stderr, "dist: rank %d ring exchange failed\n", dist.rank);
+            exit(1);
+        }
+    }
+
+    free(tmp);
+}
+
+static unsigned new_generation(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ((unsigned)ts.tv_nsec ^ (unsigned)ts.tv_sec * 2654435761u ^ (unsigned)getpid() << 16) | 1u;
+}
+
+static int publish_generation(int port, unsigned generation) {
+    int listen_fd = tcp_listen(port);
+    if (listen_fd < 0) {
+        fprintf(stderr, "dist: rank 0 cannot listen on port %d\n", port);
+        return -1;
+    }
+    for (int r = 1; r < dist.world_size; r++) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0 || send(fd, &generation, sizeof(generation), MSG_NOSIGNAL) != (ssize_t)sizeof(generation)) {
+            fprintf(stderr, "dist: rank 0 cannot publish the shared memory generation\n");
+            if (fd >= 0) close(fd);
+            close(listen_fd);
+            return -1;
+        }
+        close(fd);
+    }
+    close(listen_fd);
+    return 0;
+}
+
+static int fetch_generation(int port, unsigned* generation) {
+    char host[256];
+    host_for_rank(0, host, sizeof(host));
+    int fd = tcp_connect(host, port);
+    if (fd < 0) {
+        fprintf(stderr, "dist: rank %d cannot connect to %s:%d\n", dist.rank, host, port);
+        return -1;
+    }
+    ssize_t k = recv(fd, generation, sizeof(*generation), MSG_WAITALL);
+    close(fd);
+    if (k != (ssize_t)sizeof(*generation)) {
+        fprintf(stderr, "dist: rank %d did not get the shared memory generation\n", dist.rank);
+        return -1;
+    }
+    return 0;
+}
+
+static int shm_setup(void) {
+    int port = env_int("CML_PORT", DIST_DEFAULT_PORT);
+    snprintf(dist.shm_name, sizeof(dist.shm_name), "/cml_dist_%d", port);
+    dist.shm_bytes = sizeof(ShmHeader) + sizeof(float) * (size_t)SHM_SLOT_FLOATS * dist.world_size;
+
+    unsigned generation = 0;
+    int fd = -1;
+    if (dist.rank == 0) {
+        generation = new_generation();
+        shm_unlink(dist.shm_name);
+        fd = shm_open(dist.shm_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ftruncate(fd, (off_t)dist.shm_bytes) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        if (fetch_generation(port, &generation) < 0) return -1;
+        fd = shm_open(dist.shm_name, O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "dist: rank %d cannot open shared memory %s\n", dist.rank, dist.shm_name);
+        return -1;
+    }
+
+    void* base = MAP_FAILED;
+    if (lseek(fd, 0, SEEK_END) >= (off_t)dist.shm_bytes)
+        base = mmap(NULL, dist.shm_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "dist: rank %d cannot map shared memory\n", dist.rank);
+        return -1;
+    }
+
+    dist.shm = (ShmHeader*)base;
+    dist.shm_slots = (float*)((char*)base + sizeof(ShmHeader));
+    dist.local_sense = 0;
+
+    if (dist.rank == 0) {
+        dist.shm->generation = generation;
+        __atomic_store_n(&dist.shm->ready, SHM_READY, __ATOMIC_RELEASE);
+        if (publish_generation(port, generation) < 0) return -1;
+        while (__atomic_load_n(&dist.shm->attached, __ATOMIC_ACQUIRE) != (unsigned)dist.world_size - 1)
+            sched_yield();
+    } else {
+        if (__atomic_load_n(&dist.shm->ready, __ATOMIC_ACQUIRE) != SHM_READY || dist.shm->generation != generation) {
+            fprintf(stderr, "dist: rank %d found a stale shared memory segment %s\n", dist.rank, dist.shm_name);
+            munmap(base, dist.shm_bytes);
+            return -1;
+        }
+        __atomic_add_fetch(&dist.shm->attached, 1, __ATOMIC_ACQ_REL);
+    }
+    return 0;
+}
+
+static void shm_barrier(void) {
+    dist.local_sense ^= 1;
+    if (__atomic_add_fetch(&dist.shm->arrived, 1, __ATOMIC_ACQ_REL) == (unsigned)dist.world_size) {
+        __atomic_store_n(&dist.shm->arrived, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&dist.shm->sense, dist.local_sense, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&dist.shm->sense, __ATOMIC_ACQUIRE) != dist.local_sense)
+            sched_yield();
+    }
+}
+
+static void shm_all_reduce(float* data, int count) {
+    int W = dist.world_size;
+    float* mine = dist.shm_slots + (size_t)dist.rank * SHM_SLOT_FLOATS;
+
+    for (int base = 0; base < count; base += SHM_SLOT_FLOATS) {
+        int n = count - base < SHM_SLOT_FLOATS ? count - base : SHM_SLOT_FLOATS;
+        memcpy(mine, data + base, sizeof(float) * n);
+        shm_barrier();
+
+        int c0 = chunk_begin(n, dist.rank), c1 = chunk_begin(n, dist.rank + 1);
+        for (int r = 0; r < W; r++) {
+            if (r == dist.rank) continue;
+            const float* other = dist.shm_slots + (size_t)r * SHM_SLOT_FLOATS;
+            for (int i = c0; i < c1; i++) mine[i] += other[i];
+        }
+        shm_barrier();
+
+        for (int r = 0; r < W; r++) {
+            const float* owner = dist.shm_slots + (size_t)r * SHM_SLOT_FLOATS;
+            int o0 = chunk_begin(n, r), o1 = chunk_begin(n, r + 1);
+            memcpy(data + base + o0, owner + o0, sizeof(float) * (o1 - o0));
+        }
+        shm_barrier();
+    }
+}
+
+int dist_init(int rank, int world_size) {
+    if (dist.initialized) return 0;
+    if (world_size < 1 || rank < 0 || rank >= world_size) {
+        fprintf(stderr, "dist_init invalid rank %d / world size %d\n", rank, world_size);
+        return -1;
+    }
+
+    dist.rank = rank;
+    dist.world_size = world_size;
+    if (world_size > 1) {
+        const char* transport = getenv("CML_DIST_TRANSPORT");
+        dist.use_shm = transport ? strcmp(transport, "shm") == 0 : all_hosts_local();
+        if ((dist.use_shm ? shm_setup() : tcp_setup()) < 0) return -1;
+    }
+    dist.initialized = 1;
+    return 0;
+}
+
+int dist_init_env(void) {
+    return dist_init(env_int("CML_RANK", 0), env_int("CML_WORLD_SIZE", 1));
+}
+
+int dist_rank(void) {
+    return dist.rank;
+}
+
+int dist_world_size(void) {
+    return dist.world_size;
+}
+
+void dist_all_reduce(float* data, int count) {
+    if (dist.world_size <= 1 || count <= 0) return;
+    if (dist.use_shm) shm_all_reduce(data, count);
+    else ring_all_reduce(data, count);
+}
+
+void dist_barrier(void) {
+    float token = 0.0f;
+    dist_all_reduce(&token, 1);
+}
+
+void dist_broadcast(float* data, int count, int root) {
+    if (dist.world_size <= 1) return;
+    if (dist.rank != root) memset(data, 0, sizeof(float) * count);
+    dist_all_reduce(data, count);
+}
+
+void dist_broadcast_params(Tensor** params, int n_params) {
+    for (int i = 0; i < n_params; i++)
+        dist_broadcast(params[i]->data, params[i]->size, 0);
+}
+
+static void submit_bucket(int b) {
+    dist.buckets[b].submitted = 1;
+    pthread_cond_broadcast(&dist.cond);
+}
+
+static int next_bucket_ready(void) {
+    return dist.completed < dist.n_buckets && dist.buckets[dist.completed].submitted;
+}
+
+static void* comm_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&dist.lock);
+    for (;;) {
+        while (!next_bucket_ready() && !dist.comm_stop)
+            pthread_cond_wait(&dist.cond, &dist.lock);
+        if (!next_bucket_ready()) break;
+        int b = dist.completed;
+        Bucket* bucket = &dist.buckets[b];
+        float scale = dist.scale;
+        pthread_mutex_unlock(&dist.lock);
+
+        dist_all_reduce(bucket->buffer, bucket->count);
+        for (int i = 0; i < bucket->count; i++) bucket->buffer[i] *= scale;
+        for (int p = 0; p < dist.n_params; p++) {
+            ParamSlot* slot = &dist.params[p];
+            if (slot->bucket != b) continue;
+            memcpy(slot->param->grad, bucket->buffer + slot->offset, sizeof(float) * slot->param->size);
+        }
+
+        pthread_mutex_lock(&dist.lock);
+        dist.completed++;
+        pthread_cond_broadcast(&dist.cond);
+    }
+    pthread_mutex_unlock(&dist.lock);
+    return NULL;
+}
+
+void dist_register_params(Tensor** params, int n_params, int bucket_bytes) {
+    if (dist.n_params) {
+        fprintf(stderr, "dist_register_params called twice\n");
+        return;
+    }
+    int bucket_floats = bucket_bytes > 0 ? bucket_bytes / (int)sizeof(float) : (1 << 20);
+
+    dist.params = (ParamSlot*)calloc(n_params, sizeof(ParamSlot));
+    dist.buckets = (Bucket*)calloc(n_params, sizeof(Bucket));
+    dist.n_params = n_params;
+    dist.n_buckets = 0;
+
+    for (int i = n_params - 1; i >= 0; i--) {
+        Bucket* bucket = dist.n_buckets ? &dist.buckets[dist.n_buckets - 1] : NULL;
+        if (!bucket || (bucket->count && bucket->count + params[i]->size > bucket_floats))
+            bucket = &dist.buckets[dist.n_buckets++];
+
+        dist.params[i].param = params[i];
+        dist.params[i].bucket = (int)(bucket - dist.buckets);
+        dist.params[i].offset = bucket->count;
+        bucket->count += params[i]->size;
+        bucket->n_params++;
+    }
+    for (int b = 0; b < dist.n_buckets; b++)
+        dist.buckets[b].buffer = (float*)malloc(sizeof(float) * dist.buckets[b].count);
+
+    if (dist.world_size > 1) {
+        dist.comm_stop = 0;
+        dist.comm_running = pthread_create(&dist.comm_thread, NULL, comm_main, NULL) == 0;
+    }
+}
+
+static void copy_to_bucket(ParamSlot* slot) {
+    Bucket* bucket = &dist.buckets[slot->bucket];
+    memcpy(bucket->buffer + slot->offset, slot->param->grad, sizeof(float) * slot->param->size);
+    slot->ready = 1;
+}
+
+static void grad_ready(Tensor* t, void* ctx) {
+    (void)ctx;
+    for (int p = 0; p < dist.n_params; p++) {
+        ParamSlot* slot = &dist.params[p];
+        if (slot->param != t || slot->ready) continue;
+
+        copy_to_bucket(slot);
+        pthread_mutex_lock(&dist.lock);
+        if (--dist.buckets[slot->bucket].pending == 0) submit_bucket(slot->bucket);
+        pthread_mutex_unlock(&dist.lock);
+    }
+}
+
+static void run_dist_backward(Tensor* loss, const float* seed, float scale) {
+    if (dist.world_size <= 1 || !dist.comm_running) {
+        if (seed) tensor_backward_with_grad(loss, seed);
+        else tensor_backward(loss);
+        return;
+    }
+
+    pthread_mutex_lock(&dist.lock);
+    dist.scale = scale;
+    for (int b = 0; b < dist.n_buckets; b++) {
+        dist.buckets[b].pending = dist.buckets[b].n_params;
+        dist.buckets[b].submitted = 0;
+    }
+    for (int p = 0; p < dist.n_params; p++) dist.params[p].ready = 0;
+    dist.completed = 0;
+    pthread_mutex_unlock(&dist.lock);
+
+    tensor_set_grad_hook(grad_ready, NULL);
+    if (seed) tensor_backward_with_grad(loss, seed);
+    else tensor_backward(loss);
+    tensor_set_grad_hook(NULL, NULL);
+
+    pthread_mutex_lock(&dist.lock);
+    for (int b = 0; b < dist.n_buckets; b++) {
+        if (dist.buckets[b].submitted) continue;
+        for (int p = 0; p < dist.n_params; p++)
+            if (dist.params[p].bucket == b && !dist.params[p].ready) copy_to_bucket(&dist.params[p]);
+        submit_bucket(b);
+    }
+    while (dist.completed < dist.n_buckets)
+        pthread_cond_wait(&dist.cond, &dist.lock);
+    pthread_mutex_unlock(&dist.lock);
+}
+
+void dist_backward(Tensor* loss) {
+    run_dist_backward(loss, NULL, 1.0f / (float)dist.world_size);
+}
+
+void dist_backward_weighted(Tensor* loss, float weight) {
+    run_dist_backward(loss, &weight, 1.0f);
+}
+
+void dist_finalize(void) {
+    if (dist.comm_running) {
+        pthread_mutex_lock(&dist.lock);
+        dist.comm_stop = 1;
+        pthread_cond_broadcast(&dist.cond);
+        pthread_mutex_unlock(&dist.lock);
+        pthread_join(dist.comm_thread, NULL);
+        dist.comm_running = 0;
+    }
+    for (int b = 0; b < dist.n_buckets; b++) free(dist.buckets[b].buffer);
+    free(dist.buckets);
+    free(dist.params);
+    dist.buckets = NULL;
+    dist.params = NULL;
+    dist.n_buckets = 0;
+    dist.n_params = 0;
+
+    if (dist.initialized && dist.world_size > 1) {
+        dist_barrier();
+        if (dist.use_shm) {
+            munmap(dist.shm, dist.shm_bytes);
+            if (dist.rank == 0) shm_unlink(dist.shm_name);
+        } else {
+            close(dist.send_fd);
+            close(dist.recv_fd);
+        }
+    }
+    dist.initialized = 0;
+    dist.world_size = 1;
+    dist.rank = 0;
+}
@@ -0,0 +1,16 @@
+#ifndef CML_DIST_H
+#define CML_DIST_H
+#include "../tensor/tensor.h"
+int dist_init(int rank, int world_size);
+int dist_init_env(void);
+int dist_rank(void);
+int dist_world_size(void);
+void dist_barrier(void);
+void dist_all_reduce(float* data, int count);
+void dist_broadcast(float* data, int count, int root);
+void dist_broadcast_params(Tensor** params, int n_params);
+void dist_register_params(Tensor** params, int n_params, int bucket_bytes);
+void dist_backward(Tensor* loss);
+void dist_backward_weighted(Tensor* loss, float weight);
+void dist_finalize(void);
+#endif
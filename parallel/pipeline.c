@@ -0,0 +1,330 @@
+#define _GNU_SOURCE
+#include "pipeline.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "../nn/activations.h"
+#include "../optim/sgd.h"
+
+typedef struct {
+    int micro;
+    Tensor* tensor;
+    float* grad;
+} Message;
+
+typedef struct {
+    Message* items;
+    int head;
+    int tail;
+    int capacity;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} MessageQueue;
+
+typedef struct Stage Stage;
+struct Stage {
+    Pipeline* pipeline;
+    int index;
+    Linear** layers;
+    int n_layers;
+    int is_last;
+    Tensor** params;
+    int n_params;
+
+    Tensor** inputs;
+    Tensor** outputs;
+    Tensor** targets;
+    int n_slots;
+    float loss_sum;
+
+    MessageQueue activations;
+    MessageQueue grads;
+    pthread_t thread;
+};
+
+struct Pipeline {
+    Stage* stages;
+    int n_stages;
+    pipeline_loss_fn loss_fn;
+
+    Tensor* x;
+    Tensor* y;
+    int n_micro;
+    float lr;
+
+    unsigned long generation;
+    int finished;
+    int shutdown;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+};
+
+static void queue_init(MessageQueue* q) {
+    q->items = NULL;
+    q->head = q->tail = q->capacity = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+}
+
+static void queue_destroy(MessageQueue* q) {
+    free(q->items);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+}
+
+static void queue_push(MessageQueue* q, Message m) {
+    pthread_mutex_lock(&q->lock);
+    if (q->tail == q->capacity) {
+        if (q->head > 0) {
+            memmove(q->items, q->items + q->head, sizeof(Message) * (q->tail - q->head));
+            q->tail -= q->head;
+            q->head = 0;
+        } else {
+            q->capacity = q->capacity ? q->capacity * 2 : 8;
+            q->items = (Message*)realloc(q->items, sizeof(Message) * q->capacity);
+        }
+    }
+    q->items[q->tail++] = m;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static Message queue_pop(MessageQueue* q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->head == q->tail)
+        pthread_cond_wait(&q->cond, &q->lock);
+    Message m = q->items[q->head++];
+    pthread_mutex_unlock(&q->lock);
+    return m;
+}
+
+static float micro_weight(int N, int micro, int n_micro) {
+    int begin = (int)((long)N * micro / n_micro);
+    int end = (int)((long)N * (micro + 1) / n_micro);
+    return (float)(end - begin) / (float)N;
+}
+
+static Tensor* micro_rows(Tensor* t, int micro, int n_micro) {
+    int N = t->shape[0];
+    int begin = (int)((long)N * micro / n_micro);
+    int end = (int)((long)N * (micro + 1) / n_micro);
+    int row = t->ndim == 2 ? t->shape[1] : 1;
+    int shape[2] = { end - begin, row };
+    return tensor_from_data(t->ndim, shape, t->data + (size_t)begin * row, 0);
+}
+
+static void stage_forward(Stage* s, int micro) {
+    Pipeline* p = s->pipeline;
+    Tensor* in;
+    if (s->index == 0) {
+        in = micro_rows(p->x, micro, p->n_micro);
+    } else {
+        Message m = queue_pop(&s->pipeline->stages[s->index - 1].activations);
+        in = tensor_from_data(m.tensor->ndim, m.tensor->shape, m.tensor->data, 1);
+    }
+
+    Tensor* h = in;
+    tensor_retain(h);
+    for (int l = 0; l < s->n_layers; l++) {
+        Tensor* out = linear_forward(s->layers[l], h);
+        tensor_release(h);
+        if (s->is_last && l == s->n_layers - 1) {
+            h = out;
+            break;
+        }
+        h = relu(out);
+        tensor_release(out);
+    }
+
+    s->inputs[micro] = in;
+    if (s->is_last) {
+        Tensor* target = micro_rows(p->y, micro, p->n_micro);
+        Tensor* loss = p->loss_fn(h, target);
+        tensor_release(h);
+        s->targets[micro] = target;
+        s->loss_sum += micro_weight(p->y->shape[0], micro, p->n_micro) * loss->data[0];
+        s->outputs[micro] = loss;
+    } else {
+        tensor_eval(h);
+        s->outputs[micro] = h;
+        Message m = { micro, h, NULL };
+        queue_push(&s->activations, m);
+    }
+}
+
+static void stage_backward(Stage* s, int micro) {
+    Pipeline* p = s->pipeline;
+    Tensor* out = s->outputs[micro];
+
+    if (s->is_last) {
+        float weight = micro_weight(p->y->shape[0], micro, p->n_micro);
+        tensor_backward_with_grad(out, &weight);
+        tensor_release(s->targets[micro]);
+        s->targets[micro] = NULL;
+    } else {
+        Message m = queue_pop(&p->stages[s->index + 1].grads);
+        tensor_backward_with_grad(out, m.grad);
+        free(m.grad);
+    }
+
+    Tensor* in = s->inputs[micro];
+    if (s->index > 0) {
+        float* grad = (float*)malloc(sizeof(float) * in->size);
+        memcpy(grad, in->grad, sizeof(float) * in->size);
+        Message m = { micro, NULL, grad };
+        queue_push(&s->grads, m);
+    }
+
+    tensor_release(out);
+    tensor_release(in);
+    s->outputs[micro] = NULL;
+    s->inputs[micro] = NULL;
+}
+
+static void stage_run(Stage* s) {
+    Pipeline* p = s->pipeline;
+    int n_micro = p->n_micro;
+
+    if (s->n_slots < n_micro) {
+        s->inputs = (Tensor**)realloc(s->inputs, sizeof(Tensor*) * n_micro);
+        s->outputs = (Tensor**)realloc(s->outputs, sizeof(Tensor*) * n_micro);
+        s->targets = (Tensor**)realloc(s->targets, sizeof(Tensor*) * n_micro);
+        s->n_slots = n_micro;
+    }
+    s->loss_sum = 0.0f;
+    sgd_zero_grad(s->params, s->n_params);
+
+    int warmup = p->n_stages - s->index - 1;
+    if (warmup > n_micro) warmup = n_micro;
+
+    int fwd = 0, bwd = 0;
+    while (fwd < warmup) stage_forward(s, fwd++);
+    while (fwd < n_micro) {
+        stage_forward(s, fwd++);
+        stage_backward(s, bwd++);
+    }
+    while (bwd < n_micro) stage_backward(s, bwd++);
+
+    sgd_step_params(s->params, s->n_params, p->lr);
+}
+
+static void* stage_main(void* arg) {
+    Stage* s = (Stage*)arg;
+    Pipeline* p = s->pipeline;
+
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_cpus > 1) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(s->index % n_cpus, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    unsigned long seen = 0;
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (p->generation == seen && !p->shutdown)
+            pthread_cond_wait(&p->start, &p->lock);
+        if (p->shutdown) break;
+        seen = p->generation;
+        pthread_mutex_unlock(&p->lock);
+
+        stage_run(s);
+
+        pthread_mutex_lock(&p->lock);
+        if (++p->finished == p->n_stages) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+Pipeline* pipeline_create(Linear** layers, int n_layers, int n_stages, pipeline_loss_fn loss_fn) {
+    if (n_stages <= 0 || n_stages > n_layers || !loss_fn) {
+        fprintf(stderr, "pipeline_create invalid stage count %d for %d layers\n", n_stages, n_layers);
+        return NULL;
+    }
+
+    Pipeline* p = (Pipeline*)calloc(1, sizeof(Pipeline));
+    p->n_stages = n_stages;
+    p->loss_fn = loss_fn;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    p->stages = (Stage*)calloc(n_stages, sizeof(Stage));
+    for (int k = 0; k < n_stages; k++) {
+        Stage* s = &p->stages[k];
+        int l0 = n_layers * k / n_stages;
+        int l1 = n_layers * (k + 1) / n_stages;
+        s->pipeline = p;
+        s->index = k;
+        s->layers = layers + l0;
+        s->n_layers = l1 - l0;
+        s->is_last = k == n_stages - 1;
+
+        s->n_params = 2 * s->n_layers;
+        s->params = (Tensor**)malloc(sizeof(Tensor*) * s->n_params);
+        for (int l = 0; l < s->n_layers; l++) {
+            s->params[2*l] = s->layers[l]->weight;
+            s->params[2*l + 1] = s->layers[l]->bias;
+        }
+
+        queue_init(&s->activations);
+        queue_init(&s->grads);
+    }
+
+    for (int k = 0; k < n_stages; k++)
+        pthread_create(&p->stages[k].thread, NULL, stage_main, &p->stages[k]);
+
+    return p;
+}
+
+float pipeline_step(Pipeline* p, Tensor* x, Tensor* y, int n_micro, float lr) {
+    if (x->shape[0] != y->shape[0] || n_micro <= 0 || n_micro > x->shape[0]) {
+        fprintf(stderr, "pipeline_step invalid batch / micro-batch count\n");
+        return 0.0f;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->x = x;
+    p->y = y;
+    p->n_micro = n_micro;
+    p->lr = lr;
+    p->finished = 0;
+    p->generation++;
+    pthread_cond_broadcast(&p->start);
+    while (p->finished < p->n_stages)
+        pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+
+    return p->stages[p->n_stages - 1].loss_sum;
+}
+
+void pipeline_free(Pipeline* p) {
+    if (!p) return;
+
+    pthread_mutex_lock(&p->lock);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+
+    for (int k = 0; k < p->n_stages; k++) {
+        Stage* s = &p->stages[k];
+        pthread_join(s->thread, NULL);
+        queue_destroy(&s->activations);
+        queue_destroy(&s->grads);
+        free(s->params);
+        free(s->inputs);
+        free(s->outputs);
+        free(s->targets);
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->start);
+    pthread_cond_destroy(&p->done);
+    free(p->stages);
+    free(p);
+}
@@ -0,0 +1,10 @@
+#ifndef CML_PIPELINE_H
+#define CML_PIPELINE_H
+#include "../tensor/tensor.h"
+#include "../nn/linear.h"
+typedef Tensor* (*pipeline_loss_fn)(Tensor* output, Tensor* target);
+typedef struct Pipeline Pipeline;
+Pipeline* pipeline_create(Linear** layers, int n_layers, int n_stages, pipeline_loss_fn loss_fn);
+float pipeline_step(Pipeline* p, Tensor* x, Tensor* y, int n_micro, float lr);
+void pipeline_free(Pipeline* p);
+#endif
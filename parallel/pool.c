@@ -0,0 +1,158 @@
+#include "pool.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct {
+    pthread_t* threads;
+    int n_threads;
+    int started;
+    int shutdown;
+    unsigned long generation;
+    int pending;
+
+    pool_fn fn;
+    void* ctx;
+    int n;
+    int grain;
+    int next;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_mutex_t submit;
+} ThreadPool;
+
+static ThreadPool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static __thread int in_pool = 0;
+
+static void run_chunks(void) {
+    for (;;) {
+        int begin = __atomic_fetch_add(&pool.next, pool.grain, __ATOMIC_RELAXED);
+        if (begin >= pool.n) break;
+        int end = begin + pool.grain < pool.n ? begin + pool.grain : pool.n;
+        pool.fn(begin, end, pool.ctx);
+    }
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    in_pool = 1;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (pool.generation == seen && !pool.shutdown)
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        if (pool.shutdown) break;
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        run_chunks();
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.pending == 0) pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static int default_threads(void) {
+    const char* env = getenv("CML_NUM_THREADS");
+    if (env && atoi(env) > 0) return atoi(env);
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static void pool_start(int n_threads) {
+    pool.n_threads = n_threads;
+    pool.shutdown = 0;
+    pool.threads = NULL;
+    if (n_threads > 1) {
+        pool.threads = (pthread_t*)malloc(sizeof(pthread_t) * (n_threads - 1));
+        for (int i = 0; i < n_threads - 1; i++) {
+            if (pthread_create(&pool.threads[i], NULL, worker_main, NULL) != 0) {
+                fprintf(stderr, "pool: failed to start worker thread\n");
+                pool.n_threads = i + 1;
+                break;
+            }
+        }
+    }
+    __atomic_store_n(&pool.started, 1, __ATOMIC_RELEASE);
+}
+
+int pool_num_threads(void) {
+    if (!__atomic_load_n(&pool.started, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&pool.submit);
+        if (!pool.started) pool_start(default_threads());
+        pthread_mutex_unlock(&pool.submit);
+    }
+    return pool.n_threads;
+}
+
+void pool_shutdown(void) {
+    pthread_mutex_lock(&pool.submit);
+    if (pool.started) {
+        pthread_mutex_lock(&pool.lock);
+        pool.shutdown = 1;
+        pthread_cond_broadcast(&pool.wake);
+        pthread_mutex_unlock(&pool.lock);
+        for (int i = 0; i < pool.n_threads - 1; i++)
+            pthread_join(pool.threads[i], NULL);
+        free(pool.threads);
+        pool.threads = NULL;
+        pool.started = 0;
+    }
+    pthread_mutex_unlock(&pool.submit);
+}
+
+void pool_set_num_threads(int n_threads) {
+    pool_shutdown();
+    pthread_mutex_lock(&pool.submit);
+    pool_start(n_threads > 0 ? n_threads : default_threads());
+    pthread_mutex_unlock(&pool.submit);
+}
+
+void parallel_for(int n, int grain, pool_fn fn, void* ctx) {
+    if (n <= 0) return;
+    if (in_pool || pthread_mutex_trylock(&pool.submit) != 0) {
+        fn(0, n, ctx);
+        return;
+    }
+    if (!pool.started) pool_start(default_threads());
+    if (grain <= 0) grain = (n + pool.n_threads * 4 - 1) / (pool.n_threads * 4);
+    if (pool.n_threads <= 1 || n <= grain) {
+        pthread_mutex_unlock(&pool.submit);
+        fn(0, n, ctx);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.n = n;
+    pool.grain = grain;
+    pool.next = 0;
+    pool.pending = pool.n_threads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_pool = 1;
+    run_chunks();
+    in_pool = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending > 0)
+        pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.submit);
+}
@@ -0,0 +1,8 @@
+#ifndef CML_POOL_H
+#define CML_POOL_H
+typedef void (*pool_fn)(int begin, int end, void* ctx);
+int pool_num_threads(void);
+void pool_set_num_threads(int n_threads);
+void parallel_for(int n, int grain, pool_fn fn, void* ctx);
+void pool_shutdown(void);
+#endif
@@ -0,0 +1,686 @@
+#include "server.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define SERVE_MAX_MESSAGE (64u << 20)
+#define SERVE_LAT_WINDOW 8192
+#define SERVE_READ_CHUNK 65536
+#define SERVE_MAX_PENDING (SERVE_MAX_MESSAGE + 8u)
+
+typedef struct Reply Reply;
+struct Reply {
+    unsigned after;
+    uint32_t status;
+    uint32_t bytes;
+    Reply* next;
+    char payload[];
+};
+
+typedef struct {
+    int fd;
+    int refs;
+    int dead;
+    pthread_mutex_t write_lock;
+    char* out;
+    size_t out_pos;
+    size_t out_len;
+    size_t out_cap;
+    unsigned infer_sent;
+    unsigned infer_done;
+    Reply* parked;
+    Reply* parked_tail;
+    size_t parked_bytes;
+    char* buf;
+    size_t len;
+    size_t cap;
+} Conn;
+
+typedef struct Request Request;
+struct Request {
+    Conn* conn;
+    int rows;
+    float* x;
+    double arrival;
+    Request* next;
+};
+
+struct Server {
+    MLP* model;
+    ServerConfig config;
+    int in_dim;
+    int out_dim;
+
+    int listen_fds[2];
+    int n_listen;
+    int wake_pipe[2];
+    int stop;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Request* head;
+    Request* tail;
+    int queued_rows;
+    pthread_t batcher;
+
+    pthread_mutex_t stats_lock;
+    double start;
+    long requests;
+    long batches;
+    long rows_served;
+    float latencies[SERVE_LAT_WINDOW];
+    long n_latencies;
+    double max_us;
+
+    Conn** conns;
+    int n_conns;
+    int cap_conns;
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int write_full(int fd, const void* buf, size_t bytes) {
+    const char* p = (const char*)buf;
+    while (bytes > 0) {
+        ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return 0;
+}
+
+static void set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void server_wake(Server* s) {
+    char byte = 1;
+    ssize_t n = write(s->wake_pipe[1], &byte, 1);
+    (void)n;
+}
+
+static int read_full(int fd, void* buf, size_t bytes) {
+    char* p = (char*)buf;
+    while (bytes > 0) {
+        ssize_t n = recv(fd, p, bytes, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return 0;
+}
+
+static void conn_release(Conn* c) {
+    if (__atomic_sub_fetch(&c->refs, 1, __ATOMIC_ACQ_REL) > 0) return;
+    close(c->fd);
+    pthread_mutex_destroy(&c->write_lock);
+    while (c->parked) {
+        Reply* next = c->parked->next;
+        free(c->parked);
+        c->parked = next;
+    }
+    free(c->out);
+    free(c->buf);
+    free(c);
+}
+
+static void conn_flush(Conn* c) {
+    while (!c->dead && c->out_pos < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_pos, c->out_len - c->out_pos, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) c->dead = 1;
+        else c->out_pos += (size_t)n;
+    }
+    c->out_pos = c->out_len = 0;
+}
+
+static void conn_append(Conn* c, uint32_t status, const void* payload, uint32_t bytes) {
+    uint32_t header[2] = { status, bytes };
+    size_t pending = c->out_len - c->out_pos;
+    if (!c->dead && pending + c->parked_bytes + sizeof(header) + bytes > SERVE_MAX_PENDING) c->dead = 1;
+    if (!c->dead) {
+        if (c->out_pos > 0) {
+            memmove(c->out, c->out + c->out_pos, pending);
+            c->out_pos = 0;
+            c->out_len = pending;
+        }
+        size_t need = pending + sizeof(header) + bytes;
+        if (need > c->out_cap) {
+            c->out_cap = c->out_cap * 2 > need ? c->out_cap * 2 : need;
+            c->out = (char*)realloc(c->out, c->out_cap);
+        }
+        memcpy(c->out + c->out_len, header, sizeof(header));
+        if (bytes > 0) memcpy(c->out + c->out_len + sizeof(header), payload, bytes);
+        c->out_len += sizeof(header) + bytes;
+        conn_flush(c);
+    }
+}
+
+static int conn_reply(Conn* c, uint32_t status, const void* payload, uint32_t bytes) {
+    pthread_mutex_lock(&c->write_lock);
+    conn_append(c, status, payload, bytes);
+    c->infer_done++;
+    while (c->parked && c->parked->after == c->infer_done) {
+        Reply* r = c->parked;
+        c->parked = r->next;
+        if (!c->parked) c->parked_tail = NULL;
+        c->parked_bytes -= sizeof(Reply) + r->bytes;
+        conn_append(c, r->status, r->payload, r->bytes);
+        free(r);
+    }
+    int wake = c->dead || c->out_len > c->out_pos;
+    pthread_mutex_unlock(&c->write_lock);
+    return wake;
+}
+
+static void conn_reply_now(Conn* c, uint32_t status, const void* payload, uint32_t bytes) {
+    pthread_mutex_lock(&c->write_lock);
+    if (c->infer_done == c->infer_sent) {
+        conn_append(c, status, payload, bytes);
+    } else if (!c->dead) {
+        size_t need = sizeof(Reply) + bytes;
+        if (c->out_len - c->out_pos + c->parked_bytes + need > SERVE_MAX_PENDING) {
+            c->dead = 1;
+        } else {
+            Reply* r = (Reply*)malloc(need);
+            r->after = c->infer_sent;
+            r->status = status;
+            r->bytes = bytes;
+            r->next = NULL;
+            if (bytes > 0) memcpy(r->payload, payload, bytes);
+            if (c->parked_tail) c->parked_tail->next = r;
+            else c->parked = r;
+            c->parked_tail = r;
+            c->parked_bytes += need;
+        }
+    }
+    pthread_mutex_unlock(&c->write_lock);
+}
+
+static void record_batch(Server* s, Request* batch, int rows, double done) {
+    pthread_mutex_lock(&s->stats_lock);
+    s->batches++;
+    s->rows_served += rows;
+    for (Request* r = batch; r; r = r->next) {
+        double us = (done - r->arrival) * 1e6;
+        s->latencies[s->n_latencies % SERVE_LAT_WINDOW] = (float)us;
+        s->n_latencies++;
+        s->requests++;
+        if (us > s->max_us) s->max_us = us;
+    }
+    pthread_mutex_unlock(&s->stats_lock);
+}
+
+static void run_batch(Server* s, Request* batch, int rows) {
+    float* x = batch->x;
+    if (batch->next) {
+        x = (float*)malloc(sizeof(float) * (size_t)rows * s->in_dim);
+        size_t offset = 0;
+        for (Request* r = batch; r; r = r->next) {
+            memcpy(x + offset, r->x, sizeof(float) * (size_t)r->rows * s->in_dim);
+            offset += (size_t)r->rows * s->in_dim;
+        }
+    }
+
+    int shape[2] = { rows, s->in_dim };
+    Tensor* input = tensor_from_data(2, shape, x, 0);
+    Tensor* out = mlp_forward(s->model, input);
+    const float* y = tensor_eval(out);
+
+    size_t offset = 0;
+    int wake = 0;
+    for (Request* r = batch; r; r = r->next) {
+        size_t n = (size_t)r->rows * s->out_dim;
+        wake |= conn_reply(r->conn, SERVE_STATUS_OK, y + offset, (uint32_t)(n * sizeof(float)));
+        offset += n;
+    }
+    if (wake) server_wake(s);
+    record_batch(s, batch, rows, now_seconds());
+
+    tensor_release(out);
+    tensor_release(input);
+    if (x != batch->x) free(x);
+}
+
+static void deadline_to_timespec(double deadline, struct timespec* ts) {
+    ts->tv_sec = (time_t)deadline;
+    ts->tv_nsec = (long)((deadline - (double)ts->tv_sec) * 1e9);
+}
+
+static int stopping(Server* s) {
+    return __atomic_load_n(&s->stop, __ATOMIC_ACQUIRE);
+}
+
+static void* batcher_main(void* arg) {
+    Server* s = (Server*)arg;
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        while (!stopping(s) && !s->head) pthread_cond_wait(&s->cond, &s->lock);
+        if (!s->head) break;
+
+        double deadline = s->head->arrival + s->config.max_latency_us * 1e-6;
+        while (!stopping(s) && s->queued_rows < s->config.max_batch && now_seconds() < deadline) {
+            struct timespec ts;
+            deadline_to_timespec(deadline, &ts);
+            pthread_cond_timedwait(&s->cond, &s->lock, &ts);
+        }
+
+        Request* batch = s->head;
+        Request* last = batch;
+        int rows = batch->rows;
+        while (last->next && rows + last->next->rows <= s->config.max_batch) {
+            last = last->next;
+            rows += last->rows;
+        }
+        s->head = last->next;
+        if (!s->head) s->tail = NULL;
+        last->next = NULL;
+        s->queued_rows -= rows;
+        pthread_mutex_unlock(&s->lock);
+
+        run_batch(s, batch, rows);
+        while (batch) {
+            Request* next = batch->next;
+            conn_release(batch->conn);
+            free(batch->x);
+            free(batch);
+            batch = next;
+        }
+
+        pthread_mutex_lock(&s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+static void enqueue(Server* s, Conn* c, const void* x, int rows) {
+    Request* r = (Request*)malloc(sizeof(Request));
+    r->conn = c;
+    r->rows = rows;
+    r->x = (float*)malloc(sizeof(float) * (size_t)rows * s->in_dim);
+    memcpy(r->x, x, sizeof(float) * (size_t)rows * s->in_dim);
+    r->arrival = now_seconds();
+    r->next = NULL;
+    __atomic_add_fetch(&c->refs, 1, __ATOMIC_ACQ_REL);
+
+    pthread_mutex_lock(&s->lock);
+    if (s->tail) s->tail->next = r;
+    else s->head = r;
+    s->tail = r;
+    s->queued_rows += rows;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void stats_payload(Server* s, double* out) {
+    ServerStats stats;
+    server_get_stats(s, &stats);
+    out[0] = stats.requests;
+    out[1] = stats.batches;
+    out[2] = stats.mean_batch;
+    out[3] = stats.throughput;
+    out[4] = stats.p50_us;
+    out[5] = stats.p99_us;
+    out[6] = stats.max_us;
+}
+
+static int handle_messages(Server* s, Conn* c) {
+    size_t pos = 0;
+    while (c->len - pos >= 8) {
+        uint32_t header[2];
+        memcpy(header, c->buf + pos, sizeof(header));
+        if (header[1] > SERVE_MAX_MESSAGE) return -1;
+        if (c->len - pos - 8 < header[1]) break;
+        const char* payload = c->buf + pos + 8;
+
+        if (header[0] == SERVE_OP_INFER) {
+            size_t row_bytes = sizeof(float) * (size_t)s->in_dim;
+            if (header[1] == 0 || header[1] % row_bytes != 0) {
+                conn_reply_now(c, SERVE_STATUS_ERROR, NULL, 0);
+            } else {
+                c->infer_sent++;
+                enqueue(s, c, payload, (int)(header[1] / row_bytes));
+            }
+        } else if (header[0] == SERVE_OP_STATS) {
+            double stats[7];
+            stats_payload(s, stats);
+            conn_reply_now(c, SERVE_STATUS_OK, stats, sizeof(stats));
+        } else {
+            conn_reply_now(c, SERVE_STATUS_ERROR, NULL, 0);
+        }
+        pos += 8 + header[1];
+    }
+
+    memmove(c->buf, c->buf + pos, c->len - pos);
+    c->len -= pos;
+    return 0;
+}
+
+static int conn_read(Server* s, Conn* c) {
+    if (c->cap - c->len < SERVE_READ_CHUNK) {
+        c->cap = c->cap * 2 > c->len + SERVE_READ_CHUNK ? c->cap * 2 : c->len + SERVE_READ_CHUNK;
+        c->buf = (char*)realloc(c->buf, c->cap);
+    }
+    ssize_t n = recv(c->fd, c->buf + c->len, c->cap - c->len, 0);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    if (n <= 0) return -1;
+    c->len += (size_t)n;
+    return handle_messages(s, c);
+}
+
+static void add_conn(Server* s, int fd) {
+    if (s->n_conns == s->cap_conns) {
+        s->cap_conns = s->cap_conns ? s->cap_conns * 2 : 16;
+        s->conns = (Conn**)realloc(s->conns, sizeof(Conn*) * s->cap_conns);
+    }
+    Conn* c = (Conn*)calloc(1, sizeof(Conn));
+    set_nonblocking(fd);
+    c->fd = fd;
+    c->refs = 1;
+    pthread_mutex_init(&c->write_lock, NULL);
+    s->conns[s->n_conns++] = c;
+}
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+Server* server_create(MLP* model, const ServerConfig* config) {
+    if (!config->unix_path && config->tcp_port <= 0) {
+        fprintf(stderr, "server_create: need a unix socket path or a tcp port\n");
+        return NULL;
+    }
+
+    Server* s = (Server*)calloc(1, sizeof(Server));
+    s->wake_pipe[0] = s->wake_pipe[1] = -1;
+    s->model = model;
+    s->config = *config;
+    if (s->config.max_batch <= 0) s->config.max_batch = 64;
+    if (s->config.max_latency_us < 0) s->config.max_latency_us = 0;
+    s->in_dim = model->layers[0]->in_features;
+    s->out_dim = model->layers[model->n_layers - 1]->out_features;
+
+    if (config->unix_path) {
+        int fd = listen_unix(config->unix_path);
+        if (fd < 0) {
+            fprintf(stderr, "server_create: cannot listen on %s\n", config->unix_path);
+            server_free(s);
+            return NULL;
+        }
+        s->listen_fds[s->n_listen++] = fd;
+    }
+    if (config->tcp_port > 0) {
+        int fd = listen_tcp(config->tcp_port);
+        if (fd < 0) {
+            fprintf(stderr, "server_create: cannot listen on 127.0.0.1:%d\n", config->tcp_port);
+            server_free(s);
+            return NULL;
+        }
+        s->listen_fds[s->n_listen++] = fd;
+    }
+
+    if (pipe(s->wake_pipe) < 0) {
+        server_free(s);
+        return NULL;
+    }
+    set_nonblocking(s->wake_pipe[0]);
+    set_nonblocking(s->wake_pipe[1]);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&s->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_mutex_init(&s->stats_lock, NULL);
+    return s;
+}
+
+int server_run(Server* s) {
+    s->start = now_seconds();
+    if (pthread_create(&s->batcher, NULL, batcher_main, s) != 0) {
+        fprintf(stderr, "server_run: cannot start batcher thread\n");
+        return -1;
+    }
+
+    struct pollfd* fds = NULL;
+    int cap_fds = 0;
+    while (!stopping(s)) {
+        int n_fds = 1 + s->n_listen + s->n_conns;
+        if (n_fds > cap_fds) {
+            cap_fds = n_fds * 2;
+            fds = (struct pollfd*)realloc(fds, sizeof(struct pollfd) * cap_fds);
+        }
+        fds[0].fd = s->wake_pipe[0];
+        fds[0].events = POLLIN;
+        for (int i = 0; i < s->n_listen; i++) {
+            fds[1 + i].fd = s->listen_fds[i];
+            fds[1 + i].events = POLLIN;
+        }
+        for (int i = 0; i < s->n_conns; i++) {
+            Conn* c = s->conns[i];
+            pthread_mutex_lock(&c->write_lock);
+            int pending = c->out_len > c->out_pos;
+            pthread_mutex_unlock(&c->write_lock);
+            fds[1 + s->n_listen + i].fd = c->fd;
+            fds[1 + s->n_listen + i].events = POLLIN | (pending ? POLLOUT : 0);
+        }
+
+        if (poll(fds, n_fds, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) {
+            char drain[64];
+            while (read(s->wake_pipe[0], drain, sizeof(drain)) > 0) {}
+            if (stopping(s)) break;
+        }
+
+        int n_conns = s->n_conns;
+        for (int i = 0; i < s->n_listen; i++) {
+            if (!(fds[1 + i].revents & POLLIN)) continue;
+            int fd = accept(s->listen_fds[i], NULL, NULL);
+            if (fd < 0) continue;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            add_conn(s, fd);
+        }
+
+        int kept = 0;
+        for (int i = 0; i < s->n_conns; i++) {
+            Conn* c = s->conns[i];
+            short revents = i < n_conns ? fds[1 + s->n_listen + i].revents : 0;
+            int failed = (revents & (POLLIN | POLLHUP | POLLERR)) && conn_read(s, c) < 0;
+            pthread_mutex_lock(&c->write_lock);
+            if (revents & POLLOUT) conn_flush(c);
+            if (failed) c->dead = 1;
+            failed = c->dead;
+            pthread_mutex_unlock(&c->write_lock);
+            if (failed) {
+                conn_release(c);
+                continue;
+            }
+            s->conns[kept++] = c;
+        }
+        s->n_conns = kept;
+    }
+    free(fds);
+
+    pthread_mutex_lock(&s->lock);
+    __atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->batcher, NULL);
+
+    for (int i = 0; i < s->n_conns; i++) conn_release(s->conns[i]);
+    s->n_conns = 0;
+    return 0;
+}
+
+void server_stop(Server* s) {
+    int saved_errno = errno;
+    __atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+    server_wake(s);
+    errno = saved_errno;
+}
+
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void server_get_stats(Server* s, ServerStats* stats) {
+    float sorted[SERVE_LAT_WINDOW];
+    pthread_mutex_lock(&s->stats_lock);
+    int n = s->n_latencies < SERVE_LAT_WINDOW ? (int)s->n_latencies : SERVE_LAT_WINDOW;
+    memcpy(sorted, s->latencies, sizeof(float) * n);
+    stats->requests = (double)s->requests;
+    stats->batches = (double)s->batches;
+    stats->mean_batch = s->batches ? (double)s->rows_served / (double)s->batches : 0.0;
+    double elapsed = now_seconds() - s->start;
+    stats->throughput = elapsed > 0.0 ? (double)s->requests / elapsed : 0.0;
+    stats->max_us = s->max_us;
+    pthread_mutex_unlock(&s->stats_lock);
+
+    qsort(sorted, n, sizeof(float), compare_float);
+    stats->p50_us = n ? sorted[n / 2] : 0.0;
+    stats->p99_us = n ? sorted[(int)((long)n * 99 / 100)] : 0.0;
+}
+
+void server_free(Server* s) {
+    if (!s) return;
+    for (int i = 0; i < s->n_listen; i++) close(s->listen_fds[i]);
+    if (s->config.unix_path) unlink(s->config.unix_path);
+    if (s->wake_pipe[0] >= 0) {
+        close(s->wake_pipe[0]);
+        close(s->wake_pipe[1]);
+        pthread_cond_destroy(&s->cond);
+        pthread_mutex_destroy(&s->lock);
+        pthread_mutex_destroy(&s->stats_lock);
+    }
+    free(s->conns);
+    free(s);
+}
+
+int serve_connect_unix(const char* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int serve_connect_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)port);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static int request(int fd, uint32_t op, const void* payload, uint32_t bytes, void* out, uint32_t max_bytes) {
+    uint32_t header[2] = { op, bytes };
+    if (write_full(fd, header, sizeof(header)) < 0) return -1;
+    if (bytes > 0 && write_full(fd, payload, bytes) < 0) return -1;
+
+    if (read_full(fd, header, sizeof(header)) < 0) return -1;
+    if (header[0] != SERVE_STATUS_OK || header[1] > max_bytes) {
+        char discard[4096];
+        for (uint32_t left = header[1]; left > 0;) {
+            uint32_t n = left < sizeof(discard) ? left : (uint32_t)sizeof(discard);
+            if (read_full(fd, discard, n) < 0) return -1;
+            left -= n;
+        }
+        return -1;
+    }
+    if (header[1] > 0 && read_full(fd, out, header[1]) < 0) return -1;
+    return (int)header[1];
+}
+
+int serve_infer(int fd, const float* x, int n_x, float* y, int n_y) {
+    int bytes = request(fd, SERVE_OP_INFER, x, (uint32_t)(sizeof(float) * n_x), y, (uint32_t)(sizeof(float) * n_y));
+    return bytes < 0 ? -1 : bytes / (int)sizeof(float);
+}
+
+int serve_query_stats(int fd, ServerStats* stats) {
+    double values[7];
+    if (request(fd, SERVE_OP_STATS, NULL, 0, values, sizeof(values)) != (int)sizeof(values)) return -1;
+    stats->requests = values[0];
+    stats->batches = values[1];
+    stats->mean_batch = values[2];
+    stats->throughput = values[3];
+    stats->p50_us = values[4];
+    stats->p99_us = values[5];
+    stats->max_us = values[6];
+    return 0;
+}
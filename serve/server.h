@@ -0,0 +1,40 @@
+#ifndef CML_SERVER_H
+#define CML_SERVER_H
+#include "../nn/mlp.h"
+
+#define SERVE_OP_INFER 1u
+#define SERVE_OP_STATS 2u
+#define SERVE_STATUS_OK 0u
+#define SERVE_STATUS_ERROR 1u
+
+typedef struct ServerConfig ServerConfig;
+struct ServerConfig {
+    const char* unix_path;
+    int tcp_port;
+    int max_batch;
+    int max_latency_us;
+};
+
+typedef struct ServerStats ServerStats;
+struct ServerStats {
+    double requests;
+    double batches;
+    double mean_batch;
+    double throughput;
+    double p50_us;
+    double p99_us;
+    double max_us;
+};
+
+typedef struct Server Server;
+Server* server_create(MLP* model, const ServerConfig* config);
+int server_run(Server* server);
+void server_stop(Server* server);
+void server_get_stats(Server* server, ServerStats* stats);
+void server_free(Server* server);
+
+int serve_connect_unix(const char* path);
+int serve_connect_tcp(int port);
+int serve_infer(int fd, const float* x, int n_x, float* y, int n_y);
+int serve_query_stats(int fd, ServerStats* stats);
+#endif
@@ -1,73 +1,185 @@
 #include "tensor.h"
+#include "gemm.h"
+#include "small_matmul.h"
+#include "cpu.h"
+#include "../parallel/pool.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
 
 
-static void backward_add(Tensor* t) {
+void backward_add(Tensor* t) {
     Tensor* a = t->parents[0];
     Tensor* b = t->parents[1];
 
+    if (a->requires_grad) cpu_kernels()->axpy(a->grad, 1.0f, t->grad, a->size);
+    if (b->requires_grad) cpu_kernels()->axpy(b->grad, 1.0f, t->grad, b->size);
+}
+
+void backward_sub(Tensor* t) {
+    Tensor* a = t->parents[0];
+    Tensor* b = t->parents[1];
+
+    if (a->requires_grad) cpu_kernels()->axpy(a->grad, 1.0f, t->grad, a->size);
+    if (b->requires_grad) cpu_kernels()->axpy(b->grad, -1.0f, t->grad, b->size);
+}
+
+void backward_mul(Tensor* t) {
+    Tensor* a = t->parents[0];
+    Tensor* b = t->parents[1];
+    tensor_eval(a);
+    tensor_eval(b);
+
+    if (a->requires_grad) cpu_kernels()->mul_acc(a->grad, b->data, t->grad, a->size);
+    if (b->requires_grad) cpu_kernels()->mul_acc(b->grad, a->data, t->grad, b->size);
+}
+
+void backward_mul_scalar(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    cpu_kernels()->axpy(a->grad, *(float*)t->ctx, t->grad, a->size);
+}
+
+void backward_div_scalar(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    float scalar = *(float*)t->ctx;
+    for (int i = 0; i < a->size; i++)
+        a->grad[i] += t->grad[i] / scalar;
+}
+
+void backward_sum(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    for (int i = 0; i < a->size; i++)
+        a->grad[i] += t->grad[0]; 
+}
+
+void backward_sum_axis(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    int axis = (int)*(float*)t->ctx;
+    int rows = a->shape[0], cols = a->shape[1];
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            a->grad[i*cols + j] += t->grad[axis == 0 ? j : i];
+}
+
+void backward_matmul(Tensor* t) {
+    Tensor* a = t->parents[0];
+    Tensor* b = t->parents[1];
+
+    int m = a->shape[0];
+    int n = a->shape[1];
+    int p = b->shape[1];
+    const SmallMatmul* kernel = small_matmul_lookup(n, p);
+
+    if (a->requires_grad) {
+        if (kernel) small_matmul_grad_a(kernel, m, n, p, t->grad, b->data, a->grad);
+        else gemm(0, 1, m, n, p, 1.0f, t->grad, p, b->data, p, 1.0f, a->grad, n);
+    }
+
+    if (b->requires_grad) {
+        if (kernel) kernel->grad_b(m, a->data, t->grad, b->grad);
+        else gemm(1, 0, n, p, m, 1.0f, a->data, n, t->grad, p, 1.0f, b->grad, p);
+    }
+}
+
+void backward_exp(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    tensor_eval(t);
+    for (int i = 0; i < a->size; i++)
+        a->grad[i] += t->data[i] * t->grad[i];
+}
+
+void backward_log(Tensor* t) {
+    Tensor* a = t->parents[0];
+    if (!a->requires_grad) return;
+
+    tensor_eval(a);
+    for (int i = 0; i < a->size; i++)
+        a->grad[i] += t->grad[i] / a->data[i];
+}
+
+void backward_gather(Tensor* t) {
+    Tensor* a = t->parents[0];
+    Tensor* indices = t->parents[1];
+    if (!a->requires_grad) return;
+
+    int C = a->shape[1];
+    for (int i = 0; i < t->size; i++)
+        a->grad[i*C + (int)indices->data[i]] += t->grad[i];
+}
+
+void backward_add_broadcast(Tensor* t) {
+    Tensor* a = t->parents[0];
+    Tensor* b = t->parents[1];
+    int rows = a->shape[0], cols = a->shape[1];
+
     if (a->requires_grad) {
         for (int i = 0; i < a->size; i++)
             a->grad[i] += t->grad[i];
     }
 
     if (b->requires_grad) {
-        for (int i = 0; i < b->size; i++)
-            b->grad[i] += t->grad[i];
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                b->grad[j] += t->grad[i*cols + j];
     }
 }
 
-static void backward_mul(Tensor* t) {
+void backward_sub_broadcast(Tensor* t) {
     Tensor* a = t->parents[0];
     Tensor* b = t->parents[1];
+    int rows = a->shape[0], cols = a->shape[1];
 
     if (a->requires_grad) {
         for (int i = 0; i < a->size; i++)
-            a->grad[i] += b->data[i] * t->grad[i];
+            a->grad[i] += t->grad[i];
     }
 
     if (b->requires_grad) {
-        for (int i = 0; i < b->size; i++)
-            b->grad[i] += a->data[i] * t->grad[i];
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                b->grad[j] -= t->grad[i*cols + j];
     }
 }
 
-static void backward_sum(Tensor* t) {
+void backward_softmax(Tensor* t) {
     Tensor* a = t->parents[0];
     if (!a->requires_grad) return;
 
-    for (int i = 0; i < a->size; i++)
-        a->grad[i] += t->grad[0]; 
+    int N = t->shape[0], C = t->shape[1];
+    for (int i = 0; i < N; i++) {
+        float dot = 0.0f;
+        for (int j = 0; j < C; j++) dot += t->grad[i*C + j] * t->data[i*C + j];
+        for (int j = 0; j < C; j++)
+            a->grad[i*C + j] += t->data[i*C + j] * (t->grad[i*C + j] - dot);
+    }
 }
 
-static void backward_matmul(Tensor* t) {
+void backward_reshape(Tensor* t) {
     Tensor* a = t->parents[0];
-    Tensor* b = t->parents[1];
+    if (!a->requires_grad) return;
 
-    int m = a->shape[0];
-    int n = a->shape[1];
-    int p = b->shape[1];
+    for (int i = 0; i < a->size; i++)
+        a->grad[i] += t->grad[i];
+}
 
-    if (a->requires_grad) {
-        for (int i = 0; i < m; i++)
-            for (int j = 0; j < n; j++) {
-                float sum = 0.0f;
-                for (int k = 0; k < p; k++)
-                    sum += t->grad[i*p + k] * b->data[j*p + k];
-                a->grad[i*n + j] += sum;
-            }
-    }
+static void (*grad_hook)(Tensor* t, void* ctx) = NULL;
+static void* grad_hook_ctx = NULL;
 
-    if (b->requires_grad) {
-        for (int i = 0; i < n; i++)
-            for (int j = 0; j < p; j++) {
-                float sum = 0.0f;
-                for (int k = 0; k < m; k++)
-                    sum += a->data[k*n + i] * t->grad[k*p + j];
-                b->grad[i*p + j] += sum;
-            }
-    }
+void tensor_set_grad_hook(void (*hook)(Tensor* t, void* ctx), void* ctx) {
+    grad_hook = hook;
+    grad_hook_ctx = ctx;
 }
 
 typedef struct {
@@ -84,39 +196,404 @@ static void stack_push(TensorStack* stack, Tensor* t) {
     stack->nodes[stack->count++] = t;
 }
 
-static void build_topo(Tensor* t, TensorStack* stack, int* visited) {
-    if (!t || visited[(size_t)t]) return;
-    visited[(size_t)t] = 1;
+typedef struct {
+    Tensor** keys;
+    int count;
+    int capacity;
+} TensorSet;
+
+static size_t set_hash(Tensor* t, int capacity) {
+    return ((size_t)t >> 4) * 2654435761u & (size_t)(capacity - 1);
+}
+
+static int set_insert(TensorSet* set, Tensor* t) {
+    if (2 * (set->count + 1) > set->capacity) {
+        TensorSet grown = { NULL, 0, set->capacity ? set->capacity*2 : 64 };
+        grown.keys = (Tensor**)calloc(grown.capacity, sizeof(Tensor*));
+        for (int i = 0; i < set->capacity; i++)
+            if (set->keys[i]) set_insert(&grown, set->keys[i]);
+        free(set->keys);
+        *set = grown;
+    }
+    size_t h = set_hash(t, set->capacity);
+    while (set->keys[h]) {
+        if (set->keys[h] == t) return 0;
+        h = (h + 1) & (size_t)(set->capacity - 1);
+    }
+    set->keys[h] = t;
+    set->count++;
+    return 1;
+}
+
+static void build_topo(Tensor* t, TensorStack* stack, TensorSet* visited) {
+    if (!t || !set_insert(visited, t)) return;
     for (int i = 0; i < t->n_parents; i++)
         build_topo(t->parents[i], stack, visited);
     stack_push(stack, t);
 }
 
+typedef struct {
+    Tensor** keys;
+    int* values;
+    int capacity;
+} TensorIndex;
+
+static void index_init(TensorIndex* index, int count) {
+    index->capacity = 64;
+    while (index->capacity < 2 * count) index->capacity *= 2;
+    index->keys = (Tensor**)calloc(index->capacity, sizeof(Tensor*));
+    index->values = (int*)malloc(sizeof(int) * index->capacity);
+}
+
+static void index_put(TensorIndex* index, Tensor* t, int value) {
+    size_t h = set_hash(t, index->capacity);
+    while (index->keys[h] && index->keys[h] != t) h = (h + 1) & (size_t)(index->capacity - 1);
+    index->keys[h] = t;
+    index->values[h] = value;
+}
+
+static int index_get(const TensorIndex* index, Tensor* t) {
+    size_t h = set_hash(t, index->capacity);
+    while (index->keys[h] != t) h = (h + 1) & (size_t)(index->capacity - 1);
+    return index->values[h];
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    int* items;
+    int top;
+    int bottom;
+} ReadyQueue;
+
+typedef struct {
+    int node;
+    int parent;
+    Tensor* shadow;
+} GradSlot;
+
+typedef struct {
+    Tensor** nodes;
+    int* deps;
+    int* succ_start;
+    int* succ;
+    GradSlot* slots;
+    int* node_slots_start;
+    int* node_slots;
+    int* parent_slots_start;
+    int* parent_slots;
+    ReadyQueue* queues;
+    int n_workers;
+    int remaining;
+    int ready;
+    pthread_mutex_t hook_lock;
+    pthread_mutex_t wait_lock;
+    pthread_cond_t wake;
+} BackwardPlan;
+
+static int parallel_backward_mode = -1;
+
+void tensor_set_parallel_backward(int mode) {
+    parallel_backward_mode = mode < 0 ? 2 : mode != 0;
+}
+
+static int parallel_backward_setting(void) {
+    if (parallel_backward_mode < 0) {
+        const char* env = getenv("CML_PARALLEL_BACKWARD");
+        parallel_backward_mode = env && *env ? atoi(env) != 0 : 2;
+    }
+    return parallel_backward_mode;
+}
+
+static void run_node(Tensor* t, pthread_mutex_t* hook_lock) {
+    if (!t->grad) {
+        t->grad = (float*)calloc(t->size, sizeof(float));
+        t->owns_grad = 1;
+    }
+
+    if (t->backward) t->backward(t);
+    if (grad_hook) {
+        if (hook_lock) pthread_mutex_lock(hook_lock);
+        grad_hook(t, grad_hook_ctx);
+        if (hook_lock) pthread_mutex_unlock(hook_lock);
+    }
+}
+
+static void run_planned_node(BackwardPlan* plan, int node) {
+    Tensor* t = plan->nodes[node];
+    for (int k = plan->parent_slots_start[node]; k < plan->parent_slots_start[node + 1]; k++) {
+        GradSlot* slot = &plan->slots[plan->parent_slots[k]];
+        for (int i = 0; i < t->size; i++) t->grad[i] += slot->shadow->grad[i];
+        free(slot->shadow->grad);
+        slot->shadow->grad = NULL;
+    }
+
+    int first = plan->node_slots_start[node], last = plan->node_slots_start[node + 1];
+    for (int k = first; k < last; k++) {
+        GradSlot* slot = &plan->slots[plan->node_slots[k]];
+        slot->shadow->grad = (float*)calloc(slot->shadow->size, sizeof(float));
+        for (int j = 0; j < t->n_parents; j++)
+            if (t->parents[j] == plan->nodes[slot->parent]) t->parents[j] = slot->shadow;
+    }
+
+    run_node(t, &plan->hook_lock);
+
+    for (int k = first; k < last; k++) {
+        GradSlot* slot = &plan->slots[plan->node_slots[k]];
+        for (int j = 0; j < t->n_parents; j++)
+            if (t->parents[j] == slot->shadow) t->parents[j] = plan->nodes[slot->parent];
+    }
+}
+
+static void queue_push(ReadyQueue* q, int node) {
+    pthread_mutex_lock(&q->lock);
+    q->items[q->bottom++] = node;
+    pthread_mutex_unlock(&q->lock);
+}
+
+static int queue_take(ReadyQueue* q, int steal) {
+    int node = -1;
+    pthread_mutex_lock(&q->lock);
+    if (q->top < q->bottom) node = steal ? q->items[q->top++] : q->items[--q->bottom];
+    if (q->top == q->bottom) q->top = q->bottom = 0;
+    pthread_mutex_unlock(&q->lock);
+    return node;
+}
+
+static void plan_push(BackwardPlan* plan, int queue, int node) {
+    queue_push(&plan->queues[queue], node);
+    pthread_mutex_lock(&plan->wait_lock);
+    __atomic_add_fetch(&plan->ready, 1, __ATOMIC_ACQ_REL);
+    pthread_cond_signal(&plan->wake);
+    pthread_mutex_unlock(&plan->wait_lock);
+}
+
+static void plan_wait(BackwardPlan* plan) {
+    pthread_mutex_lock(&plan->wait_lock);
+    while (__atomic_load_n(&plan->ready, __ATOMIC_ACQUIRE) <= 0 &&
+           __atomic_load_n(&plan->remaining, __ATOMIC_ACQUIRE) > 0)
+        pthread_cond_wait(&plan->wake, &plan->wait_lock);
+    pthread_mutex_unlock(&plan->wait_lock);
+}
+
+static void backward_worker(int begin, int end, void* arg) {
+    BackwardPlan* plan = (BackwardPlan*)arg;
+    (void)end;
+    int self = begin % plan->n_workers;
+
+    while (__atomic_load_n(&plan->remaining, __ATOMIC_ACQUIRE) > 0) {
+        int node = queue_take(&plan->queues[self], 0);
+        for (int v = 1; node < 0 && v < plan->n_workers; v++)
+            node = queue_take(&plan->queues[(self + v) % plan->n_workers], 1);
+        if (node < 0) {
+            plan_wait(plan);
+            continue;
+        }
+        __atomic_sub_fetch(&plan->ready, 1, __ATOMIC_ACQ_REL);
+
+        run_planned_node(plan, node);
+        for (int e = plan->succ_start[node]; e < plan->succ_start[node + 1]; e++)
+            if (__atomic_sub_fetch(&plan->deps[plan->succ[e]], 1, __ATOMIC_ACQ_REL) == 0)
+                plan_push(plan, self, plan->succ[e]);
+        if (__atomic_sub_fetch(&plan->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+            pthread_mutex_lock(&plan->wait_lock);
+            pthread_cond_broadcast(&plan->wake);
+            pthread_mutex_unlock(&plan->wait_lock);
+        }
+    }
+}
+
+static int parents_before(Tensor* t, int j) {
+    for (int k = 0; k < j; k++)
+        if (t->parents[k] == t->parents[j]) return 1;
+    return 0;
+}
+
+static int* bucket_by(const int* keys, int n, int n_keys, int** start_out) {
+    int* start = (int*)calloc(n_keys + 1, sizeof(int));
+    int* items = (int*)malloc(sizeof(int) * (n + 1));
+    for (int i = 0; i < n; i++) start[keys[i] + 1]++;
+    for (int k = 0; k < n_keys; k++) start[k + 1] += start[k];
+    int* fill = (int*)malloc(sizeof(int) * (n_keys + 1));
+    memcpy(fill, start, sizeof(int) * (n_keys + 1));
+    for (int i = 0; i < n; i++) items[fill[keys[i]]++] = i;
+    free(fill);
+    *start_out = start;
+    return items;
+}
+
+static void plan_free(BackwardPlan* plan, int n_slots) {
+    for (int k = 0; k < n_slots; k++) free(plan->slots[k].shadow);
+    free(plan->deps);
+    free(plan->succ_start);
+    free(plan->succ);
+    free(plan->slots);
+    free(plan->node_slots_start);
+    free(plan->node_slots);
+    free(plan->parent_slots_start);
+    free(plan->parent_slots);
+}
+
+static int run_parallel_backward(TensorStack* stack, int n_workers, int force) {
+    int count = stack->count;
+    if (count < 3) return 0;
+    TensorIndex index;
+    index_init(&index, count);
+    int n_edges = 0;
+    for (int i = 0; i < count; i++) {
+        index_put(&index, stack->nodes[i], i);
+        n_edges += stack->nodes[i]->n_parents;
+    }
+
+    BackwardPlan plan = {0};
+    plan.nodes = stack->nodes;
+    int* from = (int*)malloc(sizeof(int) * (n_edges + count));
+    int* to = (int*)malloc(sizeof(int) * (n_edges + count));
+    int* slot_node = (int*)malloc(sizeof(int) * (n_edges + 1));
+    int* slot_parent = (int*)malloc(sizeof(int) * (n_edges + 1));
+    char* consumed = (char*)calloc(count, 1);
+    int n_slots = 0;
+    n_edges = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        Tensor* t = stack->nodes[i];
+        for (int j = 0; j < t->n_parents; j++) {
+            if (parents_before(t, j)) continue;
+            int p = index_get(&index, t->parents[j]);
+            from[n_edges] = i;
+            to[n_edges++] = p;
+            if (!t->parents[j]->requires_grad) continue;
+            if (consumed[p]) {
+                slot_node[n_slots] = i;
+                slot_parent[n_slots++] = p;
+            }
+            consumed[p] = 1;
+        }
+    }
+    free(consumed);
+    for (int i = count - 1, prev = -1; i >= 0; i--) {
+        if (!stack->nodes[i]->serial_backward) continue;
+        if (prev >= 0) {
+            from[n_edges] = prev;
+            to[n_edges++] = i;
+        }
+        prev = i;
+    }
+    free(index.keys);
+    free(index.values);
+
+    plan.deps = (int*)calloc(count, sizeof(int));
+    for (int e = 0; e < n_edges; e++) plan.deps[to[e]]++;
+    int* succ_index = bucket_by(from, n_edges, count, &plan.succ_start);
+    plan.succ = (int*)malloc(sizeof(int) * (n_edges + 1));
+    for (int e = 0; e < n_edges; e++) plan.succ[e] = to[succ_index[e]];
+    free(succ_index);
+    free(from);
+    free(to);
+
+    plan.slots = (GradSlot*)malloc(sizeof(GradSlot) * (n_slots + 1));
+    for (int k = 0; k < n_slots; k++) {
+        plan.slots[k].node = slot_node[k];
+        plan.slots[k].parent = slot_parent[k];
+        plan.slots[k].shadow = NULL;
+    }
+    plan.node_slots = bucket_by(slot_node, n_slots, count, &plan.node_slots_start);
+    plan.parent_slots = bucket_by(slot_parent, n_slots, count, &plan.parent_slots_start);
+    free(slot_node);
+    free(slot_parent);
+
+    int work = 0, critical = 0;
+    int* depth = (int*)calloc(count, sizeof(int));
+    for (int i = count - 1; i >= 0; i--) {
+        int d = depth[i] + (stack->nodes[i]->backward != NULL);
+        work += stack->nodes[i]->backward != NULL;
+        if (d > critical) critical = d;
+        for (int e = plan.succ_start[i]; e < plan.succ_start[i + 1]; e++)
+            if (depth[plan.succ[e]] < d) depth[plan.succ[e]] = d;
+    }
+    free(depth);
+
+    if (!force && work < 2 * critical) {
+        plan_free(&plan, n_slots);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++)
+        if (stack->nodes[i]->lazy) tensor_eval(stack->nodes[i]);
+    for (int k = 0; k < n_slots; k++) {
+        Tensor* shadow = (Tensor*)malloc(sizeof(Tensor));
+        memcpy(shadow, stack->nodes[plan.slots[k].parent], sizeof(Tensor));
+        shadow->grad = NULL;
+        shadow->owns_grad = 0;
+        shadow->refcount = 1;
+        plan.slots[k].shadow = shadow;
+    }
+
+    plan.n_workers = n_workers;
+    plan.remaining = count;
+    pthread_mutex_init(&plan.hook_lock, NULL);
+    pthread_mutex_init(&plan.wait_lock, NULL);
+    pthread_cond_init(&plan.wake, NULL);
+    plan.queues = (ReadyQueue*)malloc(sizeof(ReadyQueue) * n_workers);
+    for (int w = 0; w < n_workers; w++) {
+        pthread_mutex_init(&plan.queues[w].lock, NULL);
+        plan.queues[w].items = (int*)malloc(sizeof(int) * count);
+        plan.queues[w].top = plan.queues[w].bottom = 0;
+    }
+    for (int i = count - 1; i >= 0; i--)
+        if (plan.deps[i] == 0) plan_push(&plan, 0, i);
+
+    parallel_for(n_workers, 1, backward_worker, &plan);
+
+    for (int w = 0; w < n_workers; w++) {
+        pthread_mutex_destroy(&plan.queues[w].lock);
+        free(plan.queues[w].items);
+    }
+    free(plan.queues);
+    pthread_mutex_destroy(&plan.hook_lock);
+    pthread_mutex_destroy(&plan.wait_lock);
+    pthread_cond_destroy(&plan.wake);
+    plan_free(&plan, n_slots);
+    return 1;
+}
+
+static void run_backward(Tensor* root) {
+    TensorStack stack = {0};
+    TensorSet visited = {0};
+    build_topo(root, &stack, &visited);
+    free(visited.keys);
+
+    int mode = parallel_backward_setting();
+    if (mode && run_parallel_backward(&stack, pool_num_threads(), mode == 1)) {
+        free(stack.nodes);
+        return;
+    }
+
+    for (int i = stack.count - 1; i >= 0; i--)
+        run_node(stack.nodes[i], NULL);
+
+    free(stack.nodes);
+}
+
 void tensor_backward(Tensor* loss) {
     if (!loss) return;
 
     if (!loss->grad) {
-        loss->grad = (float*)calloc(loss->size, sizeof(float));
-        for (int i = 0; i < loss->size; i++)
-            loss->grad[i] = 1.0f; 
+        loss->grad = (float*)malloc(sizeof(float) * loss->size);
+        loss->owns_grad = 1;
     }
+    for (int i = 0; i < loss->size; i++)
+        loss->grad[i] = 1.0f;
 
-    TensorStack stack = {0};
-    int* visited = (int*)calloc(1024, sizeof(int));
-    build_topo(loss, &stack, visited);
-    free(visited);
-
-    for (int i = stack.count - 1; i >= 0; i--) {
-        Tensor* t = stack.nodes[i];
-        if (!t->grad) t->grad = (float*)calloc(t->size, sizeof(float));
-
-        if (t->backward) t->backward(t);
-        else {
-            if (t->n_parents == 2) backward_add(t);
-            else if (t->n_parents == 1 && t->ndim == 0) backward_sum(t);
-            else if (t->n_parents == 1) backward_matmul(t);
-        }
+    run_backward(loss);
+}
+
+void tensor_backward_with_grad(Tensor* t, const float* grad) {
+    if (!t) return;
+
+    if (!t->grad) {
+        t->grad = (float*)malloc(sizeof(float) * t->size);
+        t->owns_grad = 1;
     }
+    memcpy(t->grad, grad, sizeof(float) * t->size);
 
-    free(stack.nodes);
-}
\ No newline at end of file
+    run_backward(t);
+}
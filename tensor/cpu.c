@@ -0,0 +1,227 @@
+#include "cpu.h"
+#include "gemm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <pthread.h>
+
+#define CPU_BLOCK 64
+
+#define INLINE static inline __attribute__((always_inline))
+#define PRAGMA(x) _Pragma(#x)
+#define UNROLL(n) PRAGMA(GCC unroll n)
+
+typedef float Vec4 __attribute__((vector_size(4 * sizeof(float)), aligned(sizeof(float))));
+typedef float Vec8 __attribute__((vector_size(8 * sizeof(float)), aligned(sizeof(float))));
+typedef float Vec16 __attribute__((vector_size(16 * sizeof(float)), aligned(sizeof(float))));
+
+#define GEMM_MICRO_BODY(W)                                                                             \
+    INLINE void gemm_micro_w##W(int kc, const float* restrict a, const float* restrict b,             \
+                                float* restrict c, int ldc, int mr, int nr) {                          \
+        Vec##W acc[GEMM_MR][GEMM_NR / W];                                                              \
+        float edge[GEMM_MR][GEMM_NR];                                                                  \
+        int full = mr == GEMM_MR && nr == GEMM_NR;                                                     \
+        if (!full)                                                                                     \
+            for (int i = 0; i < GEMM_MR; i++)                                                          \
+                for (int j = 0; j < GEMM_NR; j++)                                                      \
+                    edge[i][j] = (i < mr && j < nr) ? c[i*ldc + j] : 0.0f;                             \
+        UNROLL(GEMM_MR)                                                                                \
+        for (int i = 0; i < GEMM_MR; i++) {                                                            \
+            UNROLL(GEMM_NR / W)                                                                        \
+            for (int v = 0; v < GEMM_NR / W; v++)                                                      \
+                acc[i][v] = *(const Vec##W*)(full ? c + i*ldc + v*W : &edge[i][v*W]);                  \
+        }                                                                                              \
+                                                                                                       \
+        for (int k = 0; k < kc; k++) {                                                                 \
+            const float* ak = a + k*GEMM_MR;                                                           \
+            Vec##W bk[GEMM_NR / W];                                                                    \
+            UNROLL(GEMM_NR / W)                                                                        \
+            for (int v = 0; v < GEMM_NR / W; v++) bk[v] = *(const Vec##W*)(b + k*GEMM_NR + v*W);      \
+            UNROLL(GEMM_MR)                                                                            \
+            for (int i = 0; i < GEMM_MR; i++) {                                                        \
+                UNROLL(GEMM_NR / W)                                                                    \
+                for (int v = 0; v < GEMM_NR / W; v++) acc[i][v] += ak[i] * bk[v];                      \
+            }                                                                                          \
+        }                                                                                              \
+                                                                                                       \
+        UNROLL(GEMM_MR)                                                                                \
+        for (int i = 0; i < GEMM_MR; i++) {                                                            \
+            UNROLL(GEMM_NR / W)                                                                        \
+            for (int v = 0; v < GEMM_NR / W; v++)                                                      \
+                *(Vec##W*)(full ? c + i*ldc + v*W : &edge[i][v*W]) = acc[i][v];                        \
+        }                                                                                              \
+        if (!full)                                                                                     \
+            for (int i = 0; i < mr; i++)                                                               \
+                for (int j = 0; j < nr; j++) c[i*ldc + j] = edge[i][j];                                \
+    }
+
+GEMM_MICRO_BODY(4)
+GEMM_MICRO_BODY(8)
+GEMM_MICRO_BODY(16)
+
+INLINE void map_block(LazyOp op, float scalar, float* restrict d, const float* restrict x,
+                      const float* restrict y, int len) {
+    switch (op) {
+        case LAZY_ADD:
+        case LAZY_ADD_ROW:    for (int i = 0; i < len; i++) d[i] = x[i] + y[i]; break;
+        case LAZY_SUB:
+        case LAZY_SUB_ROW:    for (int i = 0; i < len; i++) d[i] = x[i] - y[i]; break;
+        case LAZY_MUL:        for (int i = 0; i < len; i++) d[i] = x[i] * y[i]; break;
+        case LAZY_MUL_SCALAR: for (int i = 0; i < len; i++) d[i] = x[i] * scalar; break;
+        case LAZY_DIV_SCALAR: for (int i = 0; i < len; i++) d[i] = x[i] / scalar; break;
+        case LAZY_EXP:        for (int i = 0; i < len; i++) d[i] = expf(x[i]); break;
+        case LAZY_LOG:        for (int i = 0; i < len; i++) d[i] = logf(x[i]); break;
+        case LAZY_RELU:       for (int i = 0; i < len; i++) d[i] = x[i] > 0.0f ? x[i] : 0.0f; break;
+        case LAZY_SIGMOID:    for (int i = 0; i < len; i++) d[i] = 1.0f / (1.0f + expf(-x[i])); break;
+        case LAZY_TANH:       for (int i = 0; i < len; i++) d[i] = tanhf(x[i]); break;
+        case LAZY_SUM:        break;
+    }
+}
+
+INLINE void map_body(LazyOp op, float scalar, float* d, const float* x, const float* y, int n) {
+    int i = 0;
+    for (; i + CPU_BLOCK <= n; i += CPU_BLOCK)
+        map_block(op, scalar, d + i, x + i, y ? y + i : NULL, CPU_BLOCK);
+    if (i < n) map_block(op, scalar, d + i, x + i, y ? y + i : NULL, n - i);
+}
+
+INLINE void sum_lanes_body(float* restrict acc, const float* restrict x, int n) {
+    float lane[CPU_SUM_LANES];
+    for (int l = 0; l < CPU_SUM_LANES; l++) lane[l] = acc[l];
+    int i = 0;
+    for (; i + CPU_SUM_LANES <= n; i += CPU_SUM_LANES)
+        for (int l = 0; l < CPU_SUM_LANES; l++) lane[l] += x[i + l];
+    for (; i < n; i++) lane[i % CPU_SUM_LANES] += x[i];
+    for (int l = 0; l < CPU_SUM_LANES; l++) acc[l] = lane[l];
+}
+
+INLINE void axpy_block(float* restrict y, float alpha, const float* restrict x, int len) {
+    for (int i = 0; i < len; i++) y[i] += alpha * x[i];
+}
+
+INLINE void axpy_body(float* y, float alpha, const float* x, int n) {
+    int i = 0;
+    for (; i + CPU_BLOCK <= n; i += CPU_BLOCK) axpy_block(y + i, alpha, x + i, CPU_BLOCK);
+    if (i < n) axpy_block(y + i, alpha, x + i, n - i);
+}
+
+INLINE void mul_acc_block(float* restrict y, const float* restrict x, const float* restrict z, int len) {
+    for (int i = 0; i < len; i++) y[i] += x[i] * z[i];
+}
+
+INLINE void mul_acc_body(float* y, const float* x, const float* z, int n) {
+    int i = 0;
+    for (; i + CPU_BLOCK <= n; i += CPU_BLOCK) mul_acc_block(y + i, x + i, z + i, CPU_BLOCK);
+    if (i < n) mul_acc_block(y + i, x + i, z + i, n - i);
+}
+
+#define CPU_VARIANT(name, width, target)                                                      \
+    target static void gemm_micro_##name(int kc, const float* a, const float* b, float* c,    \
+                                         int ldc, int mr, int nr) {                           \
+        gemm_micro_w##width(kc, a, b, c, ldc, mr, nr);                                        \
+    }                                                                                         \
+    target static void map_##name(LazyOp op, float scalar, float* d, const float* x,          \
+                                  const float* y, int n) {                                    \
+        map_body(op, scalar, d, x, y, n);                                                     \
+    }                                                                                         \
+    target static void sum_lanes_##name(float* acc, const float* x, int n) {                  \
+        sum_lanes_body(acc, x, n);                                                            \
+    }                                                                                         \
+    target static void axpy_##name(float* y, float alpha, const float* x, int n) {            \
+        axpy_body(y, alpha, x, n);                                                            \
+    }                                                                                         \
+    target static void mul_acc_##name(float* y, const float* x, const float* z, int n) {      \
+        mul_acc_body(y, x, z, n);                                                             \
+    }
+
+CPU_VARIANT(generic, 4, )
+CPU_VARIANT(avx2, 8, TARGET_AVX2)
+CPU_VARIANT(avx512, 16, TARGET_AVX512)
+
+static const CpuKernels tables[CPU_LEVELS] = {
+    { CPU_GENERIC, gemm_micro_generic, map_generic, sum_lanes_generic, axpy_generic, mul_acc_generic },
+    { CPU_AVX2, gemm_micro_avx2, map_avx2, sum_lanes_avx2, axpy_avx2, mul_acc_avx2 },
+    { CPU_AVX512, gemm_micro_avx512, map_avx512, sum_lanes_avx512, axpy_avx512, mul_acc_avx512 },
+};
+
+static const char* level_names[CPU_LEVELS] = { "generic", "avx2", "avx512" };
+
+static struct {
+    pthread_once_t once;
+    CpuLevel detected;
+    const CpuKernels* active;
+} cpu = { PTHREAD_ONCE_INIT, CPU_GENERIC, &tables[CPU_GENERIC] };
+
+CpuLevel cpu_detect(void) {
+#if CPU_X86
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq"))
+        return CPU_AVX512;
+    if (avx2) return CPU_AVX2;
+#endif
+    return CPU_GENERIC;
+}
+
+static int parse_level(const char* s) {
+    for (int i = 0; i < CPU_LEVELS; i++)
+        if (!strcasecmp(s, level_names[i])) return i;
+    char* end;
+    long v = strtol(s, &end, 10);
+    if (*s && !*end && v >= 0 && v < CPU_LEVELS) return (int)v;
+    return -1;
+}
+
+static void cpu_init(void) {
+    cpu.detected = cpu_detect();
+    CpuLevel level = cpu.detected;
+    const char* env = getenv("CML_CPU_LEVEL");
+    if (env && *env) {
+        int want = parse_level(env);
+        if (want < 0)
+            fprintf(stderr, "cpu: unknown CML_CPU_LEVEL '%s', using %s\n", env, level_names[level]);
+        else if (want > (int)cpu.detected)
+            fprintf(stderr, "cpu: CML_CPU_LEVEL=%s not supported by this CPU, using %s\n", env, level_names[level]);
+        else
+            level = (CpuLevel)want;
+    }
+    __atomic_store_n(&cpu.active, &tables[level], __ATOMIC_RELEASE);
+}
+
+const CpuKernels* cpu_kernels(void) {
+    pthread_once(&cpu.once, cpu_init);
+    return __atomic_load_n(&cpu.active, __ATOMIC_ACQUIRE);
+}
+
+CpuLevel cpu_level(void) {
+    return cpu_kernels()->level;
+}
+
+CpuLevel cpu_set_level(CpuLevel level) {
+    pthread_once(&cpu.once, cpu_init);
+    if ((int)level < 0) level = CPU_GENERIC;
+    if (level > cpu.detected) level = cpu.detected;
+    __atomic_store_n(&cpu.active, &tables[level], __ATOMIC_RELEASE);
+    return level;
+}
+
+const char* cpu_level_name(CpuLevel level) {
+    return level >= 0 && level < CPU_LEVELS ? level_names[level] : "unknown";
+}
+
+float cpu_lanes_total(const float* acc) {
+    float lane[CPU_SUM_LANES];
+    memcpy(lane, acc, sizeof(lane));
+    for (int w = CPU_SUM_LANES / 2; w > 0; w /= 2)
+        for (int l = 0; l < w; l++) lane[l] += lane[l + w];
+    return lane[0];
+}
+
+float cpu_sum(const float* x, int n) {
+    float acc[CPU_SUM_LANES] = { 0 };
+    cpu_kernels()->sum_lanes(acc, x, n);
+    return cpu_lanes_total(acc);
+}
@@ -0,0 +1,41 @@
+#ifndef CML_CPU_H
+#define CML_CPU_H
+#include "lazy.h"
+
+typedef enum {
+    CPU_GENERIC,
+    CPU_AVX2,
+    CPU_AVX512,
+    CPU_LEVELS
+} CpuLevel;
+
+#define CPU_SUM_LANES 16
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq,avx2,fma,prefer-vector-width=512")))
+#else
+#define CPU_X86 0
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+typedef struct CpuKernels CpuKernels;
+struct CpuKernels {
+    CpuLevel level;
+    void (*gemm_micro)(int kc, const float* a, const float* b, float* c, int ldc, int mr, int nr);
+    void (*map)(LazyOp op, float scalar, float* d, const float* x, const float* y, int n);
+    void (*sum_lanes)(float* acc, const float* x, int n);
+    void (*axpy)(float* y, float alpha, const float* x, int n);
+    void (*mul_acc)(float* y, const float* x, const float* z, int n);
+};
+
+CpuLevel cpu_detect(void);
+CpuLevel cpu_level(void);
+CpuLevel cpu_set_level(CpuLevel level);
+const char* cpu_level_name(CpuLevel level);
+const CpuKernels* cpu_kernels(void);
+float cpu_lanes_total(const float* acc);
+float cpu_sum(const float* x, int n);
+#endif
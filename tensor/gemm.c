@@ -0,0 +1,126 @@
+#include "gemm.h"
+#include "cpu.h"
+#include <stdlib.h>
+#include <string.h>
+#include "../parallel/pool.h"
+
+#define MR GEMM_MR
+#define NR GEMM_NR
+#define MC 64
+#define KC 256
+#define NC 1024
+
+typedef struct {
+    int trans_a;
+    int M;
+    int K;
+    int kc;
+    int pc;
+    int nc;
+    int jc;
+    float alpha;
+    const float* A;
+    int lda;
+    const float* Bp;
+    float* C;
+    int ldc;
+} MacroContext;
+
+static float* aligned_buffer(size_t n) {
+    size_t bytes = (sizeof(float) * n + 63) & ~(size_t)63;
+    return (float*)aligned_alloc(64, bytes);
+}
+
+static void pack_a(int trans_a, const float* A, int lda, int i0, int mc, int p0, int kc, float alpha, float* Ap) {
+    for (int ir = 0; ir < mc; ir += MR) {
+        int mr = mc - ir < MR ? mc - ir : MR;
+        for (int k = 0; k < kc; k++) {
+            for (int i = 0; i < MR; i++) {
+                float v = 0.0f;
+                if (i < mr) {
+                    int row = i0 + ir + i, col = p0 + k;
+                    v = trans_a ? A[(size_t)col * lda + row] : A[(size_t)row * lda + col];
+                    if (alpha != 1.0f) v *= alpha;
+                }
+                *Ap++ = v;
+            }
+        }
+    }
+}
+
+static void pack_b(int trans_b, const float* B, int ldb, int p0, int kc, int j0, int nc, float* Bp) {
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = nc - jr < NR ? nc - jr : NR;
+        for (int k = 0; k < kc; k++) {
+            int row = p0 + k;
+            if (!trans_b && nr == NR) {
+                memcpy(Bp, B + (size_t)row * ldb + j0 + jr, sizeof(float) * NR);
+                Bp += NR;
+                continue;
+            }
+            for (int j = 0; j < NR; j++) {
+                float v = 0.0f;
+                if (j < nr) {
+                    int col = j0 + jr + j;
+                    v = trans_b ? B[(size_t)col * ldb + row] : B[(size_t)row * ldb + col];
+                }
+                *Bp++ = v;
+            }
+        }
+    }
+}
+
+static void macro_task(int begin, int end, void* arg) {
+    MacroContext* ctx = (MacroContext*)arg;
+    const CpuKernels* kernels = cpu_kernels();
+    float* Ap = aligned_buffer((size_t)MC * KC);
+
+    for (int block = begin; block < end; block++) {
+        int ic = block * MC;
+        int mc = ctx->M - ic < MC ? ctx->M - ic : MC;
+        pack_a(ctx->trans_a, ctx->A, ctx->lda, ic, mc, ctx->pc, ctx->kc, ctx->alpha, Ap);
+
+        for (int jr = 0; jr < ctx->nc; jr += NR) {
+            int nr = ctx->nc - jr < NR ? ctx->nc - jr : NR;
+            const float* b = ctx->Bp + (size_t)jr * ctx->kc;
+            for (int ir = 0; ir < mc; ir += MR) {
+                int mr = mc - ir < MR ? mc - ir : MR;
+                float* c = ctx->C + (size_t)(ic + ir) * ctx->ldc + ctx->jc + jr;
+                kernels->gemm_micro(ctx->kc, Ap + (size_t)ir * ctx->kc, b, c, ctx->ldc, mr, nr);
+            }
+        }
+    }
+
+    free(Ap);
+}
+
+void gemm(int trans_a, int trans_b, int M, int N, int K,
+          float alpha, const float* A, int lda, const float* B, int ldb,
+          float beta, float* C, int ldc) {
+    if (M <= 0 || N <= 0) return;
+
+    for (int i = 0; i < M; i++) {
+        float* row = C + (size_t)i * ldc;
+        if (beta == 0.0f) memset(row, 0, sizeof(float) * N);
+        else if (beta != 1.0f) for (int j = 0; j < N; j++) row[j] *= beta;
+    }
+    if (K <= 0 || alpha == 0.0f) return;
+
+    float* Bp = aligned_buffer((size_t)KC * (NC + NR));
+    int m_blocks = (M + MC - 1) / MC;
+    long work = (long)M * N * K;
+
+    for (int jc = 0; jc < N; jc += NC) {
+        int nc = N - jc < NC ? N - jc : NC;
+        for (int pc = 0; pc < K; pc += KC) {
+            int kc = K - pc < KC ? K - pc : KC;
+            pack_b(trans_b, B, ldb, pc, kc, jc, nc, Bp);
+
+            MacroContext ctx = { trans_a, M, K, kc, pc, nc, jc, alpha, A, lda, Bp, C, ldc };
+            if (work < (1L << 18)) macro_task(0, m_blocks, &ctx);
+            else parallel_for(m_blocks, 1, macro_task, &ctx);
+        }
+    }
+
+    free(Bp);
+}
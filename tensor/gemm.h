@@ -0,0 +1,8 @@
+#ifndef CML_GEMM_H
+#define CML_GEMM_H
+#define GEMM_MR 4
+#define GEMM_NR 16
+void gemm(int trans_a, int trans_b, int M, int N, int K,
+          float alpha, const float* A, int lda, const float* B, int ldb,
+          float beta, float* C, int ldc);
+#endif
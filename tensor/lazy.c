@@ -0,0 +1,186 @@
+#include "lazy.h"
+#include "cpu.h"
+#include <stdlib.h>
+#include "../parallel/pool.h"
+
+#define LAZY_TILE 256
+#define LAZY_MAX_SLOTS 32
+#define LAZY_PARALLEL_MIN (1 << 16)
+
+typedef struct {
+    Tensor* node;
+    int leaf;
+    const float* src;
+    int row;
+    LazyOp op;
+    float scalar;
+    int a;
+    int b;
+} Slot;
+
+typedef struct {
+    Slot slots[LAZY_MAX_SLOTS];
+    int n;
+    float* out;
+} Program;
+
+static int lazy_mode = -1;
+static __thread int lazy_depth = 0;
+
+int lazy_enabled(void) {
+    if (lazy_mode < 0) {
+        const char* env = getenv("CML_LAZY");
+        lazy_mode = env && atoi(env) > 0;
+    }
+    return lazy_mode;
+}
+
+void tensor_set_lazy(int enabled) {
+    lazy_mode = enabled != 0;
+}
+
+void lazy_begin(void) {
+    lazy_depth++;
+}
+
+void lazy_end(void) {
+    lazy_depth--;
+}
+
+Tensor* lazy_defer(LazyOp op, Tensor* a, Tensor* b, float scalar) {
+    if (!lazy_depth || !lazy_enabled()) {
+        tensor_eval(a);
+        if (b) tensor_eval(b);
+        return NULL;
+    }
+
+    int requires_grad = a->requires_grad || (b && b->requires_grad);
+    Tensor* out = op == LAZY_SUM ? tensor_create(0, NULL, requires_grad)
+                                 : tensor_create(a->ndim, a->shape, requires_grad);
+
+    struct LazyExpr* e = (struct LazyExpr*)malloc(sizeof(struct LazyExpr));
+    e->data = out->data;
+    e->op = op;
+    e->scalar = scalar;
+    e->inputs[0] = a;
+    e->inputs[1] = b;
+    tensor_retain(a);
+    tensor_retain(b);
+    out->lazy = e;
+    return out;
+}
+
+void lazy_free(struct LazyExpr* e) {
+    tensor_release(e->inputs[0]);
+    tensor_release(e->inputs[1]);
+    free(e);
+}
+
+static int emit(Program* p, Tensor* t, int row, int reserve) {
+    for (int i = 0; i < p->n; i++)
+        if (p->slots[i].node == t && p->slots[i].row == row) return i;
+
+    struct LazyExpr* e = t->lazy;
+    int n_inputs = e && e->inputs[1] ? 2 : 1;
+    if (!e || row || e->op == LAZY_SUM || p->n + 1 + n_inputs + reserve > LAZY_MAX_SLOTS) {
+        Slot* s = &p->slots[p->n];
+        s->node = t;
+        s->leaf = 1;
+        s->src = tensor_eval(t);
+        s->row = row;
+        return p->n++;
+    }
+
+    int is_row = e->op == LAZY_ADD_ROW || e->op == LAZY_SUB_ROW;
+    int a = emit(p, e->inputs[0], 0, reserve + n_inputs);
+    int b = n_inputs == 2 ? emit(p, e->inputs[1], is_row ? e->inputs[1]->size : 0, reserve + 1) : -1;
+
+    Slot* s = &p->slots[p->n];
+    s->node = t;
+    s->leaf = 0;
+    s->src = NULL;
+    s->row = 0;
+    s->op = e->op;
+    s->scalar = e->scalar;
+    s->a = a;
+    s->b = b;
+    return p->n++;
+}
+
+static const float* run_tile(const Program* p, long base, int len, float (*scratch)[LAZY_TILE]) {
+    const CpuKernels* kernels = cpu_kernels();
+    const float* r[LAZY_MAX_SLOTS];
+    for (int k = 0; k < p->n; k++) {
+        const Slot* s = &p->slots[k];
+        if (s->leaf && !s->row) {
+            r[k] = s->src + base;
+            continue;
+        }
+
+        float* d = p->out && k == p->n - 1 ? p->out + base : scratch[k];
+        if (s->leaf) {
+            int c = (int)(base % s->row);
+            for (int i = 0; i < len; i++) {
+                d[i] = s->src[c];
+                if (++c == s->row) c = 0;
+            }
+        } else {
+            const float* y = s->b >= 0 ? r[s->b] : NULL;
+            kernels->map(s->op, s->scalar, d, r[s->a], y, len);
+        }
+        r[k] = d;
+    }
+    return r[p->n - 1];
+}
+
+typedef struct {
+    const Program* p;
+    long size;
+} TileTask;
+
+static void tile_task(int begin, int end, void* arg) {
+    TileTask* t = (TileTask*)arg;
+    float scratch[LAZY_MAX_SLOTS][LAZY_TILE];
+    for (int tile = begin; tile < end; tile++) {
+        long base = (long)tile * LAZY_TILE;
+        int len = t->size - base < LAZY_TILE ? (int)(t->size - base) : LAZY_TILE;
+        run_tile(t->p, base, len, scratch);
+    }
+}
+
+float* tensor_eval(Tensor* t) {
+    if (!t) return NULL;
+    if (!t->lazy) return t->data;
+
+    struct LazyExpr* e = t->lazy;
+    Program p;
+    p.n = 0;
+    float* data = e->data;
+
+    if (e->op == LAZY_SUM) {
+        emit(&p, e->inputs[0], 0, 0);
+        p.out = NULL;
+        float scratch[LAZY_MAX_SLOTS][LAZY_TILE];
+        float acc[CPU_SUM_LANES] = { 0 };
+        const CpuKernels* kernels = cpu_kernels();
+        long size = e->inputs[0]->size;
+        for (long base = 0; base < size; base += LAZY_TILE) {
+            int len = size - base < LAZY_TILE ? (int)(size - base) : LAZY_TILE;
+            const float* v = run_tile(&p, base, len, scratch);
+            kernels->sum_lanes(acc, v, len);
+        }
+        data[0] = cpu_lanes_total(acc);
+    } else {
+        emit(&p, t, 0, 0);
+        p.out = data;
+        TileTask task = { &p, t->size };
+        int n_tiles = (int)((t->size + LAZY_TILE - 1) / LAZY_TILE);
+        if (t->size >= LAZY_PARALLEL_MIN) parallel_for(n_tiles, 0, tile_task, &task);
+        else tile_task(0, n_tiles, &task);
+    }
+
+    t->data = data;
+    t->lazy = NULL;
+    lazy_free(e);
+    return data;
+}
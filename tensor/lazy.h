@@ -0,0 +1,34 @@
+#ifndef CML_LAZY_H
+#define CML_LAZY_H
+#include "tensor.h"
+
+typedef enum {
+    LAZY_ADD,
+    LAZY_SUB,
+    LAZY_MUL,
+    LAZY_ADD_ROW,
+    LAZY_SUB_ROW,
+    LAZY_MUL_SCALAR,
+    LAZY_DIV_SCALAR,
+    LAZY_EXP,
+    LAZY_LOG,
+    LAZY_RELU,
+    LAZY_SIGMOID,
+    LAZY_TANH,
+    LAZY_SUM
+} LazyOp;
+
+struct LazyExpr {
+    LazyOp op;
+    float scalar;
+    Tensor* inputs[2];
+    float* data;
+};
+
+int lazy_enabled(void);
+void lazy_begin(void);
+void lazy_end(void);
+
+Tensor* lazy_defer(LazyOp op, Tensor* a, Tensor* b, float scalar);
+void lazy_free(struct LazyExpr* e);
+#endif
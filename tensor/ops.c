@@ -1,4 +1,8 @@
 #include "tensor.h"
+#include "gemm.h"
+#include "small_matmul.h"
+#include "lazy.h"
+#include "cpu.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -10,55 +14,69 @@ static int check_same_shape(Tensor* a, Tensor* b) {
         if (a->shape[i] != b->shape[i]) return 0;
     return 1;
 }
-static void add_parent(Tensor* t, Tensor* parent) {
-    t->parents = (Tensor**)realloc(t->parents, sizeof(Tensor*) * (t->n_parents + 1));
-    t->parents[t->n_parents] = parent;
-    t->n_parents++;
-    tensor_retain(parent);
+static void set_scalar_ctx(Tensor* t, float scalar) {
+    t->ctx_inline = scalar;
+    t->ctx = &t->ctx_inline;
 }
 
 Tensor* tensor_add(Tensor* a, Tensor* b) {
     if (!check_same_shape(a, b)) { fprintf(stderr, "tensor_add shape mismatch\n"); return NULL; }
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad || b->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = a->data[i] + b->data[i];
-    if (out->requires_grad) { add_parent(out, a); add_parent(out, b); out->backward = NULL; }
+    Tensor* out = lazy_defer(LAZY_ADD, a, b, 0.0f);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad || b->requires_grad);
+        cpu_kernels()->map(LAZY_ADD, 0.0f, out->data, a->data, b->data, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_add; }
     return out;
 }
 
 Tensor* tensor_sub(Tensor* a, Tensor* b) {
     if (!check_same_shape(a, b)) { fprintf(stderr, "tensor_sub shape mismatch\n"); return NULL; }
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad || b->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = a->data[i] - b->data[i];
-    if (out->requires_grad) { add_parent(out, a); add_parent(out, b); out->backward = NULL; }
+    Tensor* out = lazy_defer(LAZY_SUB, a, b, 0.0f);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad || b->requires_grad);
+        cpu_kernels()->map(LAZY_SUB, 0.0f, out->data, a->data, b->data, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_sub; }
     return out;
 }
 Tensor* tensor_mul(Tensor* a, Tensor* b) {
     if (!check_same_shape(a, b)) { fprintf(stderr, "tensor_mul shape mismatch\n"); return NULL; }
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad || b->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = a->data[i] * b->data[i];
-    if (out->requires_grad) { add_parent(out, a); add_parent(out, b); out->backward = NULL; }
+    Tensor* out = lazy_defer(LAZY_MUL, a, b, 0.0f);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad || b->requires_grad);
+        cpu_kernels()->map(LAZY_MUL, 0.0f, out->data, a->data, b->data, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_mul; }
     return out;
 }
 
 Tensor* tensor_mul_scalar(Tensor* a, float scalar) {
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = a->data[i] * scalar;
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_MUL_SCALAR, a, NULL, scalar);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad);
+        cpu_kernels()->map(LAZY_MUL_SCALAR, scalar, out->data, a->data, NULL, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); set_scalar_ctx(out, scalar); out->backward = backward_mul_scalar; }
     return out;
 }
 
 Tensor* tensor_div_scalar(Tensor* a, float scalar) {
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = a->data[i] / scalar;
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_DIV_SCALAR, a, NULL, scalar);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad);
+        cpu_kernels()->map(LAZY_DIV_SCALAR, scalar, out->data, a->data, NULL, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); set_scalar_ctx(out, scalar); out->backward = backward_div_scalar; }
     return out;
 }
 Tensor* tensor_sum(Tensor* a) {
-    Tensor* out = tensor_zeros(0, NULL, a->requires_grad);
-    float total = 0.0f;
-    for (int i = 0; i < a->size; i++) total += a->data[i];
-    out->data[0] = total;
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_SUM, a, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(0, NULL, a->requires_grad);
+        out->data[0] = cpu_sum(a->data, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); out->backward = backward_sum; }
     return out;
 }
 
@@ -66,22 +84,18 @@ Tensor* tensor_sum_axis(Tensor* a, int axis) {
     if (a->ndim != 2) { fprintf(stderr, "tensor_sum_axis only supports 2D tensors\n"); return NULL; }
     if (axis < 0 || axis > 1) { fprintf(stderr, "tensor_sum_axis invalid axis\n"); return NULL; }
     int out_shape[1] = { axis == 0 ? a->shape[1] : a->shape[0] };
+    tensor_eval(a);
     Tensor* out = tensor_zeros(1, out_shape, a->requires_grad);
 
+    const CpuKernels* kernels = cpu_kernels();
     if (axis == 0) {
-        for (int j = 0; j < a->shape[1]; j++) {
-            float s = 0.0f;
-            for (int i = 0; i < a->shape[0]; i++) s += a->data[i * a->shape[1] + j];
-            out->data[j] = s;
-        }
+        for (int i = 0; i < a->shape[0]; i++)
+            kernels->axpy(out->data, 1.0f, a->data + (size_t)i * a->shape[1], a->shape[1]);
     } else {
-        for (int i = 0; i < a->shape[0]; i++) {
-            float s = 0.0f;
-            for (int j = 0; j < a->shape[1]; j++) s += a->data[i * a->shape[1] + j];
-            out->data[i] = s;
-        }
+        for (int i = 0; i < a->shape[0]; i++)
+            out->data[i] = cpu_sum(a->data + (size_t)i * a->shape[1], a->shape[1]);
     }
-    if (out->requires_grad) add_parent(out, a);
+    if (out->requires_grad) { tensor_add_parent(out, a); set_scalar_ctx(out, (float)axis); out->backward = backward_sum_axis; }
     return out;
 }
 
@@ -89,33 +103,37 @@ Tensor* tensor_matmul(Tensor* a, Tensor* b) {
     if (a->ndim != 2 || b->ndim != 2 || a->shape[1] != b->shape[0]) { fprintf(stderr, "tensor_matmul dimension mismatch\n"); return NULL; }
     int m = a->shape[0], n = a->shape[1], p = b->shape[1];
     int out_shape[2] = { m, p };
-    Tensor* out = tensor_zeros(2, out_shape, a->requires_grad || b->requires_grad);
-    for (int i = 0; i < m; i++)
-        for (int j = 0; j < p; j++) {
-            float sum = 0.0f;
-            for (int k = 0; k < n; k++) sum += a->data[i*n + k] * b->data[k*p + j];
-            out->data[i*p + j] = sum;
-        }
-    if (out->requires_grad) { add_parent(out, a); add_parent(out, b); out->backward = NULL; }
+    Tensor* out = tensor_create(2, out_shape, a->requires_grad || b->requires_grad);
+    const SmallMatmul* kernel = small_matmul_lookup(n, p);
+    if (kernel) small_matmul_forward(kernel, m, n, p, tensor_eval(a), tensor_eval(b), out->data);
+    else gemm(0, 0, m, p, n, 1.0f, tensor_eval(a), n, tensor_eval(b), p, 0.0f, out->data, p);
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_matmul; }
     return out;
 }
 Tensor* tensor_exp(Tensor* a) {
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = expf(a->data[i]);
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_EXP, a, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad);
+        cpu_kernels()->map(LAZY_EXP, 0.0f, out->data, a->data, NULL, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); out->backward = backward_exp; }
     return out;
 }
 
 Tensor* tensor_log(Tensor* a) {
-    Tensor* out = tensor_zeros(a->ndim, a->shape, a->requires_grad);
-    for (int i = 0; i < a->size; i++) out->data[i] = logf(a->data[i]);
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_LOG, a, NULL, 0.0f);
+    if (!out) {
+        out = tensor_create(a->ndim, a->shape, a->requires_grad);
+        cpu_kernels()->map(LAZY_LOG, 0.0f, out->data, a->data, NULL, a->size);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); out->backward = backward_log; }
     return out;
 }
 
 Tensor* tensor_max_axis(Tensor* a, int axis) {
     if (a->ndim != 2) { fprintf(stderr, "tensor_max_axis only supports 2D tensors\n"); return NULL; }
     int out_shape[1] = { axis == 0 ? a->shape[1] : a->shape[0] };
+    tensor_eval(a);
     Tensor* out = tensor_zeros(1, out_shape, 0);
 
     if (axis == 0) {
@@ -137,11 +155,14 @@ Tensor* tensor_max_axis(Tensor* a, int axis) {
 Tensor* tensor_sub_broadcast(Tensor* a, Tensor* b) {
     if (a->ndim != 2 || b->ndim != 1 || a->shape[1] != b->shape[0]) { fprintf(stderr,"tensor_sub_broadcast shape mismatch\n"); return NULL; }
     int out_shape[2] = {a->shape[0], a->shape[1]};
-    Tensor* out = tensor_zeros(2, out_shape, a->requires_grad);
-    for (int i = 0; i < a->shape[0]; i++)
-        for (int j = 0; j < a->shape[1]; j++)
-            out->data[i*a->shape[1]+j] = a->data[i*a->shape[1]+j] - b->data[j];
-    if (out->requires_grad) add_parent(out, a);
+    Tensor* out = lazy_defer(LAZY_SUB_ROW, a, b, 0.0f);
+    if (!out) {
+        out = tensor_create(2, out_shape, a->requires_grad || b->requires_grad);
+        for (int i = 0; i < a->shape[0]; i++)
+            cpu_kernels()->map(LAZY_SUB, 0.0f, out->data + (size_t)i * a->shape[1], a->data + (size_t)i * a->shape[1],
+                               b->data, a->shape[1]);
+    }
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_sub_broadcast; }
     return out;
 }
 
@@ -150,11 +171,14 @@ Tensor* tensor_add_broadcast(Tensor* a, Tensor* b) {
 
     if (a->ndim == 2 && b->ndim == 1 && a->shape[1] == b->shape[0]) {
         int out_shape[2] = { a->shape[0], a->shape[1] };
-        Tensor* out = tensor_zeros(2, out_shape, a->requires_grad || b->requires_grad);
-        for (int i = 0; i < a->shape[0]; i++)
-            for (int j = 0; j < a->shape[1]; j++)
-                out->data[i*a->shape[1]+j] = a->data[i*a->shape[1]+j] + b->data[j];
-        if (out->requires_grad) { add_parent(out, a); add_parent(out, b); }
+        Tensor* out = lazy_defer(LAZY_ADD_ROW, a, b, 0.0f);
+        if (!out) {
+            out = tensor_create(2, out_shape, a->requires_grad || b->requires_grad);
+            for (int i = 0; i < a->shape[0]; i++)
+                cpu_kernels()->map(LAZY_ADD, 0.0f, out->data + (size_t)i * a->shape[1], a->data + (size_t)i * a->shape[1],
+                                   b->data, a->shape[1]);
+        }
+        if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, b); out->backward = backward_add_broadcast; }
         return out;
     }
 
@@ -166,25 +190,19 @@ Tensor* tensor_reshape(Tensor* a, int* new_shape, int new_ndim) {
     int new_size = 1;
     for (int i = 0; i < new_ndim; i++) new_size *= new_shape[i];
     if (new_size != a->size) { fprintf(stderr, "tensor_reshape size mismatch\n"); return NULL; }
+    tensor_eval(a);
 
-    Tensor* out = (Tensor*)malloc(sizeof(Tensor));
-    out->ndim = new_ndim;
-    out->shape = (int*)malloc(sizeof(int)*new_ndim);
-    memcpy(out->shape, new_shape, sizeof(int)*new_ndim);
-    out->size = a->size;
-    out->data = a->data;
-    out->grad = a->grad;
-    out->requires_grad = a->requires_grad;
-    out->parents = NULL;
-    out->n_parents = 0;
-    out->backward = NULL;
-
+    Tensor* out = tensor_from_data(new_ndim, new_shape, a->data, a->requires_grad);
+    if (!out) return NULL;
+    tensor_add_parent(out, a);
+    if (out->requires_grad) out->backward = backward_reshape;
     return out;
 }
 
 Tensor* tensor_softmax(Tensor* a) {
     if (a->ndim != 2) { fprintf(stderr, "tensor_softmax only supports 2D tensors\n"); return NULL; }
     int N = a->shape[0], C = a->shape[1];
+    tensor_eval(a);
     Tensor* out = tensor_zeros(2, a->shape, a->requires_grad);
     for (int i = 0; i < N; i++) {
         float maxv = a->data[i*C];
@@ -193,25 +211,27 @@ Tensor* tensor_softmax(Tensor* a) {
         for (int j = 0; j < C; j++) { out->data[i*C+j] = expf(a->data[i*C+j] - maxv); sum += out->data[i*C+j]; }
         for (int j = 0; j < C; j++) out->data[i*C+j] /= sum;
     }
-    if (out->requires_grad) add_parent(out, a);
+    if (out->requires_grad) { tensor_add_parent(out, a); out->backward = backward_softmax; }
     return out;
 }
 
 Tensor* tensor_gather(Tensor* a, Tensor* indices) {
     if (a->ndim != 2 || indices->ndim != 1 || a->shape[0] != indices->shape[0]) { fprintf(stderr, "tensor_gather shape mismatch\n"); return NULL; }
     int N = a->shape[0];
+    tensor_eval(a);
+    tensor_eval(indices);
     Tensor* out = tensor_zeros(1, &N, a->requires_grad);
     for (int i = 0; i < N; i++) { 
         int idx = (int)indices->data[i]; 
         out->data[i] = a->data[i*a->shape[1] + idx];
     }
-    if (out->requires_grad) add_parent(out, a);
+    if (out->requires_grad) { tensor_add_parent(out, a); tensor_add_parent(out, indices); out->backward = backward_gather; }
     return out;
 }
 
 float tensor_item(Tensor* t, int i) {
     if (t->size <= i) { fprintf(stderr, "tensor_item index out of bounds\n"); return 0; }
-    return t->data[i];
+    return tensor_eval(t)[i];
 }
 
 void tensor_free(Tensor* t) {
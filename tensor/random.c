@@ -0,0 +1,156 @@
+#include "random.h"
+#include <math.h>
+#include "../parallel/pool.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+#define RNG_BATCH 8
+#define RNG_CHUNK 1024
+#define TWO_PI 6.283185307179586f
+
+enum { RNG_UNIFORM, RNG_NORMAL, RNG_BERNOULLI };
+
+static uint64_t global_seed = 0;
+static uint64_t global_offset = 0;
+
+void rng_seed(uint64_t seed) {
+    __atomic_store_n(&global_seed, seed, __ATOMIC_RELAXED);
+    __atomic_store_n(&global_offset, 0, __ATOMIC_RELAXED);
+}
+
+uint64_t rng_get_seed(void) {
+    return __atomic_load_n(&global_seed, __ATOMIC_RELAXED);
+}
+
+uint64_t rng_reserve(uint64_t n) {
+    return __atomic_fetch_add(&global_offset, n, __ATOMIC_RELAXED);
+}
+
+static void philox_batch(uint64_t seed, uint64_t block, uint32_t out[4][RNG_BATCH]) {
+    uint32_t c0[RNG_BATCH], c1[RNG_BATCH], c2[RNG_BATCH], c3[RNG_BATCH];
+    for (int j = 0; j < RNG_BATCH; j++) {
+        c0[j] = (uint32_t)(block + j);
+        c1[j] = (uint32_t)((block + j) >> 32);
+        c2[j] = 0;
+        c3[j] = 0;
+    }
+
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        for (int j = 0; j < RNG_BATCH; j++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[j];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[j];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[j] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[j] ^ k1;
+            c0[j] = n0;
+            c1[j] = (uint32_t)p1;
+            c2[j] = n2;
+            c3[j] = (uint32_t)p0;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int j = 0; j < RNG_BATCH; j++) {
+        out[0][j] = c0[j];
+        out[1][j] = c1[j];
+        out[2][j] = c2[j];
+        out[3][j] = c3[j];
+    }
+}
+
+static void fill_bits(uint32_t* bits, int n, uint64_t seed, uint64_t pos) {
+    uint32_t lanes[4][RNG_BATCH];
+    int i = 0;
+    while (i < n) {
+        uint64_t block = (pos + i) / 4;
+        int skip = (int)((pos + i) % 4);
+        philox_batch(seed, block, lanes);
+        for (int j = skip; j < 4 * RNG_BATCH && i < n; j++)
+            bits[i++] = lanes[j % 4][j / 4];
+    }
+}
+
+static inline float unit(uint32_t x) {
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float open_unit(uint32_t x) {
+    return (float)((x >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+typedef struct {
+    float* out;
+    int n;
+    int dist;
+    float a;
+    float b;
+    uint64_t seed;
+    uint64_t offset;
+} FillTask;
+
+static void fill_task(int begin, int end, void* arg) {
+    FillTask* t = (FillTask*)arg;
+    uint32_t bits[RNG_CHUNK + 2];
+    for (int c = begin; c < end; c++) {
+        int i0 = c * RNG_CHUNK;
+        int len = t->n - i0 < RNG_CHUNK ? t->n - i0 : RNG_CHUNK;
+        float* out = t->out + i0;
+        uint64_t q0 = t->offset + (uint64_t)i0;
+
+        if (t->dist == RNG_NORMAL) {
+            int skip = (int)(q0 & 1);
+            int count = skip + len + ((skip + len) & 1);
+            fill_bits(bits, count, t->seed, q0 - skip);
+            for (int i = 0; i < len;) {
+                int base = (skip + i) & ~1;
+                float r = sqrtf(-2.0f * logf(open_unit(bits[base])));
+                float theta = TWO_PI * unit(bits[base + 1]);
+                if (!((skip + i) & 1)) {
+                    out[i++] = t->a + t->b * r * cosf(theta);
+                    if (i == len) break;
+                }
+                out[i++] = t->a + t->b * r * sinf(theta);
+            }
+            continue;
+        }
+
+        fill_bits(bits, len, t->seed, q0);
+        if (t->dist == RNG_UNIFORM) {
+            for (int i = 0; i < len; i++) out[i] = t->a + (t->b - t->a) * unit(bits[i]);
+        } else {
+            for (int i = 0; i < len; i++) out[i] = unit(bits[i]) < t->a ? 1.0f : 0.0f;
+        }
+    }
+}
+
+static void fill(float* out, int n, int dist, float a, float b, uint64_t seed, uint64_t offset) {
+    if (n <= 0) return;
+    FillTask t = { out, n, dist, a, b, seed, offset };
+    int n_chunks = (n + RNG_CHUNK - 1) / RNG_CHUNK;
+    if (n_chunks == 1) fill_task(0, 1, &t);
+    else parallel_for(n_chunks, 0, fill_task, &t);
+}
+
+void rng_uniform(float* out, int n, float lo, float hi, uint64_t seed, uint64_t offset) {
+    fill(out, n, RNG_UNIFORM, lo, hi, seed, offset);
+}
+
+void rng_normal(float* out, int n, float mean, float std, uint64_t seed, uint64_t offset) {
+    fill(out, n, RNG_NORMAL, mean, std, seed, offset);
+}
+
+void rng_bernoulli(float* out, int n, float p, uint64_t seed, uint64_t offset) {
+    fill(out, n, RNG_BERNOULLI, p, 0.0f, seed, offset);
+}
+
+Tensor* tensor_rand_uniform(int ndim, const int* shape, float lo, float hi, int requires_grad) {
+    Tensor* t = tensor_create(ndim, shape, requires_grad);
+    if (!t) return NULL;
+
+    rng_uniform(t->data, t->size, lo, hi, rng_get_seed(), rng_reserve(t->size));
+    return t;
+}
@@ -0,0 +1,12 @@
+#ifndef CML_RANDOM_H
+#define CML_RANDOM_H
+#include <stdint.h>
+#include "tensor.h"
+void rng_seed(uint64_t seed);
+uint64_t rng_get_seed(void);
+uint64_t rng_reserve(uint64_t n);
+void rng_uniform(float* out, int n, float lo, float hi, uint64_t seed, uint64_t offset);
+void rng_normal(float* out, int n, float mean, float std, uint64_t seed, uint64_t offset);
+void rng_bernoulli(float* out, int n, float p, uint64_t seed, uint64_t offset);
+Tensor* tensor_rand_uniform(int ndim, const int* shape, float lo, float hi, int requires_grad);
+#endif
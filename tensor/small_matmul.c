@@ -0,0 +1,120 @@
+#include "small_matmul.h"
+#include "cpu.h"
+#include <stddef.h>
+#include "../parallel/pool.h"
+
+#define PARALLEL_ROWS_WORK (1 << 18)
+
+#define UNROLL _Pragma("GCC unroll 32")
+
+#define SMALL_MATMUL(N, P, L, target)                                                                \
+target static void matmul_##N##x##P##_##L(int m, const float* restrict a, const float* restrict b,   \
+                                          float* restrict out) {                                     \
+    for (int i = 0; i < m; i++) {                                                                    \
+        const float* ai = a + (size_t)i * N;                                                         \
+        float acc[P];                                                                                \
+        UNROLL for (int j = 0; j < P; j++) acc[j] = 0.0f;                                            \
+        UNROLL for (int k = 0; k < N; k++)                                                           \
+            UNROLL for (int j = 0; j < P; j++) acc[j] += ai[k] * b[k*P + j];                         \
+        UNROLL for (int j = 0; j < P; j++) out[(size_t)i*P + j] = acc[j];                            \
+    }                                                                                                \
+}                                                                                                    \
+target static void grad_a_##N##x##P##_##L(int m, const float* restrict dy, const float* restrict b,  \
+                                          float* restrict da) {                                      \
+    for (int i = 0; i < m; i++) {                                                                    \
+        const float* dyi = dy + (size_t)i * P;                                                       \
+        UNROLL for (int k = 0; k < N; k++) {                                                         \
+            float acc = 0.0f;                                                                        \
+            UNROLL for (int j = 0; j < P; j++) acc += dyi[j] * b[k*P + j];                           \
+            da[(size_t)i*N + k] += acc;                                                              \
+        }                                                                                            \
+    }                                                                                                \
+}                                                                                                    \
+target static void grad_b_##N##x##P##_##L(int m, const float* restrict a, const float* restrict dy,  \
+                                          float* restrict db) {                                      \
+    float acc[N][P];                                                                                 \
+    UNROLL for (int k = 0; k < N; k++)                                                               \
+        UNROLL for (int j = 0; j < P; j++) acc[k][j] = 0.0f;                                         \
+    for (int i = 0; i < m; i++) {                                                                    \
+        const float* ai = a + (size_t)i * N;                                                         \
+        const float* dyi = dy + (size_t)i * P;                                                       \
+        UNROLL for (int k = 0; k < N; k++)                                                           \
+            UNROLL for (int j = 0; j < P; j++) acc[k][j] += ai[k] * dyi[j];                          \
+    }                                                                                                \
+    UNROLL for (int k = 0; k < N; k++)                                                               \
+        UNROLL for (int j = 0; j < P; j++) db[k*P + j] += acc[k][j];                                 \
+}
+
+#define SMALL_MATMUL_ROW(N, L, target)                                                         \
+    SMALL_MATMUL(N, 2, L, target) SMALL_MATMUL(N, 4, L, target) SMALL_MATMUL(N, 8, L, target)  \
+    SMALL_MATMUL(N, 16, L, target) SMALL_MATMUL(N, 32, L, target)
+
+#define SMALL_MATMUL_LEVEL(L, target)                                                             \
+    SMALL_MATMUL_ROW(2, L, target) SMALL_MATMUL_ROW(4, L, target) SMALL_MATMUL_ROW(8, L, target)  \
+    SMALL_MATMUL_ROW(16, L, target) SMALL_MATMUL_ROW(32, L, target)
+
+SMALL_MATMUL_LEVEL(generic, )
+SMALL_MATMUL_LEVEL(avx2, TARGET_AVX2)
+SMALL_MATMUL_LEVEL(avx512, TARGET_AVX512)
+
+#define ENTRY(N, P, L) { matmul_##N##x##P##_##L, grad_a_##N##x##P##_##L, grad_b_##N##x##P##_##L }
+#define ENTRY_ROW(N, L) { ENTRY(N, 2, L), ENTRY(N, 4, L), ENTRY(N, 8, L), ENTRY(N, 16, L), ENTRY(N, 32, L) }
+#define ENTRY_LEVEL(L) { ENTRY_ROW(2, L), ENTRY_ROW(4, L), ENTRY_ROW(8, L), ENTRY_ROW(16, L), ENTRY_ROW(32, L) }
+
+static const SmallMatmul small_kernels[CPU_LEVELS][5][5] = {
+    ENTRY_LEVEL(generic), ENTRY_LEVEL(avx2), ENTRY_LEVEL(avx512),
+};
+
+static int size_class(int d) {
+    switch (d) {
+        case 2: return 0;
+        case 4: return 1;
+        case 8: return 2;
+        case 16: return 3;
+        case 32: return 4;
+        default: return -1;
+    }
+}
+
+const SmallMatmul* small_matmul_lookup(int n, int p) {
+    int i = size_class(n), j = size_class(p);
+    if (i < 0 || j < 0) return NULL;
+    return &small_kernels[cpu_level()][i][j];
+}
+
+typedef struct {
+    const SmallMatmul* k;
+    int n;
+    int p;
+    const float* lhs;
+    const float* rhs;
+    float* out;
+} RowTask;
+
+static void forward_rows(int begin, int end, void* arg) {
+    RowTask* t = (RowTask*)arg;
+    t->k->forward(end - begin, t->lhs + (size_t)begin * t->n, t->rhs, t->out + (size_t)begin * t->p);
+}
+
+static void grad_a_rows(int begin, int end, void* arg) {
+    RowTask* t = (RowTask*)arg;
+    t->k->grad_a(end - begin, t->lhs + (size_t)begin * t->p, t->rhs, t->out + (size_t)begin * t->n);
+}
+
+void small_matmul_forward(const SmallMatmul* k, int m, int n, int p, const float* a, const float* b, float* out) {
+    if ((long)m * n * p < PARALLEL_ROWS_WORK) {
+        k->forward(m, a, b, out);
+        return;
+    }
+    RowTask t = { k, n, p, a, b, out };
+    parallel_for(m, 0, forward_rows, &t);
+}
+
+void small_matmul_grad_a(const SmallMatmul* k, int m, int n, int p, const float* dy, const float* b, float* da) {
+    if ((long)m * n * p < PARALLEL_ROWS_WORK) {
+        k->grad_a(m, dy, b, da);
+        return;
+    }
+    RowTask t = { k, n, p, dy, b, da };
+    parallel_for(m, 0, grad_a_rows, &t);
+}
@@ -0,0 +1,15 @@
+#ifndef CML_SMALL_MATMUL_H
+#define CML_SMALL_MATMUL_H
+typedef void (*small_matmul_fn)(int m, const float* a, const float* b, float* out);
+typedef void (*small_grad_a_fn)(int m, const float* dy, const float* b, float* da);
+typedef void (*small_grad_b_fn)(int m, const float* a, const float* dy, float* db);
+typedef struct SmallMatmul SmallMatmul;
+struct SmallMatmul {
+    small_matmul_fn forward;
+    small_grad_a_fn grad_a;
+    small_grad_b_fn grad_b;
+};
+const SmallMatmul* small_matmul_lookup(int n, int p);
+void small_matmul_forward(const SmallMatmul* k, int m, int n, int p, const float* a, const float* b, float* out);
+void small_matmul_grad_a(const SmallMatmul* k, int m, int n, int p, const float* dy, const float* b, float* da);
+#endif
@@ -0,0 +1,172 @@
+#include "sparse.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../parallel/pool.h"
+
+#define SPMM_CHUNK_WORK 4096
+
+typedef struct {
+    CSRTensor* a;
+} SpMMContext;
+
+typedef struct {
+    const CSRTensor* a;
+    const float* b;
+    float* out;
+    int p;
+    int n_chunks;
+} SpMMTask;
+
+CSRTensor* csr_create(int rows, int cols, int nnz) {
+    CSRTensor* a = (CSRTensor*)malloc(sizeof(CSRTensor));
+    if (!a) return NULL;
+    a->rows = rows;
+    a->cols = cols;
+    a->nnz = nnz;
+    a->row_ptr = (int*)calloc(rows + 1, sizeof(int));
+    a->col_idx = (int*)malloc(sizeof(int) * (nnz > 0 ? nnz : 1));
+    a->values = (float*)malloc(sizeof(float) * (nnz > 0 ? nnz : 1));
+    a->transpose = NULL;
+    a->refcount = 1;
+    return a;
+}
+
+CSRTensor* csr_from_dense(Tensor* t) {
+    if (t->ndim != 2) { fprintf(stderr, "csr_from_dense only supports 2D tensors\n"); return NULL; }
+    int rows = t->shape[0], cols = t->shape[1];
+
+    tensor_eval(t);
+    int nnz = 0;
+    for (int i = 0; i < t->size; i++) if (t->data[i] != 0.0f) nnz++;
+
+    CSRTensor* a = csr_create(rows, cols, nnz);
+    int k = 0;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            float v = t->data[i*cols + j];
+            if (v == 0.0f) continue;
+            a->col_idx[k] = j;
+            a->values[k] = v;
+            k++;
+        }
+        a->row_ptr[i + 1] = k;
+    }
+    return a;
+}
+
+Tensor* csr_to_dense(CSRTensor* a) {
+    int shape[2] = { a->rows, a->cols };
+    Tensor* t = tensor_zeros(2, shape, 0);
+    for (int i = 0; i < a->rows; i++)
+        for (int k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++)
+            t->data[i*a->cols + a->col_idx[k]] = a->values[k];
+    return t;
+}
+
+CSRTensor* csr_transpose(CSRTensor* a) {
+    if (a->transpose) return a->transpose;
+
+    CSRTensor* t = csr_create(a->cols, a->rows, a->nnz);
+    for (int k = 0; k < a->nnz; k++) t->row_ptr[a->col_idx[k] + 1]++;
+    for (int j = 0; j < a->cols; j++) t->row_ptr[j + 1] += t->row_ptr[j];
+
+    int* fill = (int*)malloc(sizeof(int) * (a->cols + 1));
+    memcpy(fill, t->row_ptr, sizeof(int) * (a->cols + 1));
+    for (int i = 0; i < a->rows; i++)
+        for (int k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {
+            int dst = fill[a->col_idx[k]]++;
+            t->col_idx[dst] = i;
+            t->values[dst] = a->values[k];
+        }
+    free(fill);
+
+    a->transpose = t;
+    return t;
+}
+
+void csr_retain(CSRTensor* a) {
+    if (a) __atomic_add_fetch(&a->refcount, 1, __ATOMIC_RELAXED);
+}
+
+void csr_free(CSRTensor* a) {
+    if (!a) return;
+    if (__atomic_sub_fetch(&a->refcount, 1, __ATOMIC_ACQ_REL) > 0) return;
+    if (a->transpose) csr_free(a->transpose);
+    free(a->row_ptr);
+    free(a->col_idx);
+    free(a->values);
+    free(a);
+}
+
+static int chunk_row(const CSRTensor* a, int chunk, int n_chunks) {
+    if (chunk >= n_chunks) return a->rows;
+    long target = (long)a->nnz * chunk / n_chunks;
+    int lo = 0, hi = a->rows;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (a->row_ptr[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void spmm_rows(int chunk_begin, int chunk_end, void* arg) {
+    SpMMTask* t = (SpMMTask*)arg;
+    int p = t->p;
+    int begin = chunk_row(t->a, chunk_begin, t->n_chunks);
+    int end = chunk_row(t->a, chunk_end, t->n_chunks);
+
+    for (int i = begin; i < end; i++) {
+        float* restrict out = t->out + (size_t)i * p;
+        for (int k = t->a->row_ptr[i]; k < t->a->row_ptr[i + 1]; k++) {
+            float v = t->a->values[k];
+            const float* restrict row = t->b + (size_t)t->a->col_idx[k] * p;
+            for (int j = 0; j < p; j++) out[j] += v * row[j];
+        }
+    }
+}
+
+static void spmm_into(const CSRTensor* a, const float* b, float* out, int p) {
+    long chunks = (long)a->nnz * p / SPMM_CHUNK_WORK;
+    long max_chunks = 4L * pool_num_threads();
+    if (chunks > max_chunks) chunks = max_chunks;
+    if (chunks > a->rows) chunks = a->rows;
+    if (chunks < 1) chunks = 1;
+    SpMMTask task = { a, b, out, p, (int)chunks };
+    parallel_for(task.n_chunks, 1, spmm_rows, &task);
+}
+
+static void spmm_free_ctx(void* arg) {
+    SpMMContext* ctx = (SpMMContext*)arg;
+    csr_free(ctx->a);
+    free(ctx);
+}
+
+static void backward_spmm(Tensor* t) {
+    Tensor* b = t->parents[0];
+    if (!b->requires_grad) return;
+
+    SpMMContext* ctx = (SpMMContext*)t->ctx;
+    spmm_into(csr_transpose(ctx->a), t->grad, b->grad, b->shape[1]);
+}
+
+Tensor* tensor_spmm(CSRTensor* a, Tensor* b) {
+    if (b->ndim != 2 || a->cols != b->shape[0]) { fprintf(stderr, "tensor_spmm dimension mismatch\n"); return NULL; }
+    int out_shape[2] = { a->rows, b->shape[1] };
+    Tensor* out = tensor_zeros(2, out_shape, b->requires_grad);
+
+    spmm_into(a, tensor_eval(b), out->data, b->shape[1]);
+
+    if (out->requires_grad) {
+        csr_transpose(a);
+        SpMMContext* ctx = (SpMMContext*)malloc(sizeof(SpMMContext));
+        csr_retain(a);
+        ctx->a = a;
+        tensor_add_parent(out, b);
+        out->backward = backward_spmm;
+        out->ctx = ctx;
+        out->free_ctx = spmm_free_ctx;
+    }
+    return out;
+}
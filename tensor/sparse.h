@@ -0,0 +1,22 @@
+#ifndef CML_SPARSE_H
+#define CML_SPARSE_H
+#include "tensor.h"
+typedef struct CSRTensor CSRTensor;
+struct CSRTensor {
+    int rows;
+    int cols;
+    int nnz;
+    int* row_ptr;
+    int* col_idx;
+    float* values;
+    CSRTensor* transpose;
+    int refcount;
+};
+CSRTensor* csr_create(int rows, int cols, int nnz);
+CSRTensor* csr_from_dense(Tensor* t);
+Tensor* csr_to_dense(CSRTensor* a);
+CSRTensor* csr_transpose(CSRTensor* a);
+void csr_retain(CSRTensor* a);
+void csr_free(CSRTensor* a);
+Tensor* tensor_spmm(CSRTensor* a, Tensor* b);
+#endif
@@ -1,4 +1,6 @@
 #include "tensor.h"
+#include "lazy.h"
+#include "random.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -14,50 +16,71 @@ static int compute_size(int ndim, const int* shape) {
 }
 
 static void compute_strides(int ndim, const int* shape, int* strides) {
+    if (ndim == 0) return;
     strides[ndim - 1] = 1;
     for (int i = ndim - 2; i >= 0; i--) {
         strides[i] = strides[i + 1] * shape[i + 1];
     }
 }
 
-static float rand_uniform() {
-    return (float)rand() / (float)RAND_MAX;
-}
 
-static float rand_normal() {
-    float u1 = rand_uniform();
-    float u2 = rand_uniform();
-    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * 3.1415926535f * u2);
+static size_t align_up(size_t bytes) {
+    return (bytes + CML_ALIGN - 1) & ~(size_t)(CML_ALIGN - 1);
 }
 
+static Tensor* tensor_alloc(int ndim, const int* shape, int with_data, int requires_grad) {
+    if (ndim < 0 || ndim > CML_MAX_DIMS) {
+        fprintf(stderr, "tensor rank %d exceeds CML_MAX_DIMS (%d)\n", ndim, CML_MAX_DIMS);
+        return NULL;
+    }
 
-Tensor* tensor_create(int ndim, const int* shape, int requires_grad) {
-    Tensor* t = (Tensor*)malloc(sizeof(Tensor));
+    int size = compute_size(ndim, shape);
+    size_t header = align_up(sizeof(Tensor));
+    size_t bytes = align_up(sizeof(float) * (size_t)size);
+    Tensor* t = (Tensor*)aligned_alloc(CML_ALIGN, header + (with_data ? bytes : 0) + (requires_grad ? bytes : 0));
     if (!t) return NULL;
 
     t->ndim = ndim;
-    t->shape = (int*)malloc(sizeof(int) * ndim);
-    t->strides = (int*)malloc(sizeof(int) * ndim);
-
+    t->size = size;
     memcpy(t->shape, shape, sizeof(int) * ndim);
     compute_strides(ndim, shape, t->strides);
 
-    t->size = compute_size(ndim, shape);
-
-    t->data = (float*)malloc(sizeof(float) * t->size);
-    t->grad = requires_grad ? (float*)calloc(t->size, sizeof(float)) : NULL;
+    char* payload = (char*)t + header;
+    t->data = with_data ? (float*)payload : NULL;
+    t->grad = NULL;
+    if (requires_grad) {
+        t->grad = (float*)(payload + (with_data ? bytes : 0));
+        memset(t->grad, 0, sizeof(float) * size);
+    }
 
-    t->parents = NULL;
+    t->parents = t->parents_inline;
     t->n_parents = 0;
     t->backward = NULL;
+    t->ctx = NULL;
+    t->free_ctx = NULL;
+    t->serial_backward = 0;
+    t->lazy = NULL;
 
     t->requires_grad = requires_grad;
-    t->is_view = 0;
+    t->is_view = !with_data;
+    t->owns_grad = 0;
     t->refcount = 1;
 
     return t;
 }
 
+Tensor* tensor_create(int ndim, const int* shape, int requires_grad) {
+    return tensor_alloc(ndim, shape, 1, requires_grad);
+}
+
+Tensor* tensor_from_data(int ndim, const int* shape, float* data, int requires_grad) {
+    Tensor* t = tensor_alloc(ndim, shape, 0, requires_grad);
+    if (!t) return NULL;
+
+    t->data = data;
+    return t;
+}
+
 Tensor* tensor_zeros(int ndim, const int* shape, int requires_grad) {
     Tensor* t = tensor_create(ndim, shape, requires_grad);
     if (!t) return NULL;
@@ -70,42 +93,53 @@ Tensor* tensor_randn(int ndim, const int* shape, int requires_grad) {
     Tensor* t = tensor_create(ndim, shape, requires_grad);
     if (!t) return NULL;
 
-    for (int i = 0; i < t->size; i++) {
-        t->data[i] = rand_normal();
-    }
+    rng_normal(t->data, t->size, 0.0f, 1.0f, rng_get_seed(), rng_reserve(t->size));
     return t;
 }
 
 
+void tensor_add_parent(Tensor* t, Tensor* parent) {
+    if (t->n_parents == CML_INLINE_PARENTS && t->parents == t->parents_inline) {
+        t->parents = (Tensor**)malloc(sizeof(Tensor*) * (t->n_parents + 1));
+        memcpy(t->parents, t->parents_inline, sizeof(Tensor*) * t->n_parents);
+    } else if (t->n_parents >= CML_INLINE_PARENTS) {
+        t->parents = (Tensor**)realloc(t->parents, sizeof(Tensor*) * (t->n_parents + 1));
+    }
+    t->parents[t->n_parents++] = parent;
+    tensor_retain(parent);
+}
+
 void tensor_retain(Tensor* t) {
     if (t) {
-        t->refcount++;
+        __atomic_add_fetch(&t->refcount, 1, __ATOMIC_RELAXED);
     }
 }
 
 void tensor_release(Tensor* t) {
     if (!t) return;
 
-    t->refcount--;
-    if (t->refcount > 0) return;
+    if (__atomic_sub_fetch(&t->refcount, 1, __ATOMIC_ACQ_REL) > 0) return;
 
-    if (t->parents) {
-        for (int i = 0; i < t->n_parents; i++) {
-            tensor_release(t->parents[i]);
-        }
+    for (int i = 0; i < t->n_parents; i++) {
+        tensor_release(t->parents[i]);
+    }
+    if (t->parents != t->parents_inline) {
         free(t->parents);
     }
 
-    if (!t->is_view && t->data) {
-        free(t->data);
+    if (t->owns_grad) {
+        free(t->grad);
+    }
+
+    if (t->ctx && t->ctx != &t->ctx_inline) {
+        if (t->free_ctx) t->free_ctx(t->ctx);
+        else free(t->ctx);
     }
 
-    if (t->grad) {
-        free(t->grad);
+    if (t->lazy) {
+        lazy_free(t->lazy);
     }
 
-    free(t->shape);
-    free(t->strides);
     free(t);
 }
 
@@ -125,8 +159,9 @@ void tensor_print(const Tensor* t) {
     }
     printf("], requires_grad=%d)\n", t->requires_grad);
 
+    const float* data = tensor_eval((Tensor*)t);
     for (int i = 0; i < t->size; i++) {
-        printf("%f ", t->data[i]);
+        printf("%f ", data[i]);
     }
     printf("\n");
 }
\ No newline at end of file
@@ -2,28 +2,43 @@
 #define CML_TENSOR_H
 #include <stddef.h>
 
+#define CML_MAX_DIMS 8
+#define CML_INLINE_PARENTS 4
+#define CML_ALIGN 64
+
 typedef struct Tensor Tensor;
 struct Tensor {
     float* data;
     float* grad;
-    int* shape;
-    int* strides;
-    int ndim;
     int size;
+    int ndim;
+    int shape[CML_MAX_DIMS];
+    int strides[CML_MAX_DIMS];
     Tensor** parents;
     int n_parents;
-    void (*backward)(Tensor* self);
     int requires_grad;
+    void (*backward)(Tensor* self);
+    void* ctx;
+    void (*free_ctx)(void* ctx);
+    int serial_backward;
+    float ctx_inline;
+    struct LazyExpr* lazy;
     int is_view;
+    int owns_grad;
     int refcount;
+    Tensor* parents_inline[CML_INLINE_PARENTS];
 };
 Tensor* tensor_create(int ndim, const int* shape, int requires_grad);
+Tensor* tensor_from_data(int ndim, const int* shape, float* data, int requires_grad);
 Tensor* tensor_zeros(int ndim, const int* shape, int requires_grad);
 Tensor* tensor_randn(int ndim, const int* shape, int requires_grad);
+void tensor_add_parent(Tensor* t, Tensor* parent);
 void tensor_retain(Tensor* t);
 void tensor_release(Tensor* t);
 void tensor_zero_grad(Tensor* t);
 void tensor_print(const Tensor* t);
+void tensor_set_lazy(int enabled);
+float* tensor_eval(Tensor* t);
 Tensor* tensor_add(Tensor* a, Tensor* b);
 Tensor* tensor_mul(Tensor* a, Tensor* b);
 Tensor* tensor_matmul(Tensor* a, Tensor* b);
@@ -41,4 +56,22 @@ Tensor* tensor_gather(Tensor* a, Tensor* indices);
 Tensor* tensor_add_broadcast(Tensor* a, Tensor* b);
 Tensor* tensor_reshape(Tensor* a, int* new_shape, int new_ndim);
 void tensor_backward(Tensor* loss);
+void tensor_backward_with_grad(Tensor* t, const float* grad);
+void tensor_set_grad_hook(void (*hook)(Tensor* t, void* ctx), void* ctx);
+void tensor_set_parallel_backward(int mode);
+void backward_add(Tensor* t);
+void backward_sub(Tensor* t);
+void backward_mul(Tensor* t);
+void backward_mul_scalar(Tensor* t);
+void backward_div_scalar(Tensor* t);
+void backward_sum(Tensor* t);
+void backward_sum_axis(Tensor* t);
+void backward_matmul(Tensor* t);
+void backward_exp(Tensor* t);
+void backward_log(Tensor* t);
+void backward_gather(Tensor* t);
+void backward_add_broadcast(Tensor* t);
+void backward_sub_broadcast(Tensor* t);
+void backward_softmax(Tensor* t);
+void backward_reshape(Tensor* t);
 #endif 
\ No newline at end of file